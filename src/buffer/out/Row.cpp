@@ -9,6 +9,7 @@
 
 #include "textBuffer.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
+#include "../../types/inc/GraphemeBreak.hpp"
 
 // It would be nice to add checked array access in the future, but it's a little annoying to do so without impacting
 // performance (including Debug performance). Other languages are a little bit more ergonomic there than C++.
@@ -166,6 +167,192 @@ til::CoordType CharToColumnMapper::GetTrailingColumnAt(const wchar_t* str) noexc
     return GetTrailingColumnAt(str - _chars);
 }
 
+DelimiterClassifier::DelimiterClassifier(const std::wstring_view wordDelimiters) :
+    _delimiters{ wordDelimiters }
+{
+    for (const auto wch : wordDelimiters)
+    {
+        if (wch <= L' ')
+        {
+            // These are always classified as ControlChar.
+            continue;
+        }
+        if (wch < 0x80)
+        {
+            _asciiNibbles[wch & 0xf] |= static_cast<uint8_t>(1u << (wch >> 4));
+        }
+        else
+        {
+            _nonAscii.push_back(wch);
+        }
+    }
+
+    std::sort(_nonAscii.begin(), _nonAscii.end());
+    _nonAscii.erase(std::unique(_nonAscii.begin(), _nonAscii.end()), _nonAscii.end());
+}
+
+std::wstring_view DelimiterClassifier::Delimiters() const noexcept
+{
+    return _delimiters;
+}
+
+DelimiterClass DelimiterClassifier::Classify(const wchar_t wch) const noexcept
+{
+    if (wch <= L' ')
+    {
+        return DelimiterClass::ControlChar;
+    }
+    if (wch < 0x80)
+    {
+        return (_asciiNibbles[wch & 0xf] >> (wch >> 4)) & 1 ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+    }
+    return std::binary_search(_nonAscii.begin(), _nonAscii.end(), wch) ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+}
+
+#if defined(TIL_SSE_INTRINSICS)
+#pragma warning(push)
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// Classifies 8 UTF-16 characters at a time. _mm_shuffle_epi8 is used as a 16 entry table lookup,
+// which makes this require SSSE3. Once the low nibble of each character has been turned into
+// a byte containing 1 bit per high nibble (= DelimiterClassifier::_asciiNibbles), all that's
+// left is to AND it with the bit of the high nibble to get the delimiter status.
+struct DelimiterClassVectorizer
+{
+    DelimiterClassVectorizer(const uint8_t* asciiNibbles, bool hasNonAscii, DelimiterClassSet classes) noexcept :
+        _asciiNibbles{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(asciiNibbles)) },
+        _highNibbleBits{ _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0) },
+        _wantControl{ _mm_set1_epi16(classes.test(DelimiterClass::ControlChar) ? -1 : 0) },
+        _wantDelimiter{ _mm_set1_epi16(classes.test(DelimiterClass::DelimiterChar) ? -1 : 0) },
+        _wantRegular{ _mm_set1_epi16(classes.test(DelimiterClass::RegularChar) ? -1 : 0) },
+        _uncertainNonAscii{ _mm_set1_epi16(hasNonAscii ? -1 : 0) }
+    {
+    }
+
+    // Returns a _mm_movemask_epi8() (2 bits per character) of all characters in [ptr, ptr+8) whose class
+    // is not part of the `classes` given to the constructor. If there are non-ASCII delimiters, all
+    // non-ASCII characters are flagged as well and the caller needs to double-check them via Classify().
+    int MismatchMask(const wchar_t* ptr) const noexcept
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        const auto zero = _mm_setzero_si128();
+        const auto ones = _mm_set1_epi32(-1);
+
+        // (wch <= 0x20) and (wch >= 0x80) via subtractions with unsigned saturation. See findActionableFromGround().
+        const auto control = _mm_cmpeq_epi16(_mm_subs_epu16(wch, _mm_set1_epi16(0x20)), zero);
+        const auto nonAscii = _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(wch, _mm_set1_epi16(0x7f)), zero), ones);
+
+        // Non-ASCII characters get mangled by the signed saturation in _mm_packus_epi16,
+        // but that's fine since we mask them out of the `delimiter` result anyway.
+        const auto bytes = _mm_packus_epi16(wch, wch);
+        const auto nibbleMask = _mm_set1_epi8(0x0f);
+        const auto lo = _mm_and_si128(bytes, nibbleMask);
+        const auto hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibbleMask);
+        const auto bits = _mm_and_si128(_mm_shuffle_epi8(_asciiNibbles, lo), _mm_shuffle_epi8(_highNibbleBits, hi));
+        const auto delimiterBytes = _mm_xor_si128(_mm_cmpeq_epi8(bits, zero), ones);
+        const auto delimiter = _mm_andnot_si128(_mm_or_si128(control, nonAscii), _mm_unpacklo_epi8(delimiterBytes, delimiterBytes));
+        const auto regular = _mm_xor_si128(_mm_or_si128(control, delimiter), ones);
+
+        auto match = _mm_or_si128(_mm_and_si128(control, _wantControl), _mm_and_si128(delimiter, _wantDelimiter));
+        match = _mm_or_si128(match, _mm_and_si128(regular, _wantRegular));
+        match = _mm_andnot_si128(_mm_and_si128(nonAscii, _uncertainNonAscii), match);
+        return _mm_movemask_epi8(match) ^ 0xffff;
+    }
+
+private:
+    __m128i _asciiNibbles;
+    __m128i _highNibbleBits;
+    __m128i _wantControl;
+    __m128i _wantDelimiter;
+    __m128i _wantRegular;
+    __m128i _uncertainNonAscii;
+};
+
+#pragma warning(pop)
+#endif
+
+// Returns a pointer to the first character in [beg, end) whose class is not part of `classes`, or `end` if there's none.
+const wchar_t* DelimiterClassifier::FindForward(const wchar_t* beg, const wchar_t* end, const DelimiterClassSet classes) const noexcept
+{
+    auto it = beg;
+
+#if defined(TIL_SSE_INTRINSICS)
+    if (__isa_available >= __ISA_AVAILABLE_SSE42 && end - it >= 8)
+    {
+        const DelimiterClassVectorizer vectorizer{ _asciiNibbles.data(), !_nonAscii.empty(), classes };
+
+        while (end - it >= 8)
+        {
+            const auto mask = vectorizer.MismatchMask(it);
+            if (!mask)
+            {
+                it += 8;
+                continue;
+            }
+
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            it += index / 2;
+
+            if (!classes.test(Classify(*it)))
+            {
+                return it;
+            }
+
+            // A non-ASCII character that turned out to be part of `classes` after all.
+            ++it;
+        }
+    }
+#endif
+
+    for (; it != end && classes.test(Classify(*it)); ++it)
+    {
+    }
+    return it;
+}
+
+// Returns a pointer to the last character in [beg, end) whose class is not part of `classes`, or nullptr if there's none.
+const wchar_t* DelimiterClassifier::FindBackward(const wchar_t* beg, const wchar_t* end, const DelimiterClassSet classes) const noexcept
+{
+    auto it = end;
+
+#if defined(TIL_SSE_INTRINSICS)
+    if (__isa_available >= __ISA_AVAILABLE_SSE42 && it - beg >= 8)
+    {
+        const DelimiterClassVectorizer vectorizer{ _asciiNibbles.data(), !_nonAscii.empty(), classes };
+
+        while (it - beg >= 8)
+        {
+            const auto mask = vectorizer.MismatchMask(it - 8);
+            if (!mask)
+            {
+                it -= 8;
+                continue;
+            }
+
+            unsigned long index;
+            _BitScanReverse(&index, mask);
+            it = it - 8 + index / 2;
+
+            if (!classes.test(Classify(*it)))
+            {
+                return it;
+            }
+        }
+    }
+#endif
+
+    while (it != beg)
+    {
+        --it;
+        if (!classes.test(Classify(*it)))
+        {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
 // Routine Description:
 // - constructor
 // Arguments:
@@ -609,10 +796,57 @@ catch (...)
     }
 }
 
+// Returns whether the beginning of `text` continues the grapheme cluster of the glyph that ends at `column`,
+// for instance because it starts with a combining mark. Writing the text at `column` extends that glyph.
+bool ROW::JoinsPrecedingGlyph(til::CoordType column, const std::wstring_view& text) const noexcept
+{
+    return !_precedingJoinableGlyph(column, text).empty();
+}
+
+// Returns the glyph that ends at `column` if `text` continues its grapheme cluster, or an empty string otherwise.
+std::wstring_view ROW::_precedingJoinableGlyph(til::CoordType column, const std::wstring_view& text) const noexcept
+{
+    if (column <= 0 || column > _columnCount || text.empty())
+    {
+        return {};
+    }
+
+    // Safety: column is (0, _columnCount] and _charOffsets has _columnCount + 1 entries.
+    // If column is a trailer, the glyph in front of it gets overwritten and there's nothing to join with.
+    if (_uncheckedIsTrailer(column))
+    {
+        return {};
+    }
+
+    const auto beg = _uncheckedCharOffset(_adjustBackward(column - 1));
+    const auto end = _uncheckedCharOffset(column);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const std::wstring_view glyph{ _chars.data() + beg, gsl::narrow_cast<size_t>(end - beg) };
+    return IsGraphemeClusterBoundary(glyph, text) ? std::wstring_view{} : glyph;
+}
+
 void ROW::ReplaceText(RowWriteState& state)
 try
 {
-    WriteHelper h{ *this, state.columnBegin, state.columnLimit, state.text };
+    auto columnBegin = state.columnBegin;
+    auto text = state.text;
+    std::wstring joined;
+
+    // Output is split up into writes arbitrarily (by the size of reads from a pipe, by WriteSliced(), etc.).
+    // If a write starts with combining marks, joiners, etc., they're joined with the glyph in front of them
+    // as if both had been written at once, so that the contents of the row don't depend on that split.
+    if (state.joinPrecedingGlyph && columnBegin <= state.columnLimit)
+    {
+        if (const auto glyph = _precedingJoinableGlyph(columnBegin, text); !glyph.empty())
+        {
+            joined.reserve(glyph.size() + text.size());
+            joined.append(glyph).append(text);
+            columnBegin = _adjustBackward(columnBegin - 1);
+            text = joined;
+        }
+    }
+
+    WriteHelper h{ *this, columnBegin, state.columnLimit, text };
     if (!h.IsValid())
     {
         state.columnEnd = h.colBeg;
@@ -623,7 +857,9 @@ try
     h.ReplaceText();
     h.Finish();
 
-    state.text = state.text.substr(h.charsConsumed);
+    // The joined glyph is the same width as before and always fits, so it's always consumed.
+    const auto joinedLength = text.size() - state.text.size();
+    state.text = state.text.substr(std::max(h.charsConsumed, joinedLength) - joinedLength);
     // Here's why we set `state.columnEnd` to `colLimit` if there's remaining text:
     // Callers should be able to use `state.columnEnd` as the next cursor position, as well as the parameter for a
     // follow-up call to ReplaceAttributes(). But if we fail to insert a wide glyph into the last column of a row,
@@ -654,8 +890,7 @@ catch (...)
     {
         if (*it >= 0x80) [[unlikely]]
         {
-            _replaceTextUnicode(ch, it);
-            return;
+            break;
         }
 
         til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
@@ -664,6 +899,21 @@ catch (...)
         ++it;
     }
 
+    if (it != chars.end() && *it >= 0x80) [[unlikely]]
+    {
+        // A non-ASCII character may extend the preceding ASCII one into a
+        // larger grapheme cluster (for instance "e\u0301"). In that case
+        // the slow-path needs to start with that last ASCII character.
+        if (it != chars.begin() && GraphemeClusterNext(chars, ch - chBeg - 1) != ch - chBeg)
+        {
+            --it;
+            --ch;
+            --colEnd;
+        }
+        _replaceTextUnicode(ch, it);
+        return;
+    }
+
     colEndDirty = colEnd;
     charsConsumed = ch - chBeg;
 }
@@ -679,7 +929,11 @@ catch (...)
         const auto wch = *ptr;
         size_t advance = 1;
 
-        ++it;
+        // Each extended grapheme cluster is stored in a single (possibly wide) cell.
+        // Its width is that of its first codepoint, since any combining marks,
+        // joiners or variation selectors that follow it are drawn on top of it.
+        const auto offset = ch - chBeg;
+        const auto clusterLength = GraphemeClusterNext(chars, offset) - offset;
 
         // Even in our slow-path we can avoid calling IsGlyphFullWidth if the current character is ASCII.
         // It also allows us to skip the surrogate pair decoding at the same time.
@@ -687,10 +941,9 @@ catch (...)
         {
             if (til::is_surrogate(wch))
             {
-                if (it != end && til::is_leading_surrogate(wch) && til::is_trailing_surrogate(*it))
+                if (clusterLength >= 2 && til::is_leading_surrogate(wch) && til::is_trailing_surrogate(*(it + 1)))
                 {
                     advance = 2;
-                    ++it;
                 }
                 else
                 {
@@ -701,6 +954,8 @@ catch (...)
             width = IsGlyphFullWidth({ ptr, advance }) + 1u;
         }
 
+        it += clusterLength;
+
         const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + width);
         if (colEndNew > colLimit)
         {
@@ -719,7 +974,7 @@ catch (...)
             til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch | CharOffsetsTrailer);
         }
 
-        ch += advance;
+        ch += clusterLength;
     }
 
     colEndDirty = colEnd;
@@ -1072,23 +1327,82 @@ til::CoordType ROW::GetTrailingColumnAtCharOffset(const ptrdiff_t offset) const
     return _createCharToColumnMapper(offset).GetTrailingColumnAt(offset);
 }
 
-DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
+DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const DelimiterClassifier& classifier) const noexcept
 {
     const auto col = _clampedColumn(column);
     // Safety: col is [0, _columnCount).
-    const auto glyph = _uncheckedChar(_uncheckedCharOffset(col));
+    return classifier.Classify(_uncheckedChar(_uncheckedCharOffset(col)));
+}
+
+// Returns the first column at or after the given one whose DelimiterClass isn't part of `classes`,
+// or the row width if there's none. Instead of classifying one column at a time, this searches
+// the underlying text with DelimiterClassifier::FindForward and maps the result back to a column.
+til::CoordType ROW::SkipDelimiterClassForward(til::CoordType column, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const noexcept
+{
+    const auto beg = _chars.data();
+    const auto end = beg + _charSize();
+    til::CoordType col = _clampedColumnInclusive(column);
 
-    if (glyph <= L' ')
+    while (col < _columnCount)
     {
-        return DelimiterClass::ControlChar;
+        const auto it = classifier.FindForward(beg + _uncheckedCharOffset(col), end, classes);
+        if (it == end)
+        {
+            break;
+        }
+
+        // If `col` was the trailing half of a wide glyph, the glyph's leading column precedes it.
+        const auto lead = std::max(col, _createCharToColumnMapper(it - beg).GetLeadingColumnAt(it));
+
+        // The search may have stopped on a trailing character of a glyph (e.g. a combining
+        // mark), but a column's class is only decided by its leading character.
+        if (!classes.test(classifier.Classify(_uncheckedChar(_uncheckedCharOffset(lead)))))
+        {
+            return lead;
+        }
+
+        col = _adjustForward(lead + 1);
     }
-    else if (wordDelimiters.find(glyph) != std::wstring_view::npos)
+
+    return _columnCount;
+}
+
+// Returns the last column at or before the given one whose DelimiterClass isn't part of `classes`,
+// or -1 if there's none. For wide glyphs the glyph's trailing column is returned.
+// This is the counterpart to SkipDelimiterClassForward.
+til::CoordType ROW::SkipDelimiterClassBackward(til::CoordType column, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const noexcept
+{
+    if (column < 0)
     {
-        return DelimiterClass::DelimiterChar;
+        return -1;
     }
-    else
+
+    const auto beg = _chars.data();
+    til::CoordType col = _clampedColumn(column);
+
+    for (;;)
     {
-        return DelimiterClass::RegularChar;
+        // Only the leading character of the glyph at `col` decides its class,
+        // which is why the search range ends right after it.
+        const auto it = classifier.FindBackward(beg, beg + _uncheckedCharOffset(col) + 1, classes);
+        if (!it)
+        {
+            return -1;
+        }
+
+        auto mapper = _createCharToColumnMapper(it - beg);
+        const auto lead = mapper.GetLeadingColumnAt(it);
+
+        if (!classes.test(classifier.Classify(_uncheckedChar(_uncheckedCharOffset(lead)))))
+        {
+            return std::min(col, mapper.GetTrailingColumnAt(it));
+        }
+        if (lead == 0)
+        {
+            return -1;
+        }
+
+        col = lead - 1;
     }
 }
 
@@ -19,6 +19,29 @@ enum class DelimiterClass
     RegularChar
 };
 
+using DelimiterClassSet = til::enumset<DelimiterClass, uint8_t>;
+
+// Precomputed form of a `wordDelimiters` string. Characters <= U+0020 are always a ControlChar.
+// ASCII delimiters are stored in a 16x8 bitmap which doubles as the nibble lookup table for the
+// vectorized FindForward/FindBackward. Non-ASCII delimiters are stored sorted for a binary search.
+class DelimiterClassifier
+{
+public:
+    DelimiterClassifier() = default;
+    explicit DelimiterClassifier(std::wstring_view wordDelimiters);
+
+    std::wstring_view Delimiters() const noexcept;
+    DelimiterClass Classify(wchar_t wch) const noexcept;
+    const wchar_t* FindForward(const wchar_t* beg, const wchar_t* end, DelimiterClassSet classes) const noexcept;
+    const wchar_t* FindBackward(const wchar_t* beg, const wchar_t* end, DelimiterClassSet classes) const noexcept;
+
+private:
+    // Bit N of _asciiNibbles[wch & 0xf] is set if wch is a delimiter and (wch >> 4) == N.
+    alignas(16) std::array<uint8_t, 16> _asciiNibbles{};
+    std::wstring _nonAscii;
+    std::wstring _delimiters;
+};
+
 struct RowWriteState
 {
     // The text you want to write into the given ROW. When ReplaceText() returns,
@@ -28,6 +51,10 @@ struct RowWriteState
     til::CoordType columnBegin = 0; // IN
     // The first column which should not be written to anymore.
     til::CoordType columnLimit = til::CoordTypeMax; // IN
+    // If true and the text starts with combining marks, joiners, etc., they're joined with the glyph in front of
+    // columnBegin, as if both had been written at once. This is only meant for streams of text, like VT output,
+    // which can be split up into writes arbitrarily. Writes at a given position, and fills, must not set it.
+    bool joinPrecedingGlyph = false; // IN
 
     // The column 1 past the last glyph that was successfully written into the row. If you need to call
     // ReplaceAttributes() to colorize the written range, etc., this is the columnEnd parameter you want.
@@ -144,6 +171,7 @@ public:
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
+    bool JoinsPrecedingGlyph(til::CoordType column, const std::wstring_view& text) const noexcept;
     void CopyTextFrom(RowCopyTextFromState& state);
 
     til::small_rle<TextAttribute, uint16_t, 1>& Attributes() noexcept;
@@ -160,7 +188,9 @@ public:
     std::wstring_view GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
     til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     til::CoordType GetTrailingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
-    DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
+    DelimiterClass DelimiterClassAt(til::CoordType column, const DelimiterClassifier& classifier) const noexcept;
+    til::CoordType SkipDelimiterClassForward(til::CoordType column, DelimiterClassSet classes, const DelimiterClassifier& classifier) const noexcept;
+    til::CoordType SkipDelimiterClassBackward(til::CoordType column, DelimiterClassSet classes, const DelimiterClassifier& classifier) const noexcept;
 
     auto AttrBegin() const noexcept { return _attr.begin(); }
     auto AttrEnd() const noexcept { return _attr.end(); }
@@ -242,6 +272,7 @@ private:
     template<typename T>
     T _adjustForward(T column) const noexcept;
 
+    std::wstring_view _precedingJoinableGlyph(til::CoordType column, const std::wstring_view& text) const noexcept;
     void _init() noexcept;
     void _resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld);
     CharToColumnMapper _createCharToColumnMapper(ptrdiff_t offset) const noexcept;
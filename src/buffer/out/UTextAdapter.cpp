@@ -6,15 +6,20 @@
 
 #include "textBuffer.hpp"
 
+using Microsoft::Console::ICU::UTextIndex;
+
 struct RowRange
 {
     til::CoordType begin;
     til::CoordType end;
 };
 
-constexpr size_t& accessLength(UText* ut) noexcept
+// Rows are grouped into chunks of up to this many code units, unless they're longer than that on their own.
+static constexpr size_t chunkCapacity = 256;
+
+constexpr UTextIndex& accessIndex(UText* ut) noexcept
 {
-    return *std::bit_cast<size_t*>(&ut->p);
+    return *std::bit_cast<UTextIndex*>(ut->q);
 }
 
 constexpr RowRange& accessRowRange(UText* ut) noexcept
@@ -22,9 +27,110 @@ constexpr RowRange& accessRowRange(UText* ut) noexcept
     return *std::bit_cast<RowRange*>(&ut->a);
 }
 
-constexpr til::CoordType& accessCurrentRow(UText* ut) noexcept
+// Builds the UTextIndex, unless that already happened (for instance through another clone of the UText).
+static UTextIndex& ensureIndex(UText* ut)
+{
+    auto& index = accessIndex(ut);
+
+    if (index.rowStarts.empty())
+    {
+        const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
+        const auto range = accessRowRange(ut);
+        const auto rowCount = gsl::narrow_cast<size_t>(std::max(0, range.end - range.begin));
+
+        std::vector<int64_t> rowStarts;
+        std::vector<int64_t> chunkStarts;
+        std::vector<UTextIndex::Chunk> chunks;
+        rowStarts.reserve(rowCount + 1);
+
+        int64_t length = 0;
+        size_t chunkLength = 0;
+
+        for (auto y = range.begin; y < range.end; ++y)
+        {
+            const auto rowLength = textBuffer.GetRowByOffset(y).GetText().size();
+
+            if (chunks.empty() || chunkLength + rowLength > chunkCapacity)
+            {
+                chunkStarts.emplace_back(length);
+                chunks.emplace_back(UTextIndex::Chunk{ .rowBeg = y, .rowEnd = y });
+                chunkLength = 0;
+            }
+
+            rowStarts.emplace_back(length);
+            chunks.back().rowEnd = y + 1;
+            chunkLength += rowLength;
+            length += gsl::narrow_cast<int64_t>(rowLength);
+        }
+
+        rowStarts.emplace_back(length);
+
+        index.chunkStarts = std::move(chunkStarts);
+        index.chunks = std::move(chunks);
+        // rowStarts is assigned last, because it's what marks the index as built.
+        index.rowStarts = std::move(rowStarts);
+    }
+
+    return index;
+}
+
+// Makes chunks[chunkIndex] the current chunk of the UText.
+static void setChunk(UText* ut, UTextIndex& index, size_t chunkIndex)
 {
-    return ut->b;
+    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
+    auto& chunk = til::at(index.chunks, chunkIndex);
+    const auto start = til::at(index.chunkStarts, chunkIndex);
+    const auto limit = chunkIndex + 1 < index.chunks.size() ? til::at(index.chunkStarts, chunkIndex + 1) : index.rowStarts.back();
+    std::wstring_view text;
+
+    if (chunk.rowEnd - chunk.rowBeg == 1)
+    {
+        // Chunks consisting of a single row refer to the row's text directly.
+        text = textBuffer.GetRowByOffset(chunk.rowBeg).GetText();
+    }
+    else
+    {
+        if (gsl::narrow_cast<int64_t>(chunk.text.size()) != limit - start)
+        {
+            chunk.text.reserve(gsl::narrow_cast<size_t>(limit - start));
+            for (auto y = chunk.rowBeg; y < chunk.rowEnd; ++y)
+            {
+                chunk.text.append(textBuffer.GetRowByOffset(y).GetText());
+            }
+        }
+        text = chunk.text;
+    }
+
+    ut->chunkNativeStart = start;
+    ut->chunkNativeLimit = limit;
+    ut->chunkLength = gsl::narrow_cast<int32_t>(text.size());
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    ut->chunkContents = reinterpret_cast<const char16_t*>(text.data());
+    ut->nativeIndexingLimit = ut->chunkLength;
+}
+
+// Returns the row that contains the given native index, as well as the offset of the index within that row's text.
+// Just like utextAccess(), this won't return an offset pointing at a trailing surrogate.
+static std::optional<std::pair<til::CoordType, ptrdiff_t>> rowFromNativeIndex(UText* ut, int64_t nativeIndex)
+{
+    const auto& index = ensureIndex(ut);
+    if (nativeIndex < 0 || nativeIndex >= index.rowStarts.back())
+    {
+        return std::nullopt;
+    }
+
+    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
+    // upper_bound() skips over empty rows which share their start with the next one.
+    const auto it = std::upper_bound(index.rowStarts.begin(), index.rowStarts.end(), nativeIndex) - 1;
+    const auto y = accessRowRange(ut).begin + gsl::narrow_cast<til::CoordType>(it - index.rowStarts.begin());
+    auto offset = gsl::narrow_cast<size_t>(nativeIndex - *it);
+
+    if (offset > 0 && U16_IS_TRAIL(til::at(textBuffer.GetRowByOffset(y).GetText(), offset)))
+    {
+        offset--;
+    }
+
+    return std::pair{ y, gsl::narrow_cast<ptrdiff_t>(offset) };
 }
 
 // An excerpt from the ICU documentation:
@@ -73,22 +179,7 @@ static UText* U_CALLCONV utextClone(UText* dest, const UText* src, UBool deep, U
 static int64_t U_CALLCONV utextNativeLength(UText* ut) noexcept
 try
 {
-    auto length = accessLength(ut);
-
-    if (!length)
-    {
-        const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
-        const auto range = accessRowRange(ut);
-
-        for (til::CoordType y = range.begin; y < range.end; ++y)
-        {
-            length += textBuffer.GetRowByOffset(y).GetText().size();
-        }
-
-        accessLength(ut) = length;
-    }
-
-    return gsl::narrow_cast<int64_t>(length);
+    return ensureIndex(ut).rowStarts.back();
 }
 catch (...)
 {
@@ -111,67 +202,38 @@ catch (...)
 static UBool U_CALLCONV utextAccess(UText* ut, int64_t nativeIndex, UBool forward) noexcept
 try
 {
-    if (nativeIndex < 0)
+    auto& index = ensureIndex(ut);
+    const auto length = index.rowStarts.back();
+
+    if (index.chunks.empty())
     {
-        nativeIndex = 0;
+        return false;
     }
 
+    nativeIndex = std::clamp<int64_t>(nativeIndex, 0, length);
+
     auto neededIndex = nativeIndex;
     if (!forward)
     {
         neededIndex--;
     }
 
-    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
-    const auto range = accessRowRange(ut);
-    auto start = ut->chunkNativeStart;
-    auto limit = ut->chunkNativeLimit;
-    auto y = accessCurrentRow(ut);
-    std::wstring_view text;
-
-    if (neededIndex < start || neededIndex >= limit)
+    if (neededIndex < ut->chunkNativeStart || neededIndex >= ut->chunkNativeLimit)
     {
-        if (neededIndex < start)
-        {
-            do
-            {
-                --y;
-                if (y < range.begin)
-                {
-                    return false;
-                }
-
-                text = textBuffer.GetRowByOffset(y).GetText();
-                limit = start;
-                start -= text.size();
-            } while (neededIndex < start);
-        }
-        else
+        if (neededIndex < 0 || neededIndex >= length)
         {
-            do
-            {
-                ++y;
-                if (y >= range.end)
-                {
-                    return false;
-                }
-
-                text = textBuffer.GetRowByOffset(y).GetText();
-                start = limit;
-                limit += text.size();
-            } while (neededIndex >= limit);
+            // Leave the iteration position at the start or end of the text.
+            setChunk(ut, index, neededIndex < 0 ? 0 : index.chunks.size() - 1);
+            ut->chunkOffset = gsl::narrow_cast<int32_t>(nativeIndex - ut->chunkNativeStart);
+            return false;
         }
 
-        accessCurrentRow(ut) = y;
-        ut->chunkNativeStart = start;
-        ut->chunkNativeLimit = limit;
-        ut->chunkLength = gsl::narrow_cast<int32_t>(text.size());
-#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
-        ut->chunkContents = reinterpret_cast<const char16_t*>(text.data());
-        ut->nativeIndexingLimit = ut->chunkLength;
+        // upper_bound() skips over empty chunks which share their start with the next one.
+        const auto it = std::upper_bound(index.chunkStarts.begin(), index.chunkStarts.end(), neededIndex) - 1;
+        setChunk(ut, index, gsl::narrow_cast<size_t>(it - index.chunkStarts.begin()));
     }
 
-    auto offset = gsl::narrow_cast<int32_t>(nativeIndex - start);
+    auto offset = gsl::narrow_cast<int32_t>(nativeIndex - ut->chunkNativeStart);
 
     // Don't leave the offset on a trailing surrogate pair. See U16_SET_CP_START.
     // This assumes that the TextBuffer contains valid UTF-16 which may theoretically not be the case.
@@ -232,10 +294,10 @@ try
         return gsl::narrow_cast<int32_t>(nativeLimit - nativeStart);
     }
 
-    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
-    const auto y = accessCurrentRow(ut);
-    const auto offset = ut->chunkNativeStart - nativeStart;
-    const auto text = textBuffer.GetRowByOffset(y).GetText().substr(gsl::narrow_cast<size_t>(std::max<int64_t>(0, offset)));
+    const auto offset = gsl::narrow_cast<size_t>(nativeStart - ut->chunkNativeStart);
+    const auto count = gsl::narrow_cast<size_t>(nativeLimit - nativeStart);
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    const auto text = std::wstring_view{ reinterpret_cast<const wchar_t*>(ut->chunkContents), gsl::narrow_cast<size_t>(ut->chunkLength) }.substr(offset, count);
     const auto destCapacitySizeT = gsl::narrow_cast<size_t>(destCapacity);
     const auto length = std::min(destCapacitySizeT, text.size());
 
@@ -251,7 +313,7 @@ try
 }
 catch (...)
 {
-    // The only thing that can fail is GetRowByOffset() which in turn can only fail when VirtualAlloc() fails.
+    // The only things that can fail are GetRowByOffset() (when VirtualAlloc() fails) and building the UTextIndex.
     *status = U_MEMORY_ALLOCATION_ERROR;
     return 0;
 }
@@ -264,17 +326,21 @@ static constexpr UTextFuncs utextFuncs{
 };
 
 // Creates a UText from the given TextBuffer that spans rows [rowBeg,RowEnd).
-UText Microsoft::Console::ICU::UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd) noexcept
+// The `index` is filled lazily and must outlive the returned UText, as well as any of its clones.
+UText Microsoft::Console::ICU::UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd, UTextIndex& index) noexcept
 {
 #pragma warning(suppress : 26477) // Use 'nullptr' rather than 0 or NULL (es.47).
     UText ut = UTEXT_INITIALIZER;
-    ut.providerProperties = (1 << UTEXT_PROVIDER_LENGTH_IS_EXPENSIVE) | (1 << UTEXT_PROVIDER_STABLE_CHUNKS);
+    // Thanks to the UTextIndex the length isn't expensive to compute anymore. The chunks
+    // are stable, because the rows as well as UTextIndex::Chunk::text stay unmodified.
+    ut.providerProperties = 1 << UTEXT_PROVIDER_STABLE_CHUNKS;
     ut.pFuncs = &utextFuncs;
     ut.context = &textBuffer;
-    accessCurrentRow(&ut) = rowBeg - 1; // the utextAccess() below will advance this by 1.
+    ut.q = &index;
     accessRowRange(&ut) = { rowBeg, rowEnd };
 
-    utextAccess(&ut, 0, true);
+    // The UText starts out with an empty chunk. The first call to utextAccess() will build the index.
+    index = {};
     return ut;
 }
 
@@ -303,10 +369,12 @@ til::point_span Microsoft::Console::ICU::BufferRangeFromMatch(UText* ut, URegula
     const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
     til::point_span ret;
 
-    if (utextAccess(ut, nativeIndexBeg, true))
+    // The UTextIndex allows us to map the indices to rows with a binary search,
+    // instead of walking from the UText's current chunk one row at a time.
+    if (const auto beg = rowFromNativeIndex(ut, nativeIndexBeg))
     {
-        const auto y = accessCurrentRow(ut);
-        ret.start.x = textBuffer.GetRowByOffset(y).GetLeadingColumnAtCharOffset(ut->chunkOffset);
+        const auto [y, offset] = *beg;
+        ret.start.x = textBuffer.GetRowByOffset(y).GetLeadingColumnAtCharOffset(offset);
         ret.start.y = y;
     }
     else
@@ -314,10 +382,10 @@ til::point_span Microsoft::Console::ICU::BufferRangeFromMatch(UText* ut, URegula
         ret.start.y = accessRowRange(ut).begin;
     }
 
-    if (utextAccess(ut, nativeIndexEnd, true))
+    if (const auto end = rowFromNativeIndex(ut, nativeIndexEnd))
     {
-        const auto y = accessCurrentRow(ut);
-        ret.end.x = textBuffer.GetRowByOffset(y).GetTrailingColumnAtCharOffset(ut->chunkOffset);
+        const auto [y, offset] = *end;
+        ret.end.x = textBuffer.GetRowByOffset(y).GetTrailingColumnAtCharOffset(offset);
         ret.end.y = y;
     }
     else
@@ -11,7 +11,30 @@ namespace Microsoft::Console::ICU
 {
     using unique_uregex = wistd::unique_ptr<URegularExpression, wil::function_deleter<decltype(&uregex_close), &uregex_close>>;
 
-    UText UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd) noexcept;
+    // An index over the rows spanned by a UText from UTextFromTextBuffer. It's built lazily on first use and
+    // maps native indices to rows in O(log n). It also groups consecutive short rows into larger chunks, which
+    // reduces the number of access callbacks ICU has to make. The UText and all of its clones refer to it,
+    // which is why it must outlive them.
+    struct UTextIndex
+    {
+        struct Chunk
+        {
+            til::CoordType rowBeg = 0;
+            til::CoordType rowEnd = 0;
+            // The concatenated text of the rows [rowBeg,rowEnd) if there's more than one of them.
+            // It's filled when the chunk is first accessed and not modified afterwards.
+            std::wstring text;
+        };
+
+        // rowStarts[i] is the native index at which row `rowBeg + i` begins.
+        // The last item is the native length of the entire text.
+        std::vector<int64_t> rowStarts;
+        // chunkStarts[i] is the native index at which chunks[i] begins.
+        std::vector<int64_t> chunkStarts;
+        std::vector<Chunk> chunks;
+    };
+
+    UText UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd, UTextIndex& index) noexcept;
     unique_uregex CreateRegex(const std::wstring_view& pattern, uint32_t flags, UErrorCode* status) noexcept;
     til::point_span BufferRangeFromMatch(UText* ut, URegularExpression* re);
 }
@@ -8,8 +8,10 @@
 #include <til/hash.h>
 #include <til/unicode.h>
 
+#include "textBufferRunIterator.hpp"
 #include "UTextAdapter.h"
 #include "../../types/inc/GlyphWidth.hpp"
+#include "../../types/inc/GraphemeBreak.hpp"
 #include "../renderer/base/renderer.hpp"
 #include "../types/inc/convert.hpp"
 #include "../types/inc/utils.hpp"
@@ -226,6 +228,10 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
 ROW& TextBuffer::GetMutableRowByOffset(const til::CoordType index)
 {
     _lastMutationId++;
+    if (_journal)
+    {
+        _journal->RecordRows(_lastMutationId, index, index + 1);
+    }
     return _getRow(index);
 }
 
@@ -401,19 +407,18 @@ void TextBuffer::_PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute
 }
 
 // Given the character offset `position` in the `chars` string, this function returns the starting position of the next grapheme.
-// For instance, given a `chars` of L"x\uD83D\uDE42y" and a `position` of 1 it'll return 3.
+// For instance, given a `chars` of L"xe\u0301y" and a `position` of 1 it'll return 3.
 // GraphemePrev would do the exact inverse of this operation.
-// In the future, these functions are expected to also deliver information about how many columns a grapheme occupies.
-// (I know that mere UTF-16 code point iteration doesn't handle graphemes, but that's what we're working towards.)
+// Graphemes are extended grapheme clusters as defined by UAX #29. See GraphemeClusterNext.
 size_t TextBuffer::GraphemeNext(const std::wstring_view& chars, size_t position) noexcept
 {
-    return til::utf16_iterate_next(chars, position);
+    return GraphemeClusterNext(chars, position);
 }
 
 // It's the counterpart to GraphemeNext. See GraphemeNext.
 size_t TextBuffer::GraphemePrev(const std::wstring_view& chars, size_t position) noexcept
 {
-    return til::utf16_iterate_prev(chars, position);
+    return GraphemeClusterPrev(chars, position);
 }
 
 // Pretend as if `position` is a regular cursor in the TextBuffer.
@@ -539,6 +544,311 @@ void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill,
     }
 }
 
+// Applies legacy console attributes to consecutive columns of a row, starting at the given column.
+// Neighbors that only differ in their lead/trail byte flags are coalesced into a single run,
+// which turns a long span of cells into one ReplaceAttributes() call per color change.
+template<typename T, typename Projection>
+static til::CoordType replaceLegacyAttributeRuns(ROW& row, til::CoordType column, const std::span<const T> items, Projection&& projection)
+{
+    static constexpr auto colorOnly = [](const WORD attr) noexcept {
+        return gsl::narrow_cast<WORD>(attr & ~COMMON_LVB_SBCSDBCS);
+    };
+
+    for (auto it = items.begin(), end = items.end(); it != end;)
+    {
+        const auto attr = colorOnly(projection(*it));
+        const auto runEnd = std::find_if(it + 1, end, [&](const T& item) { return colorOnly(projection(item)) != attr; });
+        const auto runLength = gsl::narrow_cast<til::CoordType>(runEnd - it);
+        row.ReplaceAttributes(column, column + runLength, TextAttribute{ attr });
+        column += runLength;
+        it = runEnd;
+    }
+
+    return column;
+}
+
+// Writes text into the buffer starting at target and continues on the following rows if needed.
+// The existing attributes are left untouched. Returns the number of characters that were consumed.
+size_t TextBuffer::WriteText(const til::point target, const std::wstring_view& text, const std::optional<bool> wrap)
+{
+    const auto size = GetSize();
+    if (text.empty() || !size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    const auto width = size.Width();
+    const auto height = size.Height();
+    RowWriteState state{
+        .text = text,
+        .columnBegin = target.x,
+        .columnLimit = width,
+    };
+
+    for (auto y = target.y; y < height && !state.text.empty(); ++y)
+    {
+        auto& r = GetMutableRowByOffset(y);
+        r.ReplaceText(state);
+        // NOTE: if wrap = true/false, we want to set the line's wrap to true/false (respectively) if we reach the end of the line
+        if (wrap.has_value() && state.columnEnd >= width)
+        {
+            r.SetWrapForced(*wrap);
+        }
+        TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
+        state.columnBegin = 0;
+    }
+
+    return text.size() - state.text.size();
+}
+
+// Writes count copies of the given character starting at target and continues on the following rows if needed.
+// The existing attributes are left untouched. Returns the number of glyphs that were written.
+size_t TextBuffer::FillText(const til::point target, const wchar_t wch, const size_t count, const std::optional<bool> wrap)
+{
+    const auto size = GetSize();
+    if (count == 0 || !size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    const auto width = size.Width();
+    const auto height = size.Height();
+    const std::wstring_view fill{ &wch, 1 };
+    const til::CoordType glyphWidth = IsGlyphFullWidth(wch) ? 2 : 1;
+    auto& scratchpad = GetScratchpadRow();
+    auto scratchpadBegin = til::CoordTypeMax;
+    auto remaining = count;
+
+    for (auto y = target.y, x = target.x; y < height && remaining != 0; ++y, x = 0)
+    {
+        // Lay out consecutive copies of the fill character into the scratchpad. Wide glyphs only
+        // line up with the destination if both start at the same column, which is why this is
+        // redone when the first row starts somewhere else than the following ones (at most twice).
+        // See FillRect() for why we don't write a single string with N copies of "fill" instead.
+        if (scratchpadBegin != x)
+        {
+            RowWriteState state{
+                .columnLimit = width,
+                .columnEnd = x,
+            };
+            while (state.columnEnd < width)
+            {
+                state.columnBegin = state.columnEnd;
+                state.text = fill;
+                scratchpad.ReplaceText(state);
+            }
+            scratchpadBegin = x;
+        }
+
+        const auto glyphs = std::min(remaining, gsl::narrow_cast<size_t>((width - x) / glyphWidth));
+        auto columnEnd = x + gsl::narrow_cast<til::CoordType>(glyphs) * glyphWidth;
+        // If a wide glyph doesn't fit into the last column, we pad it with whitespace and continue on the next row.
+        const auto padded = glyphs < remaining && columnEnd < width;
+        if (padded)
+        {
+            columnEnd = width;
+        }
+
+        RowCopyTextFromState state{
+            .source = scratchpad,
+            .columnBegin = x,
+            .columnLimit = columnEnd,
+            .sourceColumnBegin = x,
+            .sourceColumnLimit = columnEnd,
+        };
+        auto& r = GetMutableRowByOffset(y);
+        r.CopyTextFrom(state);
+        if (padded)
+        {
+            r.SetDoubleBytePadded(true);
+        }
+        if (wrap.has_value() && columnEnd >= width)
+        {
+            r.SetWrapForced(*wrap);
+        }
+        TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
+
+        remaining -= glyphs;
+    }
+
+    return count - remaining;
+}
+
+// Writes legacy console attributes (as passed to WriteConsoleOutputAttribute) starting at target
+// and continues on the following rows if needed. The lead/trail byte flags are ignored and
+// the text is left untouched. Returns the number of cells that were written.
+size_t TextBuffer::WriteAttributes(const til::point target, const std::span<const WORD> legacyAttrs)
+{
+    const auto size = GetSize();
+    if (!size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    const auto width = size.Width();
+    const auto height = size.Height();
+    size_t written = 0;
+
+    for (auto y = target.y, x = target.x; y < height && written < legacyAttrs.size(); ++y, x = 0)
+    {
+        const auto columns = std::min(legacyAttrs.size() - written, gsl::narrow_cast<size_t>(width - x));
+        auto& r = GetMutableRowByOffset(y);
+        const auto columnEnd = replaceLegacyAttributeRuns(r, x, legacyAttrs.subspan(written, columns), [](const WORD attr) noexcept { return attr; });
+        TriggerRedraw(Viewport::FromExclusive({ x, y, columnEnd, y + 1 }));
+        written += columns;
+    }
+
+    return written;
+}
+
+// Fills count cells with the given attributes starting at target and continues on the following rows
+// if needed. The text is left untouched. Returns the number of cells that were written.
+size_t TextBuffer::FillAttributes(const til::point target, const TextAttribute& attributes, const size_t count)
+{
+    const auto size = GetSize();
+    if (!size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    const auto width = size.Width();
+    const auto height = size.Height();
+    size_t written = 0;
+
+    for (auto y = target.y, x = target.x; y < height && written < count; ++y, x = 0)
+    {
+        const auto columns = std::min(count - written, gsl::narrow_cast<size_t>(width - x));
+        const auto columnEnd = x + gsl::narrow_cast<til::CoordType>(columns);
+        GetMutableRowByOffset(y).ReplaceAttributes(x, columnEnd, attributes);
+        TriggerRedraw(Viewport::FromExclusive({ x, y, columnEnd, y + 1 }));
+        written += columns;
+    }
+
+    return written;
+}
+
+// Writes a span of CHAR_INFOs (as passed to WriteConsoleOutput) into a single row starting at target.
+// CHAR_INFOs are aligned to columns and carry their own lead/trail byte classification, which means
+// that we don't need to measure any glyphs. Writing stops at the end of the row.
+// Returns the number of columns that were written.
+til::CoordType TextBuffer::WriteCharInfos(const til::point target, const std::span<const CHAR_INFO> charInfos, const std::optional<bool> wrap)
+{
+    const auto size = GetSize();
+    if (charInfos.empty() || !size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    const auto width = size.Width();
+    const auto cells = charInfos.first(std::min(charInfos.size(), gsl::narrow_cast<size_t>(width - target.x)));
+    auto& r = GetMutableRowByOffset(target.y);
+    auto columnBeginDirty = target.x;
+    auto column = target.x;
+
+    for (auto it = cells.begin(), end = cells.end(); it != end; ++it, ++column)
+    {
+        const std::wstring_view chars{ &it->Char.UnicodeChar, 1 };
+
+        if (WI_IsFlagSet(it->Attributes, COMMON_LVB_LEADING_BYTE))
+        {
+            if (column + 1 >= width)
+            {
+                // The wide char doesn't fit. Pad with whitespace.
+                r.ClearCell(column);
+                r.SetDoubleBytePadded(true);
+            }
+            else
+            {
+                r.ReplaceCharacters(column, 2, chars);
+            }
+        }
+        else if (WI_IsFlagSet(it->Attributes, COMMON_LVB_TRAILING_BYTE))
+        {
+            if (column == 0)
+            {
+                // The wide char doesn't fit. Pad with whitespace.
+                r.ClearCell(column);
+            }
+            else if (it == cells.begin())
+            {
+                // A common way to back up and restore the buffer is via `ReadConsoleOutputW` and `WriteConsoleOutputW`
+                // respectively, which might clip a wide glyph and only back up its trailing half. We only look at the
+                // trailer if it's the first `CHAR_INFO` the user is trying to write, just like ROW::WriteCells().
+                r.ReplaceCharacters(column - 1, 2, chars);
+                columnBeginDirty = column - 1;
+            }
+            // Otherwise this is the trailing half of the glyph we just wrote for the preceding leading half.
+        }
+        else
+        {
+            r.ReplaceCharacters(column, 1, chars);
+        }
+    }
+
+    replaceLegacyAttributeRuns(r, target.x, cells, [](const CHAR_INFO& ci) noexcept { return ci.Attributes; });
+
+    // NOTE: if wrap = true/false, we want to set the line's wrap to true/false (respectively) if we reach the end of the line
+    if (wrap.has_value() && column >= width)
+    {
+        r.SetWrapForced(*wrap);
+    }
+
+    // A leading half in the last written column extends one column past the span.
+    TriggerRedraw(Viewport::FromExclusive({ columnBeginDirty, target.y, std::min(column + 1, width), target.y + 1 }));
+    return column - target.x;
+}
+
+// Reads up to charInfos.size() cells of the row at source.y into charInfos, starting at source.x.
+// This is the counterpart to WriteCharInfos(): Glyphs consisting of more than one UTF-16 code unit are
+// returned as U+FFFD and wide glyphs are split into a leading and trailing half, even if the read
+// begins or ends in the middle of one. Returns the number of cells that were read.
+til::CoordType TextBuffer::ReadCharInfos(const til::point source, const std::span<CHAR_INFO> charInfos) const
+{
+    const auto size = GetSize();
+    if (charInfos.empty() || !size.IsInBounds(source))
+    {
+        return 0;
+    }
+
+    const auto columnEnd = source.x + gsl::narrow_cast<til::CoordType>(std::min(charInfos.size(), gsl::narrow_cast<size_t>(size.Width() - source.x)));
+    const auto& r = GetRowByOffset(source.y);
+    auto out = charInfos.begin();
+
+    // The legacy attributes only need to be computed once per attribute run, which
+    // matters for RGB colors as those have to be mapped to the closest table entry.
+    for (TextBufferRunIterator it{ r, source.x, columnEnd }; it; ++it)
+    {
+        const auto legacyAttributes = it->attr.GetLegacyAttributes();
+
+        for (auto column = it->columnBegin; column < it->columnEnd;)
+        {
+            const auto glyphBegin = r.AdjustToGlyphStart(column);
+            const auto glyphEnd = r.NavigateToNext(glyphBegin);
+            const auto glyph = r.GlyphAt(glyphBegin);
+            const auto ch = glyph.size() == 1 ? glyph.front() : UNICODE_REPLACEMENT;
+            const auto end = std::min(glyphEnd, it->columnEnd);
+
+            for (; column < end; ++column, ++out)
+            {
+                auto attr = legacyAttributes;
+                if (column != glyphBegin)
+                {
+                    attr |= COMMON_LVB_TRAILING_BYTE;
+                }
+                else if (glyphEnd - glyphBegin > 1)
+                {
+                    attr |= COMMON_LVB_LEADING_BYTE;
+                }
+
+                out->Char.UnicodeChar = ch;
+                out->Attributes = attr;
+            }
+        }
+    }
+
+    return columnEnd - source.x;
+}
+
 // Routine Description:
 // - Writes cells to the output buffer. Writes at the cursor.
 // Arguments:
@@ -792,6 +1102,12 @@ void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
             _firstRow = 0;
         }
     }
+
+    _lastMutationId++;
+    if (_journal)
+    {
+        _journal->RecordRotation(1);
+    }
 }
 
 //Routine Description:
@@ -970,6 +1286,36 @@ uint64_t TextBuffer::GetLastMutationId() const noexcept
     return _lastMutationId;
 }
 
+// Starts recording which rows change, so that consumers can use GetChangesSince()
+// instead of rescanning the entire buffer. Multiple consumers can share the journal,
+// in which case it'll use the largest of the requested capacities.
+void TextBuffer::EnableChangeJournal(const size_t capacity)
+{
+    if (!_journal || _journal->Capacity() < capacity)
+    {
+        _journal = std::make_unique<TextBufferJournal>(capacity);
+        _lastMutationId++;
+        _journal->Invalidate(_lastMutationId);
+    }
+}
+
+// Returns the current position in the buffer's history, to be passed to GetChangesSince() later on.
+TextBufferJournal::Position TextBuffer::GetJournalPosition() const noexcept
+{
+    return { _lastMutationId, _journal ? _journal->ScrollOffset() : 0 };
+}
+
+// Returns the rows which changed since the given position was retrieved.
+// If the change journal isn't enabled, this always asks the caller to invalidate everything.
+TextBufferJournal::Changes TextBuffer::GetChangesSince(const TextBufferJournal::Position& position) const
+{
+    if (!_journal)
+    {
+        return { .invalidateAll = true };
+    }
+    return _journal->ChangesSince(position, GetJournalPosition(), _height);
+}
+
 const TextAttribute& TextBuffer::GetCurrentAttributes() const noexcept
 {
     return _currentAttributes;
@@ -1062,8 +1408,49 @@ void TextBuffer::Reset() noexcept
 {
     _decommit();
     _initialAttributes = _currentAttributes;
+
+    _lastMutationId++;
+    if (_journal)
+    {
+        _journal->Invalidate(_lastMutationId);
+    }
 }
 
+// Routine Description:
+// - Returns this buffer to the state it had right after construction with the given
+//   attributes and cursor size, so that it can be used in place of a new one of the same size.
+// - Unlike Reset(), this keeps the committed memory and resets the ROWs in it in place.
+//   This makes it cheap to reuse buffers that are frequently discarded, like the alternate screen buffer.
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+void TextBuffer::Recycle(const TextAttribute& attributes, const UINT cursorSize) noexcept
+{
+    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride)
+    {
+        reinterpret_cast<ROW*>(it)->Reset(attributes);
+    }
+
+    _initialAttributes = attributes;
+    _currentAttributes = attributes;
+    _firstRow = 0;
+    _hyperlinkMap.clear();
+    _hyperlinkCustomIdMap.clear();
+    _currentHyperlinkId = 1;
+    _marks.clear();
+
+    // Cursor holds a reference to us and can't be assigned to, so we construct a new one in its place.
+    std::destroy_at(&_cursor);
+    std::construct_at(&_cursor, cursorSize, *this);
+
+    _lastMutationId++;
+    if (_journal)
+    {
+        _journal->Invalidate(_lastMutationId);
+    }
+}
+#pragma warning(pop)
+
 // Routine Description:
 // - This is the legacy screen resize with minimal changes
 // Arguments:
@@ -1104,6 +1491,12 @@ void TextBuffer::ResizeTraditional(til::size newSize)
     _height = newBuffer._height;
 
     _SetFirstRowIndex(0);
+
+    _lastMutationId++;
+    if (_journal)
+    {
+        _journal->Invalidate(_lastMutationId);
+    }
 }
 
 void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
@@ -1170,16 +1563,84 @@ void TextBuffer::TriggerNewTextNotification(const std::wstring_view newText)
 }
 
 // Method Description:
-// - get delimiter class for buffer cell position
+// - Returns the DelimiterClassifier for the given word delimiters.
 // - used for double click selection and uia word navigation
 // Arguments:
-// - pos: the buffer cell under observation
 // - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
 // Return Value:
-// - the delimiter class for the given char
-DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const
+// - A classifier, which is only rebuilt if wordDelimiters changed since the last call
+const DelimiterClassifier& TextBuffer::_GetDelimiterClassifier(const std::wstring_view wordDelimiters) const
 {
-    return GetRowByOffset(pos.y).DelimiterClassAt(pos.x, wordDelimiters);
+    if (_delimiterClassifier.Delimiters() != wordDelimiters)
+    {
+        _delimiterClassifier = DelimiterClassifier{ wordDelimiters };
+    }
+    return _delimiterClassifier;
+}
+
+// Method Description:
+// - Moves pos forward until it's on a cell whose delimiter class isn't part of `classes`.
+//   Each row is searched in one go via ROW::SkipDelimiterClassForward.
+// Arguments:
+// - pos: the position to start at. Updated to the resulting position.
+// - limit: the search stops once pos reaches this position
+// - classes: the delimiter classes to skip over
+// - classifier: the classifier for the current word delimiters
+// Return Value:
+// - false if we moved past the end of the buffer. pos will then be BottomRightInclusive.
+bool TextBuffer::_SkipDelimiterClassForward(til::point& pos, const til::point limit, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const
+{
+    const auto bufferSize = GetSize();
+
+    for (;;)
+    {
+        auto x = GetRowByOffset(pos.y).SkipDelimiterClassForward(pos.x, classes, classifier);
+        if (pos.y == limit.y && x > limit.x)
+        {
+            x = limit.x;
+        }
+        if (x <= bufferSize.RightInclusive())
+        {
+            pos.x = x;
+            return true;
+        }
+        if (pos.y >= bufferSize.BottomInclusive())
+        {
+            pos = bufferSize.BottomRightInclusive();
+            return false;
+        }
+        pos = { bufferSize.Left(), pos.y + 1 };
+    }
+}
+
+// Method Description:
+// - Moves pos backward until it's on a cell whose delimiter class isn't part of `classes`.
+//   Each row is searched in one go via ROW::SkipDelimiterClassBackward.
+// Arguments:
+// - pos: the position to start at. Updated to the resulting position.
+// - classes: the delimiter classes to skip over
+// - classifier: the classifier for the current word delimiters
+// Return Value:
+// - false if we moved past the start of the buffer. pos will then be the buffer origin.
+bool TextBuffer::_SkipDelimiterClassBackward(til::point& pos, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const
+{
+    const auto bufferSize = GetSize();
+
+    for (;;)
+    {
+        const auto x = GetRowByOffset(pos.y).SkipDelimiterClassBackward(pos.x, classes, classifier);
+        if (x >= bufferSize.Left())
+        {
+            pos.x = x;
+            return true;
+        }
+        if (pos.y <= bufferSize.Top())
+        {
+            pos = bufferSize.Origin();
+            return false;
+        }
+        pos = { bufferSize.RightInclusive(), pos.y - 1 };
+    }
 }
 
 // Method Description:
@@ -1247,34 +1708,20 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
 {
     auto result = target;
     const auto bufferSize = GetSize();
-    auto stayAtOrigin = false;
+    const auto& classifier = _GetDelimiterClassifier(wordDelimiters);
 
     // ignore left boundary. Continue until readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassBackward(result, { DelimiterClass::ControlChar, DelimiterClass::DelimiterChar }, classifier))
     {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a DelimiterChar or ControlChar
-            // we can't move any further back
-            stayAtOrigin = true;
-            break;
-        }
+        // first char in buffer is a DelimiterChar or ControlChar
+        // we can't move any further back
+        return result;
     }
 
     // make sure we expand to the left boundary or the beginning of the word
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a RegularChar
-            // we can't move any further back
-            break;
-        }
-    }
-
-    // move off of delimiter and onto word start
-    if (!stayAtOrigin && _GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    if (_SkipDelimiterClassBackward(result, { DelimiterClass::RegularChar }, classifier))
     {
+        // move off of delimiter and onto word start
         bufferSize.IncrementInBounds(result);
     }
 
@@ -1290,24 +1737,15 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
 // - The til::point for the first character on the current word or delimiter run (stopped by the left margin)
 til::point TextBuffer::_GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const
 {
-    auto result = target;
-    const auto bufferSize = GetSize();
-
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& classifier = _GetDelimiterClassifier(wordDelimiters);
+    const auto& row = GetRowByOffset(target.y);
+    const auto initialDelimiter = row.DelimiterClassAt(target.x, classifier);
 
     // expand left until we hit the left boundary or a different delimiter class
-    while (result.x > bufferSize.Left() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.DecrementInBounds(result);
-    }
+    const auto x = row.SkipDelimiterClassBackward(target.x, { initialDelimiter }, classifier);
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.IncrementInBounds(result);
-    }
-
-    return result;
+    // move off of delimiter
+    return { x + 1, target.y };
 }
 
 // Method Description:
@@ -1375,25 +1813,13 @@ til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, cons
     }
     else
     {
-        auto iter{ GetCellDataAt(result, bufferSize) };
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) == DelimiterClass::RegularChar)
-        {
-            // Iterate through readable text
-            ++iter;
-        }
+        const auto& classifier = _GetDelimiterClassifier(wordDelimiters);
 
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) != DelimiterClass::RegularChar)
-        {
-            // expand to the beginning of the NEXT word
-            ++iter;
-        }
-
-        result = iter.Pos();
-
-        // Special case: we tried to move one past the end of the buffer,
-        // but iter prevented that (because that pos doesn't exist).
-        // Manually increment onto the EndExclusive point.
-        if (!iter)
+        // Iterate through readable text and then expand to the beginning of the NEXT word.
+        // Special case: if we tried to move one past the end of the buffer,
+        // manually increment onto the EndExclusive point.
+        if (!_SkipDelimiterClassForward(result, limit, { DelimiterClass::RegularChar }, classifier) ||
+            !_SkipDelimiterClassForward(result, limit, { DelimiterClass::ControlChar, DelimiterClass::DelimiterChar }, classifier))
         {
             bufferSize.IncrementInBounds(result, true);
         }
@@ -1419,22 +1845,15 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
         return target;
     }
 
-    auto result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& classifier = _GetDelimiterClassifier(wordDelimiters);
+    const auto& row = GetRowByOffset(target.y);
+    const auto initialDelimiter = row.DelimiterClassAt(target.x, classifier);
 
     // expand right until we hit the right boundary or a different delimiter class
-    while (result.x < bufferSize.RightInclusive() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.IncrementInBounds(result);
-    }
+    const auto x = row.SkipDelimiterClassForward(target.x, { initialDelimiter }, classifier);
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.DecrementInBounds(result);
-    }
-
-    return result;
+    // move off of delimiter
+    return { x - 1, target.y };
 }
 
 void TextBuffer::_PruneHyperlinks()
@@ -2608,6 +3027,14 @@ void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const View
 
     newBuffer._marks = oldBuffer._marks;
     newBuffer._trimMarksOutsideBuffer();
+
+    // The journal's consumers remain interested in the contents, but everything they know is outdated now.
+    newBuffer._journal = std::move(oldBuffer._journal);
+    newBuffer._lastMutationId++;
+    if (newBuffer._journal)
+    {
+        newBuffer._journal->Invalidate(newBuffer._lastMutationId);
+    }
 }
 
 // Method Description:
@@ -2737,7 +3164,8 @@ std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& nee
         return results;
     }
 
-    auto text = ICU::UTextFromTextBuffer(*this, rowBeg, rowEnd);
+    ICU::UTextIndex index;
+    auto text = ICU::UTextFromTextBuffer(*this, rowBeg, rowEnd, index);
 
     uint32_t flags = UREGEX_LITERAL;
     WI_SetFlagIf(flags, UREGEX_CASE_INSENSITIVE, caseInsensitive);
@@ -54,6 +54,7 @@ filling in the last row, and updating the screen.
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
+#include "textBufferJournal.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -144,6 +145,13 @@ public:
     void Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
 
+    size_t WriteText(const til::point target, const std::wstring_view& text, const std::optional<bool> wrap = true);
+    size_t FillText(const til::point target, const wchar_t wch, const size_t count, const std::optional<bool> wrap = true);
+    size_t WriteAttributes(const til::point target, const std::span<const WORD> legacyAttrs);
+    size_t FillAttributes(const til::point target, const TextAttribute& attributes, const size_t count);
+    til::CoordType WriteCharInfos(const til::point target, const std::span<const CHAR_INFO> charInfos, const std::optional<bool> wrap = true);
+    til::CoordType ReadCharInfos(const til::point source, const std::span<CHAR_INFO> charInfos) const;
+
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
     OutputCellIterator Write(const OutputCellIterator givenIt,
@@ -169,6 +177,10 @@ public:
     const Cursor& GetCursor() const noexcept;
 
     uint64_t GetLastMutationId() const noexcept;
+
+    void EnableChangeJournal(size_t capacity);
+    TextBufferJournal::Position GetJournalPosition() const noexcept;
+    TextBufferJournal::Changes GetChangesSince(const TextBufferJournal::Position& position) const;
     const til::CoordType GetFirstRowIndex() const noexcept;
 
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
@@ -193,6 +205,7 @@ public:
     til::point BufferToScreenPosition(const til::point position) const;
 
     void Reset() noexcept;
+    void Recycle(const TextAttribute& attributes, const UINT cursorSize) noexcept;
 
     void ResizeTraditional(const til::size newSize);
 
@@ -295,7 +308,9 @@ private:
     // Assist with maintaining proper buffer state for Double Byte character sequences
     void _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
     void _ExpandTextRow(til::inclusive_rect& selectionRow) const;
-    DelimiterClass _GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const;
+    const DelimiterClassifier& _GetDelimiterClassifier(const std::wstring_view wordDelimiters) const;
+    bool _SkipDelimiterClassForward(til::point& pos, const til::point limit, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const;
+    bool _SkipDelimiterClassBackward(til::point& pos, const DelimiterClassSet classes, const DelimiterClassifier& classifier) const;
     til::point _GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const;
     til::point _GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
     til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
@@ -371,9 +386,14 @@ private:
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
     uint64_t _lastMutationId = 0;
+    // Only allocated if someone called EnableChangeJournal().
+    std::unique_ptr<TextBufferJournal> _journal;
 
     Cursor _cursor;
     std::vector<ScrollMark> _marks;
+    // Callers pass their wordDelimiters on every call. This caches the
+    // classifier for the most recently used string, see _GetDelimiterClassifier.
+    mutable DelimiterClassifier _delimiterClassifier;
     bool _isActiveBuffer = false;
 
 #ifdef UNIT_TESTING
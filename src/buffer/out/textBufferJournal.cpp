@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "textBufferJournal.hpp"
+
+TextBufferJournal::TextBufferJournal(const size_t capacity) :
+    _capacity{ std::max<size_t>(capacity, 1) }
+{
+    _entries.reserve(_capacity);
+}
+
+size_t TextBufferJournal::Capacity() const noexcept
+{
+    return _capacity;
+}
+
+int64_t TextBufferJournal::ScrollOffset() const noexcept
+{
+    return _scrollOffset;
+}
+
+// Records that the rows [top, bottom) were modified. If the rows overlap or touch an existing
+// entry, it gets extended instead, which is why this rarely uses more than a handful of entries.
+void TextBufferJournal::RecordRows(const uint64_t mutationId, const til::CoordType top, const til::CoordType bottom) noexcept
+{
+    const auto absoluteTop = _scrollOffset + top;
+    const auto absoluteBottom = _scrollOffset + bottom;
+    const auto extend = [&](Entry& e) noexcept {
+        if (absoluteTop > e.bottom || absoluteBottom < e.top)
+        {
+            return false;
+        }
+        e.mutationId = mutationId;
+        e.top = std::min(e.top, absoluteTop);
+        e.bottom = std::max(e.bottom, absoluteBottom);
+        return true;
+    };
+
+    if (_lastEntry < _entries.size() && extend(til::at(_entries, _lastEntry)))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        if (extend(til::at(_entries, i)))
+        {
+            _lastEntry = i;
+            return;
+        }
+    }
+
+    if (_entries.size() < _capacity)
+    {
+        _lastEntry = _entries.size();
+        // Can't throw, because we reserved _capacity entries in the constructor.
+        _entries.push_back({ mutationId, absoluteTop, absoluteBottom });
+        return;
+    }
+
+    // The journal is full. Evict the entry which was modified the longest time ago.
+    // Anyone who hasn't seen that change yet will have to invalidate everything.
+    const auto oldest = std::min_element(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b) noexcept {
+        return a.mutationId < b.mutationId;
+    });
+    _horizon = std::max(_horizon, oldest->mutationId);
+    *oldest = { mutationId, absoluteTop, absoluteBottom };
+    _lastEntry = gsl::narrow_cast<size_t>(oldest - _entries.begin());
+}
+
+// Records that the circular buffer was rotated by delta rows. Entries are stored in absolute
+// coordinates, so the only thing this needs to do is to update the scroll offset.
+void TextBufferJournal::RecordRotation(const til::CoordType delta) noexcept
+{
+    _scrollOffset += delta;
+}
+
+// Forgets all entries. Anyone asking for changes prior to mutationId will have to invalidate everything.
+// This is used for operations which change the buffer as a whole, like resets and resizes.
+void TextBufferJournal::Invalidate(const uint64_t mutationId) noexcept
+{
+    _entries.clear();
+    _lastEntry = 0;
+    _horizon = mutationId;
+    _scrollOffset = 0;
+}
+
+TextBufferJournal::Changes TextBufferJournal::ChangesSince(const Position& position, const Position& current, const til::CoordType height) const
+{
+    Changes changes;
+
+    // A position from before the horizon, or one that doesn't even belong to this buffer, can't be answered.
+    if (position.mutationId < _horizon || position.mutationId > current.mutationId || position.scrollOffset > current.scrollOffset)
+    {
+        changes.invalidateAll = true;
+        return changes;
+    }
+
+    const auto scrolled = current.scrollOffset - position.scrollOffset;
+    if (scrolled >= height)
+    {
+        changes.invalidateAll = true;
+        return changes;
+    }
+
+    auto& rows = changes.dirtyRows;
+    changes.scrolled = gsl::narrow_cast<til::CoordType>(scrolled);
+    if (scrolled > 0)
+    {
+        rows.emplace_back(gsl::narrow_cast<til::CoordType>(height - scrolled), height);
+    }
+
+    for (const auto& e : _entries)
+    {
+        if (e.mutationId <= position.mutationId)
+        {
+            continue;
+        }
+
+        // Convert from absolute coordinates and clip away rows that were scrolled out of the buffer.
+        const auto top = std::max<int64_t>(e.top - current.scrollOffset, 0);
+        const auto bottom = std::min<int64_t>(e.bottom - current.scrollOffset, height);
+        if (top < bottom)
+        {
+            rows.emplace_back(gsl::narrow_cast<til::CoordType>(top), gsl::narrow_cast<til::CoordType>(bottom));
+        }
+    }
+
+    // Sort and coalesce the ranges, so that consumers don't need to deal with overlaps.
+    if (!rows.empty())
+    {
+        std::sort(rows.begin(), rows.end());
+        auto out = rows.begin();
+        for (auto it = out + 1; it != rows.end(); ++it)
+        {
+            if (it->first <= out->second)
+            {
+                out->second = std::max(out->second, it->second);
+            }
+            else
+            {
+                *++out = *it;
+            }
+        }
+        rows.erase(out + 1, rows.end());
+    }
+
+    return changes;
+}
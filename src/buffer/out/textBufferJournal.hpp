@@ -0,0 +1,71 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- textBufferJournal.hpp
+
+Abstract:
+- A bounded record of which rows of a TextBuffer changed, for consumers which
+  maintain state derived from the buffer contents (pattern detection, search
+  results, accessibility, etc.) and want to update it incrementally instead of
+  rescanning the entire buffer.
+- Consumers remember a Position and later ask for the Changes since then.
+  If the journal can't answer that question, because the buffer was reset
+  or resized, or because it had to drop old entries, the consumer is asked
+  to invalidate everything instead.
+--*/
+
+#pragma once
+
+class TextBufferJournal
+{
+public:
+    // A point in the history of a TextBuffer. Obtain it from TextBuffer::GetJournalPosition().
+    struct Position
+    {
+        uint64_t mutationId = 0;
+        int64_t scrollOffset = 0;
+    };
+
+    struct Changes
+    {
+        // If true, all other members are meaningless and the consumer needs to rebuild its state from scratch.
+        bool invalidateAll = false;
+        // The number of rows the circular buffer was rotated by (a row at y is now at y - scrolled).
+        // Rows which were scrolled into view at the bottom are included in dirtyRows.
+        til::CoordType scrolled = 0;
+        // Sorted, non-overlapping [top, bottom) ranges of rows (relative to the current
+        // first row, like GetRowByOffset()) which were modified since the given Position.
+        std::vector<std::pair<til::CoordType, til::CoordType>> dirtyRows;
+    };
+
+    explicit TextBufferJournal(size_t capacity);
+
+    size_t Capacity() const noexcept;
+    int64_t ScrollOffset() const noexcept;
+
+    void RecordRows(uint64_t mutationId, til::CoordType top, til::CoordType bottom) noexcept;
+    void RecordRotation(til::CoordType delta) noexcept;
+    void Invalidate(uint64_t mutationId) noexcept;
+
+    Changes ChangesSince(const Position& position, const Position& current, til::CoordType height) const;
+
+private:
+    // The row coordinates are "absolute", meaning they include the _scrollOffset at the time they were recorded.
+    // This way, entries stay valid when the buffer rotates and neighboring changes can always be coalesced.
+    struct Entry
+    {
+        uint64_t mutationId = 0;
+        int64_t top = 0;
+        int64_t bottom = 0;
+    };
+
+    std::vector<Entry> _entries;
+    size_t _capacity = 0;
+    // The entry that was most recently recorded or extended. Writes tend to touch the same rows over and over.
+    size_t _lastEntry = 0;
+    // Positions with a mutationId below this one can't be answered anymore.
+    uint64_t _horizon = 0;
+    int64_t _scrollOffset = 0;
+};
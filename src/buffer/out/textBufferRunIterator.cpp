@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "textBufferRunIterator.hpp"
+
+#pragma hdrstop
+
+// Routine Description:
+// - Creates a new read-only iterator over the attribute runs of a ROW.
+// Arguments:
+// - row - The row to iterate over
+// - columnBegin - The first column to include
+// - columnEnd - The column 1 past the last one to include
+TextBufferRunIterator::TextBufferRunIterator(const ROW& row, til::CoordType columnBegin, til::CoordType columnEnd) noexcept :
+    _row{ &row },
+    _attrIter{ row.Attributes().runs().begin() },
+    _attrIterEnd{ _attrIter->length },
+    _columnEnd{ std::clamp<til::CoordType>(columnEnd, 0, row.size()) }
+{
+    // _generateRun() continues where the previous run ended.
+    _run.columnEnd = std::clamp<til::CoordType>(columnBegin, 0, _columnEnd);
+    _generateRun();
+}
+
+// Routine Description:
+// - Tells if the iterator is still valid (hasn't run past the end of the given column range)
+// Return Value:
+// - True if this iterator can still be dereferenced for data.
+TextBufferRunIterator::operator bool() const noexcept
+{
+    return !_exceeded;
+}
+
+// Routine Description:
+// - Advances the iterator to the next attribute run.
+// Return Value:
+// - Reference to self after movement.
+TextBufferRunIterator& TextBufferRunIterator::operator++() noexcept
+{
+    _generateRun();
+    return *this;
+}
+
+const TextRun& TextBufferRunIterator::operator*() const noexcept
+{
+    return _run;
+}
+
+const TextRun* TextBufferRunIterator::operator->() const noexcept
+{
+    return &_run;
+}
+
+const ROW& TextBufferRunIterator::Row() const noexcept
+{
+    return *_row;
+}
+
+void TextBufferRunIterator::_generateRun() noexcept
+{
+    const auto columnBegin = _run.columnEnd;
+    if (columnBegin >= _columnEnd)
+    {
+        _exceeded = true;
+        return;
+    }
+
+    // The attribute runs always cover the entire row, so this can't run past the end.
+    while (_attrIterEnd <= columnBegin)
+    {
+        ++_attrIter;
+        _attrIterEnd += _attrIter->length;
+    }
+
+    const auto columnEnd = std::min(_attrIterEnd, _columnEnd);
+    // If the last column is the leading half of a wide glyph, this will include its trailing half.
+    const auto textEnd = _row->NavigateToNext(columnEnd - 1);
+
+    _run.text = _row->GetText(columnBegin, textEnd);
+    _run.columnBegin = columnBegin;
+    _run.columnEnd = columnEnd;
+    _run.attr = _attrIter->value;
+    _run.leadingHalfClipped = _row->DbcsAttrAt(columnBegin) == DbcsAttribute::Trailing;
+    _run.trailingHalfClipped = textEnd != columnEnd;
+}
@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- textBufferRunIterator.hpp
+
+Abstract:
+- This module walks through a single ROW one attribute run at a time.
+- Unlike TextBufferCellIterator it doesn't produce a view per cell. Instead it
+  yields spans of columns which share the same TextAttribute, straight from the
+  ROW's text, its character offsets and the run-length encoded attributes.
+- It is currently intended for read-only operations
+--*/
+
+#pragma once
+
+#include "Row.hpp"
+
+// A span of columns within a ROW which all have the same TextAttribute.
+struct TextRun
+{
+    // The text of all glyphs that intersect [columnBegin, columnEnd).
+    // If a wide glyph straddles either edge, its text is included.
+    std::wstring_view text;
+    til::CoordType columnBegin = 0;
+    til::CoordType columnEnd = 0;
+    TextAttribute attr;
+    // True if columnBegin is the trailing half of a wide glyph.
+    bool leadingHalfClipped = false;
+    // True if columnEnd-1 is the leading half of a wide glyph, whose trailing half isn't part of this run.
+    bool trailingHalfClipped = false;
+};
+
+class TextBufferRunIterator
+{
+public:
+    TextBufferRunIterator(const ROW& row, til::CoordType columnBegin, til::CoordType columnEnd) noexcept;
+
+    explicit operator bool() const noexcept;
+
+    TextBufferRunIterator& operator++() noexcept;
+
+    const TextRun& operator*() const noexcept;
+    const TextRun* operator->() const noexcept;
+
+    const ROW& Row() const noexcept;
+
+private:
+    using AttrRunIterator = til::small_rle<TextAttribute, uint16_t, 1>::container::const_iterator;
+
+    void _generateRun() noexcept;
+
+    const ROW* _row;
+    AttrRunIterator _attrIter;
+    // The column 1 past the end of the attribute run _attrIter points to.
+    til::CoordType _attrIterEnd;
+    til::CoordType _columnEnd;
+    TextRun _run;
+    bool _exceeded = false;
+};
@@ -1245,6 +1245,22 @@ namespace winrt::TerminalApp::implementation
             connection.Initialize(valueSet);
         }
 
+        else if (connectionType == TerminalConnection::BenchmarkConnection::ConnectionType())
+        {
+            // The profile's commandline describes the workload, see BenchmarkConnection.h.
+            connection = TerminalConnection::BenchmarkConnection{};
+            connection.Initialize(TerminalConnection::BenchmarkConnection::CreateSettings(settings.Commandline(),
+                                                                                          settings.InitialRows(),
+                                                                                          settings.InitialCols()));
+        }
+
+        else if (connectionType == TerminalConnection::ReplayConnection::ConnectionType())
+        {
+            // The profile's commandline is the path to a recording, see ReplayConnection.h.
+            connection = TerminalConnection::ReplayConnection{};
+            connection.Initialize(TerminalConnection::ReplayConnection::CreateSettings(settings.Commandline()));
+        }
+
         else
         {
             const auto environment = settings.EnvironmentVariables() != nullptr ?
@@ -1286,6 +1302,12 @@ namespace winrt::TerminalApp::implementation
                 valueSet.Insert(L"inheritCursor", Windows::Foundation::PropertyValue::CreateBoolean(true));
             }
 
+            if (const auto recordingPath = profile.RecordingPath(); !recordingPath.empty())
+            {
+                const auto expanded = wil::ExpandEnvironmentStringsW<std::wstring>(recordingPath.c_str());
+                valueSet.Insert(L"recordingPath", Windows::Foundation::PropertyValue::CreateString(expanded));
+            }
+
             conhostConn.Initialize(valueSet);
 
             sessionGuid = conhostConn.Guid();
@@ -0,0 +1,405 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "BenchmarkConnection.h"
+
+#include "BenchmarkConnection.g.cpp"
+
+using namespace winrt::Windows::Foundation;
+using Workload = winrt::Microsoft::Terminal::TerminalConnection::implementation::BenchmarkConnection::Workload;
+
+// This GUID is used to identify the benchmark connection in a profile's "connectionType".
+// {f1e2d3c4-0b5a-4e69-8d7c-3b2a1f0e9d8c}
+static constexpr winrt::guid BenchmarkConnectionType = { 0xf1e2d3c4, 0x0b5a, 0x4e69, { 0x8d, 0x7c, 0x3b, 0x2a, 0x1f, 0x0e, 0x9d, 0x8c } };
+
+namespace
+{
+    // Returns the number of bytes the given text occupies in UTF-8,
+    // which is what a real connection would've had to read.
+    uint64_t utf8Length(const std::wstring_view& str) noexcept
+    {
+        uint64_t length = 0;
+        for (const auto ch : str)
+        {
+            // A surrogate pair is 4 bytes long in UTF-8, or 2 per surrogate.
+            length += ch < 0x80 ? 1 : ch < 0x800 || til::is_surrogate(ch) ? 2 : 3;
+        }
+        return length;
+    }
+
+    // Parses sizes like "64K" or "1G". Returns 0 on failure.
+    uint64_t parseSize(std::wstring_view str) noexcept
+    {
+        uint64_t multiplier = 1;
+        if (!str.empty())
+        {
+            switch (til::toupper_ascii(str.back()))
+            {
+            case L'K':
+                multiplier = 1024;
+                break;
+            case L'M':
+                multiplier = 1024 * 1024;
+                break;
+            case L'G':
+                multiplier = 1024 * 1024 * 1024;
+                break;
+            default:
+                break;
+            }
+            if (multiplier != 1)
+            {
+                str.remove_suffix(1);
+            }
+        }
+
+        const auto value = til::to_ulong(str, 10);
+        return value == til::to_ulong_error ? 0 : value * multiplier;
+    }
+
+    // Generates the output of the benchmark, one line (or row) at a time.
+    // The output is deterministic, so that runs are comparable.
+    class WorkloadGenerator
+    {
+    public:
+        explicit WorkloadGenerator(const Workload workload) noexcept :
+            _workload{ workload }
+        {
+        }
+
+        // Appends lines to the given string until it's at least `size` characters long.
+        void Generate(std::wstring& out, const size_t size, const til::CoordType columns, const til::CoordType rows)
+        {
+            const auto width = std::max(columns, 1);
+            const auto height = std::max(rows, 1);
+
+            while (out.size() < size)
+            {
+                switch (_workload)
+                {
+                case Workload::Ascii:
+                    _ascii(out, width);
+                    break;
+                case Workload::SgrRainbow:
+                    _sgrRainbow(out, width);
+                    break;
+                case Workload::TuiRedraw:
+                    _tuiRedraw(out, width, height);
+                    break;
+                case Workload::Cjk:
+                    _cjk(out, width);
+                    break;
+                case Workload::Hyperlinks:
+                    _hyperlinks(out, width);
+                    break;
+                }
+                _line++;
+            }
+        }
+
+    private:
+        wchar_t _printable(const til::CoordType column) const noexcept
+        {
+            return gsl::narrow_cast<wchar_t>(L'!' + (_line + column) % 94);
+        }
+
+        // Plain text that fills each line and then scrolls. This is what `cat`ing a log file looks like.
+        void _ascii(std::wstring& out, const til::CoordType width) const
+        {
+            for (til::CoordType x = 0; x < width; ++x)
+            {
+                out.push_back(_printable(x));
+            }
+            out.append(L"\r\n");
+        }
+
+        // Every character in a different color, which defeats any batching by attributes.
+        void _sgrRainbow(std::wstring& out, const til::CoordType width) const
+        {
+            for (til::CoordType x = 0; x < width; ++x)
+            {
+                fmt::format_to(std::back_inserter(out), FMT_COMPILE(L"\x1b[38;5;{}m{}"), (_line + x) % 256, _printable(x));
+            }
+            out.append(L"\x1b[m\r\n");
+        }
+
+        // Full-screen applications redraw rows at absolute positions and never scroll.
+        void _tuiRedraw(std::wstring& out, const til::CoordType width, const til::CoordType height) const
+        {
+            const auto y = _line % height;
+            const auto frame = _line / height;
+            fmt::format_to(std::back_inserter(out), FMT_COMPILE(L"\x1b[{};1H\x1b[3{};4{}m"), y + 1, frame % 8, (frame + y) % 8);
+            for (til::CoordType x = 0; x < width; ++x)
+            {
+                out.push_back(gsl::narrow_cast<wchar_t>(L'!' + (frame + x) % 94));
+            }
+            out.append(L"\x1b[m");
+        }
+
+        // Wide glyphs outside of ASCII, which take the slower paths in the parser and the buffer.
+        void _cjk(std::wstring& out, const til::CoordType width) const
+        {
+            for (til::CoordType x = 0; x < width / 2; ++x)
+            {
+                out.push_back(gsl::narrow_cast<wchar_t>(0x4E00 + (_line * 7 + x) % 0x5000));
+            }
+            out.append(L"\r\n");
+        }
+
+        // OSC 8 hyperlinks, each with its own URI.
+        void _hyperlinks(std::wstring& out, const til::CoordType width) const
+        {
+            til::CoordType x = 0;
+            for (uint64_t i = 0;; ++i)
+            {
+                const auto id = _line * 16 + i;
+                const auto text = fmt::format(FMT_COMPILE(L"link{} "), id);
+                x += gsl::narrow_cast<til::CoordType>(text.size());
+                if (x > width)
+                {
+                    break;
+                }
+                fmt::format_to(std::back_inserter(out), FMT_COMPILE(L"\x1b]8;;https://example.com/{}\x1b\\{}\x1b]8;;\x1b\\"), id, text);
+            }
+            out.append(L"\r\n");
+        }
+
+        Workload _workload;
+        uint64_t _line = 0;
+    };
+
+    struct LatencyPercentiles
+    {
+        std::chrono::microseconds p50;
+        std::chrono::microseconds p90;
+        std::chrono::microseconds p99;
+        std::chrono::microseconds max;
+    };
+
+    LatencyPercentiles computePercentiles(std::vector<std::chrono::microseconds>& latencies)
+    {
+        if (latencies.empty())
+        {
+            return {};
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        const auto at = [&](const size_t percentile) {
+            return latencies[std::min(latencies.size() - 1, latencies.size() * percentile / 100)];
+        };
+        return { at(50), at(90), at(99), latencies.back() };
+    }
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    winrt::guid BenchmarkConnection::ConnectionType() noexcept
+    {
+        return BenchmarkConnectionType;
+    }
+
+    Collections::ValueSet BenchmarkConnection::CreateSettings(const hstring& commandline, uint32_t rows, uint32_t columns)
+    {
+        Collections::ValueSet vs{};
+        vs.Insert(L"commandline", PropertyValue::CreateString(commandline));
+        vs.Insert(L"initialRows", PropertyValue::CreateUInt32(rows));
+        vs.Insert(L"initialCols", PropertyValue::CreateUInt32(columns));
+        return vs;
+    }
+
+    BenchmarkConnection::~BenchmarkConnection()
+    {
+        Close();
+    }
+
+    void BenchmarkConnection::Initialize(const Collections::ValueSet& settings)
+    {
+        if (settings)
+        {
+            const auto rows = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialRows").try_as<IPropertyValue>(), 0);
+            const auto columns = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialCols").try_as<IPropertyValue>(), 0);
+            if (rows && columns)
+            {
+                Resize(rows, columns);
+            }
+
+            const auto commandline = winrt::unbox_value_or<hstring>(settings.TryLookup(L"commandline").try_as<IPropertyValue>(), hstring{});
+            if (!_ParseCommandline(commandline))
+            {
+                _error = fmt::format(L"Invalid benchmark \"{}\".\r\nUsage: <ascii|sgr|tui|cjk|hyperlinks> [size=<bytes>] [rate=<bytes per second>] [chunk=<characters>]\r\n", std::wstring_view{ commandline });
+            }
+        }
+    }
+
+    // Method Description:
+    // - Parses the workload description (see BenchmarkConnection.h).
+    //   An empty commandline runs the default workload and so does an executable,
+    //   because that's what profiles inherit when they don't set a commandline
+    //   (%SystemRoot%\System32\cmd.exe). Anything else must name a workload.
+    // Return Value:
+    // - false if the commandline is invalid.
+    bool BenchmarkConnection::_ParseCommandline(std::wstring_view commandline)
+    {
+        static constexpr std::array<std::pair<std::wstring_view, Workload>, 5> workloads{ {
+            { L"ascii", Workload::Ascii },
+            { L"sgr", Workload::SgrRainbow },
+            { L"tui", Workload::TuiRedraw },
+            { L"cjk", Workload::Cjk },
+            { L"hyperlinks", Workload::Hyperlinks },
+        } };
+
+        auto first = true;
+        while (!commandline.empty())
+        {
+            const auto token = til::prefix_split(commandline, L" ");
+            if (token.empty())
+            {
+                continue;
+            }
+
+            if (std::exchange(first, false))
+            {
+                const auto it = std::find_if(workloads.begin(), workloads.end(), [&](const auto& w) { return til::equals_insensitive_ascii(w.first, token); });
+                if (it == workloads.end())
+                {
+                    return token.find_first_of(L"\\/%") != std::wstring_view::npos || til::ends_with_insensitive_ascii(token, std::wstring_view{ L".exe" });
+                }
+                _workload = it->second;
+                _workloadName = it->first;
+                continue;
+            }
+
+            auto value = token;
+            const auto key = til::prefix_split(value, L"=");
+            const auto number = parseSize(value);
+            if (key == L"size" && number)
+            {
+                _totalBytes = number;
+            }
+            else if (key == L"rate" && number)
+            {
+                _bytesPerSecond = number;
+            }
+            else if (key == L"chunk" && number)
+            {
+                _chunkSize = gsl::narrow_cast<size_t>(number);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void BenchmarkConnection::Start()
+    {
+        _transitionToState(ConnectionState::Connecting);
+
+        if (!_error.empty())
+        {
+            _TerminalOutputHandlers(_error);
+            _transitionToState(ConnectionState::Failed);
+            return;
+        }
+
+        _outputThread = std::thread{ [this]() {
+            try
+            {
+                _OutputThread();
+            }
+            CATCH_LOG();
+        } };
+
+        _transitionToState(ConnectionState::Connected);
+    }
+
+    // The generated output doesn't depend on any input.
+    void BenchmarkConnection::WriteInput(const hstring& /*data*/) noexcept
+    {
+    }
+
+    void BenchmarkConnection::Resize(uint32_t rows, uint32_t columns) noexcept
+    {
+        _rows.store(gsl::narrow_cast<til::CoordType>(rows), std::memory_order_relaxed);
+        _columns.store(gsl::narrow_cast<til::CoordType>(columns), std::memory_order_relaxed);
+    }
+
+    // Method Description:
+    // - Generates the workload in chunks of _chunkSize characters and hands them to TerminalOutput,
+    //   either as fast as they're consumed, or paced to _bytesPerSecond.
+    // - Since TerminalOutput processes the output synchronously, the time each call takes is
+    //   the latency from receiving a chunk to it being in the buffer. Once _totalBytes were
+    //   written, the throughput and the latency percentiles are printed and traced.
+    // - The connection stays connected afterwards, so that the results remain visible.
+    void BenchmarkConnection::_OutputThread()
+    {
+        using clock = std::chrono::steady_clock;
+
+        WorkloadGenerator generator{ _workload };
+        std::vector<std::chrono::microseconds> latencies;
+        std::wstring chunk;
+        uint64_t bytes = 0;
+        const auto start = clock::now();
+
+        while (bytes < _totalBytes && !_isClosing())
+        {
+            chunk.clear();
+            generator.Generate(chunk, _chunkSize, _columns.load(std::memory_order_relaxed), _rows.load(std::memory_order_relaxed));
+
+            if (_bytesPerSecond)
+            {
+                // Don't get ahead of the target rate.
+                const std::chrono::duration<double> due{ static_cast<double>(bytes) / static_cast<double>(_bytesPerSecond) };
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<clock::duration>(due));
+            }
+
+            const auto beg = clock::now();
+            _TerminalOutputHandlers(winrt::hstring{ chunk });
+            latencies.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - beg));
+
+            bytes += utf8Length(chunk);
+        }
+
+        if (_isClosing())
+        {
+            return;
+        }
+
+        const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        const auto bytesPerSecond = static_cast<uint64_t>(static_cast<double>(bytes) / std::max(elapsed, 1e-9));
+        const auto percentiles = computePercentiles(latencies);
+
+        _TerminalOutputHandlers(fmt::format(
+            FMT_COMPILE(L"\x1b[m\r\n\r\nBenchmark \"{}\": {:.1f} MiB in {:.3f} s, {:.1f} MiB/s\r\n"
+                        L"Latency per chunk of {} characters: p50 {} us, p90 {} us, p99 {} us, max {} us\r\n"),
+            _workloadName,
+            static_cast<double>(bytes) / (1024.0 * 1024.0),
+            elapsed,
+            static_cast<double>(bytesPerSecond) / (1024.0 * 1024.0),
+            _chunkSize,
+            percentiles.p50.count(),
+            percentiles.p90.count(),
+            percentiles.p99.count(),
+            percentiles.max.count()));
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(
+            g_hTerminalConnectionProvider,
+            "BenchmarkConnectionResults",
+            TraceLoggingDescription("Event emitted when a benchmark connection finished its workload"),
+            TraceLoggingWideString(_workloadName.c_str(), "Workload"),
+            TraceLoggingUInt64(bytes, "Bytes"),
+            TraceLoggingUInt64(bytesPerSecond, "BytesPerSecond"),
+            TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(percentiles.p50.count()), "LatencyP50Us"),
+            TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(percentiles.p90.count()), "LatencyP90Us"),
+            TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(percentiles.p99.count()), "LatencyP99Us"),
+            TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(percentiles.max.count()), "LatencyMaxUs"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        // We stay connected like EchoConnection does, until the user closes the tab.
+        // Transitioning to Closed would make the pane close itself (closeOnExit) before the results could be read.
+    }
+}
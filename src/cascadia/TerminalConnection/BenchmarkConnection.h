@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "BenchmarkConnection.g.h"
+
+#include "OutputThreadConnection.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // A connection that doesn't need a child process. It generates synthetic VT output
+    // in-process and pushes it through TerminalOutput as fast as it's consumed (or at a
+    // given rate), so that the throughput of everything past the connection can be measured.
+    // Once done, it prints the achieved throughput and the latency percentiles
+    // of the TerminalOutput calls, which is how long it took to process each chunk,
+    // and stays open until it's closed by the user.
+    //
+    // The workload is described by the "commandline" setting:
+    //   <workload> [size=<bytes>] [rate=<bytes per second>] [chunk=<characters>]
+    // where <workload> is one of ascii, sgr, tui, cjk or hyperlinks,
+    // and sizes may be suffixed with K, M or G. Profiles without a commandline of their
+    // own inherit cmd.exe, which (like any executable) runs the default ascii workload.
+    struct BenchmarkConnection : BenchmarkConnectionT<BenchmarkConnection>, OutputThreadConnection<BenchmarkConnection>
+    {
+        enum class Workload
+        {
+            Ascii,
+            SgrRainbow,
+            TuiRedraw,
+            Cjk,
+            Hyperlinks,
+        };
+
+        static winrt::guid ConnectionType() noexcept;
+        static Windows::Foundation::Collections::ValueSet CreateSettings(const hstring& commandline, uint32_t rows, uint32_t columns);
+
+        BenchmarkConnection() = default;
+        ~BenchmarkConnection();
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        void Start();
+        void WriteInput(const hstring& data) noexcept;
+        void Resize(uint32_t rows, uint32_t columns) noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+
+    private:
+        bool _ParseCommandline(std::wstring_view commandline);
+        void _OutputThread();
+
+        Workload _workload{ Workload::Ascii };
+        std::wstring _workloadName{ L"ascii" };
+        uint64_t _totalBytes{ 256 * 1024 * 1024 };
+        // 0 means as fast as possible.
+        uint64_t _bytesPerSecond{ 0 };
+        size_t _chunkSize{ 16 * 1024 };
+        std::wstring _error;
+
+        std::atomic<til::CoordType> _rows{ 30 };
+        std::atomic<til::CoordType> _columns{ 120 };
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(BenchmarkConnection);
+}
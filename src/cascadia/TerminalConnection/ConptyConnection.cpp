@@ -289,6 +289,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _passthroughMode = unbox_prop_or<bool>(settings, L"passthroughMode", _passthroughMode);
             }
             _inheritCursor = unbox_prop_or<bool>(settings, L"inheritCursor", _inheritCursor);
+            _recordingPath = unbox_prop_or<winrt::hstring>(settings, L"recordingPath", _recordingPath);
             _profileGuid = unbox_prop_or<winrt::guid>(settings, L"profileGuid", _profileGuid);
 
             const auto& initialEnvironment{ unbox_prop_or<winrt::hstring>(settings, L"initialEnvironment", L"") };
@@ -414,6 +415,16 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         _startTime = std::chrono::high_resolution_clock::now();
 
+        if (!_recordingPath.empty())
+        {
+            try
+            {
+                _recording = std::make_unique<::Microsoft::Terminal::Recording::RecordingWriter>(std::wstring{ _recordingPath });
+                _recording->WriteResize(_rows, _cols);
+            }
+            CATCH_LOG();
+        }
+
         // Create our own output handling thread
         // This must be done after the pipes are populated.
         // Each connection needs to make sure to drain the output from its backing host.
@@ -510,6 +521,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // TODO GH#3378 reconcile and unify UTF-8 converters
         auto str = winrt::to_string(data);
         LOG_IF_WIN32_BOOL_FALSE(WriteFile(_inPipe.get(), str.c_str(), (DWORD)str.length(), nullptr, nullptr));
+        _Record(::Microsoft::Terminal::Recording::RecordType::Input, str);
     }
 
     void ConptyConnection::Resize(uint32_t rows, uint32_t columns)
@@ -521,6 +533,15 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         if (_isConnected())
         {
             THROW_IF_FAILED(ConptyResizePseudoConsole(_hPC.get(), { Utils::ClampToShortMax(columns, 1), Utils::ClampToShortMax(rows, 1) }));
+
+            if (_recording && !_recordingFailed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    _recording->WriteResize(rows, columns);
+                }
+                CATCH_LOG();
+            }
         }
     }
 
@@ -641,43 +662,208 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         return commandline.to_hstring();
     }
 
+    // The output of ConPTY is read and parsed on two separate threads. This thread (the "reader") keeps
+    // the pipe drained and hands the data over to the "parser" thread (see _ParserThread) through a channel.
+    // This way ConPTY doesn't back up while the terminal is busy parsing and rendering the previous output.
+    // The buffers are passed back to us through a second channel once the parser is done with them.
+    //
+    // While one chunk is being converted and parsed, the next read is already pending on this thread.
+    // The size of the reads adapts to the amount of output: It doubles each time a read fills the chunk
+    // entirely, up to outputChunkMaxSize, and falls back to outputChunkMinSize once a read had to wait
+    // for outputIdleThreshold. The chunks are reallocated lazily to match, which is also how an idle
+    // connection gives back the memory it needed during a flood of output.
     DWORD ConptyConnection::_OutputThread()
     {
         // Keep us alive until the output thread terminates; the destructor
         // won't wait for us, and the known exit points _do_.
         auto strongThis{ get_strong() };
 
-        // process the data of the output pipe in a loop
-        while (true)
+        auto [filledTx, filledRx] = til::spsc::channel<OutputChunk>(outputChunkCount);
+        auto [emptyTx, emptyRx] = til::spsc::channel<OutputChunk>(outputChunkCount);
+
+        for (uint32_t i = 0; i < outputChunkCount; ++i)
         {
-            DWORD read{};
+            emptyTx.emplace(OutputChunk{ std::make_unique<char[]>(outputChunkMinSize), outputChunkMinSize });
+        }
 
-            const auto readFail{ !ReadFile(_outPipe.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &read, nullptr) };
+        const auto threadStart = std::chrono::steady_clock::now();
+        auto readSize = outputChunkMinSize;
 
-            // When we call CancelSynchronousIo() in Close() this is the branch that's taken and gets us out of here.
-            if (_isStateAtOrBeyond(ConnectionState::Closing))
+        DWORD parserResult = 0;
+        std::thread parser{ [&, rx = std::move(filledRx), tx = std::move(emptyTx)]() noexcept {
+            LOG_IF_FAILED(SetThreadDescription(GetCurrentThread(), L"ConptyConnection Parser Thread"));
+            parserResult = _ParserThread(rx, tx);
+        } };
+
+        {
+            // Dropping the producer at the end of this scope tells the parser that no more data is coming.
+            const auto tx = std::move(filledTx);
+
+            // process the data of the output pipe in a loop
+            while (!_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                // If all chunks are waiting to be parsed, we'll block until one is returned.
+                if (_outputStats.queueDepth.load(std::memory_order_relaxed) >= outputChunkCount)
+                {
+                    _outputStats.stalls++;
+                }
+
+                auto chunk = emptyRx.pop();
+                if (!chunk)
+                {
+                    break;
+                }
+
+                if (chunk->capacity != readSize)
+                {
+                    chunk->data = std::make_unique<char[]>(readSize);
+                    chunk->capacity = readSize;
+                }
+
+                const auto readStart = std::chrono::steady_clock::now();
+                const auto readFail{ !ReadFile(_outPipe.get(), chunk->data.get(), readSize, &chunk->size, nullptr) };
+                const auto readEnd = std::chrono::steady_clock::now();
+
+                // When we call CancelSynchronousIo() in Close() this is the branch that's taken and gets us out of here.
+                if (_isStateAtOrBeyond(ConnectionState::Closing))
+                {
+                    break;
+                }
+
+                // Reading failed (we must check this first, because read will also be 0.)
+                // The parser will handle the error once it's done with the data that came before it.
+                if (readFail)
+                {
+                    chunk->error = GetLastError();
+                    chunk->size = 0;
+                }
+
+                _outputStats.reads++;
+                _outputStats.bytes += chunk->size;
+                _outputStats.maxReadSize = std::max(_outputStats.maxReadSize, chunk->size);
+
+                if (chunk->size == readSize)
+                {
+                    readSize = std::min(readSize * 2, outputChunkMaxSize);
+                }
+                else if (readEnd - readStart >= outputIdleThreshold)
+                {
+                    readSize = outputChunkMinSize;
+                }
+
+                const auto depth = _outputStats.queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+                _outputStats.maxQueueDepth = std::max(_outputStats.maxQueueDepth, depth);
+
+                const auto last = readFail || chunk->size == 0;
+                if (!tx.emplace(std::move(*chunk)) || last)
+                {
+                    break;
+                }
+            }
+        }
+
+        parser.join();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - threadStart;
+        const auto reads = static_cast<double>(_outputStats.reads);
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hTerminalConnectionProvider,
+                          "OutputPipelineStatistics",
+                          TraceLoggingDescription("An event emitted when the output threads exit, for tuning the output pipeline"),
+                          TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
+                          TraceLoggingUInt64(_outputStats.reads, "Reads", "The number of ReadFile calls"),
+                          TraceLoggingUInt64(_outputStats.bytes, "Bytes", "The number of bytes read"),
+                          TraceLoggingFloat64(reads > 0 ? static_cast<double>(_outputStats.bytes) / reads : 0, "BytesPerRead", "The average size of a read"),
+                          TraceLoggingFloat64(elapsed.count() > 0 ? reads / elapsed.count() : 0, "ReadsPerSecond", "The average number of reads per second"),
+                          TraceLoggingUInt32(_outputStats.maxReadSize, "MaxReadSize", "The largest amount of data returned by a single read"),
+                          TraceLoggingUInt64(_outputStats.batches, "Batches", "The number of times the parser was invoked"),
+                          TraceLoggingUInt64(_outputStats.stalls, "Stalls", "How often the reader waited for the parser"),
+                          TraceLoggingUInt32(_outputStats.maxQueueDepth, "MaxQueueDepth", "The maximum number of chunks waiting to be parsed"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        return parserResult;
+    }
+
+    // Appends a record to the recording, if any, and stops recording after the first failure (e.g. a full disk).
+    void ConptyConnection::_Record(const ::Microsoft::Terminal::Recording::RecordType type, const std::string_view payload) noexcept
+    {
+        if (!_recording || _recordingFailed.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        try
+        {
+            _recording->Write(type, payload);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            _recordingFailed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Converts and forwards the chunks read by _OutputThread to our event handlers.
+    // All chunks that are available at once are passed on in a single batch,
+    // so that the terminal only needs to acquire its lock once for all of them.
+    DWORD ConptyConnection::_ParserThread(const til::spsc::consumer<OutputChunk>& filled, const til::spsc::producer<OutputChunk>& empty)
+    {
+        std::array<OutputChunk, outputChunkCount> batch;
+
+        while (true)
+        {
+            const auto [count, alive] = filled.pop_n(til::spsc::block_initially, batch.begin(), batch.size());
+            if (count == 0)
             {
+                // The reader exited without telling us about an error (for instance, because we're closing).
                 return 0;
             }
 
-            if (readFail) // reading failed (we must check this first, because read will also be 0.)
+            _outputStats.queueDepth.fetch_sub(gsl::narrow_cast<uint32_t>(count), std::memory_order_relaxed);
+            _outputStats.batches++;
+
+            // The reader stops after a failed or empty read, so only the last chunk can be one.
+            const auto& last = til::at(batch, count - 1);
+            const auto error = last.error;
+            const auto eof = error == ERROR_SUCCESS && last.size == 0;
+            // The reader only returns to the minimum read size after it waited for output. See _OutputThread.
+            const auto idle = count == 1 && last.capacity == outputChunkMinSize;
+
+            std::string_view bytes;
+            if (count == 1)
             {
-                // EXIT POINT
-                const auto lastError = GetLastError();
-                if (lastError == ERROR_BROKEN_PIPE)
-                {
-                    _LastConPtyClientDisconnected();
-                    return S_OK;
-                }
-                else
+                bytes = { last.data.get(), last.size };
+            }
+            else
+            {
+                _u8Batch.clear();
+                for (size_t i = 0; i < count; ++i)
                 {
-                    _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
-                    _transitionToState(ConnectionState::Failed);
-                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
+                    const auto& chunk = til::at(batch, i);
+                    _u8Batch.append(chunk.data.get(), chunk.size);
                 }
+                bytes = _u8Batch;
+            }
+
+            _Record(::Microsoft::Terminal::Recording::RecordType::Output, bytes);
+
+            const auto result{ til::u8u16(bytes, _u16Str, _u8State) };
+
+            // The data has been copied into _u16Str, so the reader can have the buffers back.
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto& chunk = til::at(batch, i);
+                chunk.size = 0;
+                chunk.error = ERROR_SUCCESS;
+                empty.emplace(std::move(chunk));
+            }
+
+            if (_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                return 0;
             }
 
-            const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
             if (FAILED(result))
             {
                 // EXIT POINT
@@ -686,32 +872,63 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 return gsl::narrow_cast<DWORD>(result);
             }
 
-            if (_u16Str.empty())
+            if (!_u16Str.empty())
             {
-                return 0;
+                if (!_receivedFirstByte)
+                {
+                    const auto now = std::chrono::high_resolution_clock::now();
+                    const std::chrono::duration<double> delta = now - _startTime;
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                    TraceLoggingWrite(g_hTerminalConnectionProvider,
+                                      "ReceivedFirstByte",
+                                      TraceLoggingDescription("An event emitted when the connection receives the first byte"),
+                                      TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
+                                      TraceLoggingFloat64(delta.count(), "Duration"),
+                                      TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                                      TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+                    _receivedFirstByte = true;
+                }
+
+                // Pass the output to our registered event handlers
+                _TerminalOutputHandlers(_u16Str);
             }
 
-            if (!_receivedFirstByte)
+            // During a flood of output the batch buffers grow to hold up to outputChunkCount chunks
+            // of outputChunkMaxSize bytes. Once the output calmed down, give that memory back.
+            if (idle)
             {
-                const auto now = std::chrono::high_resolution_clock::now();
-                const std::chrono::duration<double> delta = now - _startTime;
+                if (_u8Batch.capacity() > 2 * outputChunkMinSize)
+                {
+                    std::string{}.swap(_u8Batch);
+                }
+                if (_u16Str.capacity() > 2 * outputChunkMinSize)
+                {
+                    std::wstring{}.swap(_u16Str);
+                }
+            }
 
-#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
-                TraceLoggingWrite(g_hTerminalConnectionProvider,
-                                  "ReceivedFirstByte",
-                                  TraceLoggingDescription("An event emitted when the connection receives the first byte"),
-                                  TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
-                                  TraceLoggingFloat64(delta.count(), "Duration"),
-                                  TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
-                                  TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
-                _receivedFirstByte = true;
+            if (error != ERROR_SUCCESS)
+            {
+                // EXIT POINT
+                if (error == ERROR_BROKEN_PIPE)
+                {
+                    _LastConPtyClientDisconnected();
+                    return S_OK;
+                }
+                else
+                {
+                    _indicateExitWithStatus(HRESULT_FROM_WIN32(error)); // print a message
+                    _transitionToState(ConnectionState::Failed);
+                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(error));
+                }
             }
 
-            // Pass the output to our registered event handlers
-            _TerminalOutputHandlers(_u16Str);
+            if (eof)
+            {
+                return 0;
+            }
         }
-
-        return 0;
     }
 
     static winrt::event<NewConnectionHandler> _newConnectionHandlers;
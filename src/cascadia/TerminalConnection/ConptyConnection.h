@@ -7,7 +7,9 @@
 #include "ConnectionStateHolder.h"
 
 #include "ITerminalHandoff.h"
+#include "../inc/ConnectionRecording.h"
 #include <til/env.h>
+#include <til/spsc.h>
 
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
@@ -89,12 +91,45 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_process_information _piClient;
         wil::unique_any<HPCON, decltype(closePseudoConsoleAsync), closePseudoConsoleAsync> _hPC;
 
+        // A buffer that's passed from the reader to the parser thread and back. See _OutputThread.
+        struct OutputChunk
+        {
+            std::unique_ptr<char[]> data;
+            DWORD capacity = 0;
+            DWORD size = 0;
+            DWORD error = ERROR_SUCCESS;
+        };
+        static constexpr uint32_t outputChunkCount = 16;
+        // The size of each read adapts to the amount of output. See _OutputThread.
+        static constexpr DWORD outputChunkMinSize = 4 * 1024;
+        static constexpr DWORD outputChunkMaxSize = 128 * 1024;
+        // If a read blocked for at least this long, the connection is considered to be idle.
+        static constexpr std::chrono::milliseconds outputIdleThreshold{ 100 };
+
+        // Counters for tuning the output pipeline. They're logged when the output thread exits.
+        struct OutputStatistics
+        {
+            // The number of chunks that were read, but not parsed yet.
+            std::atomic<uint32_t> queueDepth{ 0 };
+            uint32_t maxQueueDepth = 0;
+            uint64_t reads = 0;
+            uint64_t bytes = 0;
+            DWORD maxReadSize = 0;
+            uint64_t batches = 0;
+            uint64_t stalls = 0;
+        } _outputStats;
+
         til::u8state _u8State{};
+        std::string _u8Batch{};
         std::wstring _u16Str{};
-        std::array<char, 4096> _buffer{};
         bool _passthroughMode{};
         bool _inheritCursor{ false };
 
+        // If set, all output, input and resizes are recorded to this file. See ConnectionRecording.h.
+        winrt::hstring _recordingPath{};
+        std::unique_ptr<::Microsoft::Terminal::Recording::RecordingWriter> _recording;
+        std::atomic<bool> _recordingFailed{ false };
+
         til::env _initialEnv{};
         guid _profileGuid{};
 
@@ -108,6 +143,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         } _startupInfo{};
 
         DWORD _OutputThread();
+        void _Record(::Microsoft::Terminal::Recording::RecordType type, std::string_view payload) noexcept;
+        DWORD _ParserThread(const til::spsc::consumer<OutputChunk>& filled, const til::spsc::producer<OutputChunk>& empty);
     };
 }
 
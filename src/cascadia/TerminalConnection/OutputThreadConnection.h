@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "ConnectionStateHolder.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // The common parts of connections that produce their output on a thread of their own,
+    // instead of reading it from another process, like BenchmarkConnection and ReplayConnection.
+    // The output thread should check _closing regularly and return once it's set.
+    template<typename T>
+    struct OutputThreadConnection : ConnectionStateHolder<T>
+    {
+    public:
+        void Close() noexcept
+        {
+            this->_transitionToState(ConnectionState::Closing);
+            _closing.store(true, std::memory_order_relaxed);
+
+            // Waiting for the output thread to exit ensures that all pending _TerminalOutputHandlers()
+            // calls have returned and won't notify our caller (ControlCore) anymore (GH#13880).
+            if (_outputThread.joinable() && _outputThread.get_id() != std::this_thread::get_id())
+            {
+                _outputThread.join();
+            }
+
+            this->_transitionToState(ConnectionState::Closed);
+        }
+
+    protected:
+        bool _isClosing() const noexcept
+        {
+            return _closing.load(std::memory_order_relaxed);
+        }
+
+        std::atomic<bool> _closing{ false };
+        std::thread _outputThread;
+    };
+}
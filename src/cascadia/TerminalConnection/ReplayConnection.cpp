@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "ReplayConnection.h"
+
+#include "../inc/ConnectionRecording.h"
+
+#include "ReplayConnection.g.cpp"
+
+using namespace ::Microsoft::Terminal::Recording;
+using namespace winrt::Windows::Foundation;
+
+// This GUID is used to identify the replay connection in a profile's "connectionType".
+// {5c2d8e41-7a93-4b06-a1f5-e8c3d4b2960f}
+static constexpr winrt::guid ReplayConnectionType = { 0x5c2d8e41, 0x7a93, 0x4b06, { 0xa1, 0xf5, 0xe8, 0xc3, 0xd4, 0xb2, 0x96, 0x0f } };
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    winrt::guid ReplayConnection::ConnectionType() noexcept
+    {
+        return ReplayConnectionType;
+    }
+
+    Collections::ValueSet ReplayConnection::CreateSettings(const hstring& commandline)
+    {
+        Collections::ValueSet vs{};
+        vs.Insert(L"commandline", PropertyValue::CreateString(commandline));
+        return vs;
+    }
+
+    ReplayConnection::~ReplayConnection()
+    {
+        Close();
+    }
+
+    void ReplayConnection::Initialize(const Collections::ValueSet& settings)
+    {
+        if (settings)
+        {
+            const auto commandline = winrt::unbox_value_or<hstring>(settings.TryLookup(L"commandline").try_as<IPropertyValue>(), hstring{});
+            std::wstring_view path{ commandline };
+
+            static constexpr std::wstring_view fastSuffix{ L" fast" };
+            if (til::ends_with(path, fastSuffix))
+            {
+                _fast = true;
+                path.remove_suffix(fastSuffix.size());
+            }
+
+            // Allow for quoted paths, since they may contain whitespace.
+            if (path.size() >= 2 && path.front() == L'"' && path.back() == L'"')
+            {
+                path = path.substr(1, path.size() - 2);
+            }
+
+            _path = wil::ExpandEnvironmentStringsW<std::wstring>(std::wstring{ path }.c_str());
+        }
+    }
+
+    void ReplayConnection::Start()
+    {
+        _transitionToState(ConnectionState::Connecting);
+
+        _outputThread = std::thread{ [this]() {
+            try
+            {
+                _OutputThread();
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                if (!_isClosing())
+                {
+                    _TerminalOutputHandlers(fmt::format(FMT_COMPILE(L"\r\nFailed to replay \"{}\" (0x{:08x})\r\n"), _path, static_cast<uint32_t>(wil::ResultFromCaughtException())));
+                    _transitionToState(ConnectionState::Failed);
+                }
+            }
+        } };
+    }
+
+    // Recordings are replayed without regard for input.
+    void ReplayConnection::WriteInput(const hstring& /*data*/) noexcept
+    {
+    }
+
+    void ReplayConnection::Resize(uint32_t /*rows*/, uint32_t /*columns*/) noexcept
+    {
+    }
+
+    void ReplayConnection::_OutputThread()
+    {
+        using clock = std::chrono::steady_clock;
+
+        const auto data = RecordingReader::LoadFile(_path);
+        RecordingReader reader{ data };
+
+        _transitionToState(ConnectionState::Connected);
+
+        til::u8state u8State;
+        std::wstring u16Str;
+        uint64_t bytes = 0;
+        uint64_t chunks = 0;
+        clock::duration outputTime{};
+        clock::duration maxOutputTime{};
+        const auto start = clock::now();
+
+        while (const auto record = reader.Next())
+        {
+            if (_isClosing())
+            {
+                return;
+            }
+
+            if (record->type != RecordType::Output)
+            {
+                continue;
+            }
+
+            if (!_fast)
+            {
+                std::this_thread::sleep_until(start + record->timestamp);
+            }
+
+            THROW_IF_FAILED(til::u8u16(record->payload, u16Str, u8State));
+            if (u16Str.empty())
+            {
+                continue;
+            }
+
+            const auto beg = clock::now();
+            _TerminalOutputHandlers(u16Str);
+            const auto duration = clock::now() - beg;
+
+            outputTime += duration;
+            maxOutputTime = std::max(maxOutputTime, duration);
+            bytes += record->payload.size();
+            chunks++;
+        }
+
+        const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        const auto output = std::chrono::duration<double>(outputTime).count();
+        const auto maxOutput = std::chrono::duration<double, std::milli>(maxOutputTime).count();
+
+        _TerminalOutputHandlers(fmt::format(
+            FMT_COMPILE(L"\x1b[m\r\n\r\nReplayed {} bytes in {} chunks in {:.3f} s.\r\n"
+                        L"Processing the output took {:.3f} s, at most {:.3f} ms per chunk.\r\n"),
+            bytes,
+            chunks,
+            elapsed,
+            output,
+            maxOutput));
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(
+            g_hTerminalConnectionProvider,
+            "ReplayConnectionResults",
+            TraceLoggingDescription("Event emitted when a replay connection finished playing back a recording"),
+            TraceLoggingBool(_fast, "Fast"),
+            TraceLoggingUInt64(bytes, "Bytes"),
+            TraceLoggingUInt64(chunks, "Chunks"),
+            TraceLoggingFloat64(elapsed, "ElapsedSeconds"),
+            TraceLoggingFloat64(output, "OutputSeconds"),
+            TraceLoggingFloat64(maxOutput, "MaxOutputMilliseconds"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        // Like BenchmarkConnection, we stay connected so that the pane doesn't close itself before the results could be read.
+    }
+}
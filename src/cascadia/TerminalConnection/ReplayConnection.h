@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "ReplayConnection.g.h"
+
+#include "OutputThreadConnection.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // Plays back the output of a session that was recorded by a ConptyConnection
+    // (see ConnectionRecording.h), either with its original timing or as fast as possible.
+    // Input and resizes in the recording are skipped. Once done, it prints how long
+    // the TerminalOutput calls took, which is how long it took to process the output,
+    // and stays open until it's closed by the user.
+    //
+    // The recording is given by the "commandline" setting:
+    //   <path> [fast]
+    struct ReplayConnection : ReplayConnectionT<ReplayConnection>, OutputThreadConnection<ReplayConnection>
+    {
+        static winrt::guid ConnectionType() noexcept;
+        static Windows::Foundation::Collections::ValueSet CreateSettings(const hstring& commandline);
+
+        ReplayConnection() = default;
+        ~ReplayConnection();
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        void Start();
+        void WriteInput(const hstring& data) noexcept;
+        void Resize(uint32_t rows, uint32_t columns) noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+
+    private:
+        void _OutputThread();
+
+        std::wstring _path;
+        bool _fast{ false };
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(ReplayConnection);
+}
@@ -39,6 +39,9 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// How often we check whether a flood of output ended, while the terminal is fast-forwarding.
+constexpr const auto EndFastForwardInterval = ::Microsoft::Terminal::Core::Terminal::FastForwardIdleTime;
+
 // The delay before performing the search after change of search criteria
 constexpr const auto SearchAfterChangeDelay = std::chrono::milliseconds(200);
 
@@ -180,6 +183,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         //   need to hop across the process boundary every time text is output.
         //   We can throttle this to once every 8ms, which will get us out of
         //   the way of the main output & rendering threads.
+        // * _endFastForward: While the terminal is fast-forwarding through a
+        //   flood of output, we periodically check whether it's over yet.
         const auto shared = _shared.lock();
         shared->tsfTryRedrawCanvas = std::make_shared<ThrottledFuncTrailing<>>(
             _dispatcher,
@@ -212,6 +217,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                     core->_ScrollPositionChangedHandlers(*core, update);
                 }
             });
+
+        shared->endFastForward = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            EndFastForwardInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_endFastForwardIfIdle();
+                }
+            });
     }
 
     ControlCore::~ControlCore()
@@ -237,6 +252,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         shared->tsfTryRedrawCanvas.reset();
         shared->updatePatternLocations.reset();
         shared->updateScrollBar.reset();
+        shared->endFastForward.reset();
     }
 
     void ControlCore::AttachToNewControl(const Microsoft::Terminal::Control::IKeyBindings& keyBindings)
@@ -1938,15 +1954,22 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         try
         {
-            {
-                const auto lock = _terminal->LockForWriting();
-                _terminal->Write(hstr);
-            }
+            // Connections can hand us megabytes at once. Parsing them in slices
+            // ensures that we don't block rendering and input for too long.
+            const auto fastForwarding = _terminal->WriteSliced(hstr);
 
-            // Start the throttled update of where our hyperlinks are.
             const auto shared = _shared.lock_shared();
-            if (shared->updatePatternLocations)
+            if (fastForwarding)
+            {
+                // Hyperlink detection is paused until the flood of output is over.
+                if (shared->endFastForward)
+                {
+                    shared->endFastForward->Run();
+                }
+            }
+            else if (shared->updatePatternLocations)
             {
+                // Start the throttled update of where our hyperlinks are.
                 (*shared->updatePatternLocations)();
             }
         }
@@ -1957,6 +1980,32 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Leaves the terminal's fast-forward mode once no more floods of output arrive.
+    //   Until then, this keeps checking every EndFastForwardInterval.
+    // - Afterwards, the hyperlink detection that was paused in the meantime catches up.
+    void ControlCore::_endFastForwardIfIdle()
+    {
+        auto ended = false;
+        {
+            const auto lock = _terminal->LockForWriting();
+            ended = _terminal->EndFastForwardIfIdle();
+        }
+
+        const auto shared = _shared.lock_shared();
+        if (!ended)
+        {
+            if (shared->endFastForward)
+            {
+                shared->endFastForward->Run();
+            }
+        }
+        else if (shared->updatePatternLocations)
+        {
+            (*shared->updatePatternLocations)();
+        }
+    }
+
     uint64_t ControlCore::SwapChainHandle() const
     {
         // This is only ever called by TermControl::AttachContent, which occurs
@@ -383,8 +383,7 @@ void HwndTerminal::SendOutput(std::wstring_view data)
     {
         return;
     }
-    const auto lock = _terminal->LockForWriting();
-    _terminal->Write(data);
+    _terminal->WriteSliced(data);
 }
 
 HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal)
@@ -12,6 +12,7 @@
 #include "../../buffer/out/UTextAdapter.h"
 
 #include <til/hash.h>
+#include <til/unicode.h>
 #include <winrt/Microsoft.Terminal.Core.h>
 
 using namespace winrt::Microsoft::Terminal::Core;
@@ -115,6 +116,12 @@ void Terminal::UpdateSettings(ICoreSettings settings)
         // Clear the patterns first
         _detectURLs = settings.DetectURLs();
         _updateUrlDetection();
+
+        _fastForwardOutput = settings.FastForwardOutput();
+        if (!_fastForwardOutput)
+        {
+            _setFastForward(false);
+        }
     }
 }
 
@@ -391,6 +398,8 @@ try
     _mutableViewport = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
 
     _mainBuffer.swap(newTextBuffer);
+    // The cached pattern matches refer to the old buffer's contents.
+    _patternCache = {};
 
     // GH#3494: Maintain scrollbar position during resize
     // Make sure that we don't scroll past the mutableViewport at the bottom of the buffer
@@ -425,6 +434,130 @@ void Terminal::Write(std::wstring_view stringView)
     }
 }
 
+// Method Description:
+// - Parses the given string just like Write(), but in slices of at most sliceSize characters,
+//   releasing and re-acquiring the write lock in between. Since the lock is fair, any thread that
+//   started waiting for it in the meantime (rendering, input handling, etc.) gets to run first.
+//   This bounds how long large payloads block those threads.
+// - The state machine keeps track of partial sequences, so slices may end anywhere,
+//   except in the middle of a grapheme cluster (see WriteSliceLength()).
+// - If the FastForwardOutput setting is enabled, payloads of at least FastForwardThreshold
+//   characters enter the fast-forward mode: Since the connection hands us everything it has
+//   buffered up at once, such payloads mean that output arrives faster than we can process it.
+//   Until EndFastForwardIfIdle() gets called after the flood, the renderer repaints each frame
+//   in its entirety instead of tracking every change, scroll and cursor notifications
+//   are deferred, hyperlink detection is paused and the new text isn't passed on to screen
+//   readers piece by piece (see Renderer::TriggerNewTextNotification()).
+//   The buffer contents are unaffected.
+// - INVARIANT: The caller must not hold the lock, or else it won't be released between slices.
+// Return Value:
+// - true if the terminal is in fast-forward mode after writing the string.
+bool Terminal::WriteSliced(std::wstring_view stringView, const size_t sliceSize)
+{
+    const auto size = std::max<size_t>(sliceSize, 2);
+    const auto flood = stringView.size() >= FastForwardThreshold;
+    auto fastForwarding = false;
+
+    while (!stringView.empty())
+    {
+        const auto count = WriteSliceLength(stringView, size);
+        const auto lock = LockForWriting();
+        if (flood && _fastForwardOutput)
+        {
+            _setFastForward(true);
+            _fastForward.lastWrite = std::chrono::steady_clock::now();
+        }
+
+        Write(stringView.substr(0, count));
+        stringView = stringView.substr(count);
+        fastForwarding = _fastForward.active;
+    }
+
+    return fastForwarding;
+}
+
+// Method Description:
+// - Returns the length of the next slice of the given string that WriteSliced() writes at once.
+//   It's at most sliceSize characters long and backs off to the start of the grapheme cluster
+//   that straddles the end of the slice, if any. Clusters that are split across writes would be
+//   joined again by the text buffer, but not if the cursor moves in between, for instance due to
+//   a delayed wrap at the end of the line, which may happen before the next slice arrives.
+// - A cluster that's longer than an entire slice has to be split up anyway,
+//   but never in the middle of a surrogate pair.
+// Arguments:
+// - stringView: the remaining text to write
+// - sliceSize: the maximum length of a slice, at least 2
+// Return Value:
+// - the number of characters to write next
+size_t Terminal::WriteSliceLength(const std::wstring_view stringView, const size_t sliceSize) noexcept
+{
+    if (stringView.size() <= sliceSize)
+    {
+        return stringView.size();
+    }
+
+    auto count = sliceSize;
+    const auto clusterBeg = TextBuffer::GraphemePrev(stringView, count);
+    if (TextBuffer::GraphemeNext(stringView, clusterBeg) > count)
+    {
+        if (clusterBeg > 0)
+        {
+            count = clusterBeg;
+        }
+        else if (til::is_leading_surrogate(til::at(stringView, count - 1)))
+        {
+            count--;
+        }
+    }
+    return count;
+}
+
+bool Terminal::IsFastForwarding() const noexcept
+{
+    return _fastForward.active;
+}
+
+// Method Description:
+// - Leaves the fast-forward mode (see WriteSliced()), unless a flood of output
+//   was written within the last FastForwardIdleTime.
+// - INVARIANT: This function can only be called if the caller has the writing lock on the terminal
+// Return Value:
+// - true if the terminal isn't fast-forwarding anymore.
+bool Terminal::EndFastForwardIfIdle()
+{
+    if (_fastForward.active && std::chrono::steady_clock::now() - _fastForward.lastWrite < FastForwardIdleTime)
+    {
+        return false;
+    }
+
+    _setFastForward(false);
+    return true;
+}
+
+void Terminal::_setFastForward(const bool enabled)
+{
+    if (_fastForward.active == enabled)
+    {
+        return;
+    }
+
+    _fastForward.active = enabled;
+    // Leaving this mode repaints the entire viewport, if anything changed in the meantime.
+    _mainBuffer->GetRenderer().SetInvalidationCoalescing(enabled);
+
+    if (!enabled)
+    {
+        if (std::exchange(_fastForward.scrolled, false))
+        {
+            _NotifyScrollEvent();
+        }
+        if (std::exchange(_fastForward.cursorMoved, false))
+        {
+            _NotifyTerminalCursorPositionChanged();
+        }
+    }
+}
+
 void Terminal::WritePastedText(std::wstring_view stringView)
 {
     const auto option = ::Microsoft::Console::Utils::FilterOption::CarriageReturnNewline |
@@ -1093,6 +1226,12 @@ void Terminal::_NotifyScrollEvent()
     // See UserScrollViewport().
     _clearPatternTree();
 
+    if (_fastForward.active)
+    {
+        _fastForward.scrolled = true;
+        return;
+    }
+
     if (_pfnScrollPositionChanged)
     {
         const auto visible = _GetVisibleViewport();
@@ -1105,6 +1244,12 @@ void Terminal::_NotifyScrollEvent()
 
 void Terminal::_NotifyTerminalCursorPositionChanged() noexcept
 {
+    if (_fastForward.active)
+    {
+        _fastForward.cursorMoved = true;
+        return;
+    }
+
     if (_pfnCursorPositionChanged)
     {
         try
@@ -1202,11 +1347,177 @@ void Terminal::SetCursorOn(const bool isOn) noexcept
 // - Update our internal knowledge about where regex patterns are on the screen
 // - This is called by TerminalControl (through a throttled function) when the visible
 //   region changes (for example by text entering the buffer or scrolling)
+// - Only the rows that changed since the last call (according to the buffer's change journal)
+//   or that scrolled into view are rescanned. The remaining matches are reused from _patternCache.
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock()
 {
+    // The number of distinct row ranges the journal remembers before asking us to rescan everything.
+    static constexpr size_t patternJournalCapacity = 256;
+
+    // Hyperlink detection is paused while fast-forwarding through a flood of output.
+    // Our caller updates the patterns again once that's over.
+    if (_fastForward.active)
+    {
+        return;
+    }
+
+    auto& buffer = _activeBuffer();
+    auto& cache = _patternCache;
+    const auto top = _VisibleStartIndex();
+    const auto bottom = _VisibleEndIndex();
+
+    buffer.EnableChangeJournal(patternJournalCapacity);
+
+    // dirty[y - top] is true if the visible row y needs to be rescanned.
+    std::vector<bool> dirty(gsl::narrow_cast<size_t>(bottom - top + 1), false);
+    // Marks the rows [beg, end] as dirty and returns true if any of them wasn't already.
+    const auto markDirty = [&](til::CoordType beg, til::CoordType end) {
+        auto changed = false;
+        for (auto y = std::max(beg, top), last = std::min(end, bottom); y <= last; ++y)
+        {
+            if (!dirty[y - top])
+            {
+                dirty[y - top] = true;
+                changed = true;
+            }
+        }
+        return changed;
+    };
+    const auto isDirty = [&](til::CoordType beg, til::CoordType end) {
+        for (auto y = std::max(beg, top), last = std::min(end, bottom); y <= last; ++y)
+        {
+            if (dirty[y - top])
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    // Matches can't extend past the edges of the viewport or contain whitespace, because none of our
+    // patterns match whitespace. A row that follows one ending in whitespace thus starts a "segment"
+    // which can be scanned independently of the rows before it and produce the same results.
+    const auto rowEndsInWhitespace = [&](til::CoordType y) {
+        const auto text = buffer.GetRowByOffset(y).GetText();
+        return !text.empty() && text.back() == L' ';
+    };
+
+    const auto changes = cache.buffer == &buffer ? buffer.GetChangesSince(cache.position) : TextBufferJournal::Changes{ .invalidateAll = true };
+    if (changes.invalidateAll)
+    {
+        cache.matches.clear();
+        markDirty(top, bottom);
+    }
+    else
+    {
+        if (changes.scrolled != 0)
+        {
+            for (auto& match : cache.matches)
+            {
+                match.start.y -= changes.scrolled;
+                match.stop.y -= changes.scrolled;
+            }
+            cache.top -= changes.scrolled;
+            cache.bottom -= changes.scrolled;
+        }
+
+        for (const auto& [beg, end] : changes.dirtyRows)
+        {
+            markDirty(beg, end - 1);
+        }
+
+        // Rows that weren't visible during the last scan need to be scanned for the first time.
+        // If an edge of the viewport moved, the text before/after the rows at the edge changed as well.
+        markDirty(top, cache.top - 1);
+        markDirty(cache.bottom + 1, bottom);
+        if (cache.top != top)
+        {
+            markDirty(top, top);
+        }
+        if (cache.bottom != bottom)
+        {
+            markDirty(bottom, bottom);
+        }
+
+        // A modified row is also the context for the row after it, because
+        // it may have started or stopped ending in whitespace.
+        for (auto y = bottom; y > top; --y)
+        {
+            if (dirty[y - 1 - top])
+            {
+                dirty[y - top] = true;
+            }
+        }
+    }
+
+    // Grow the dirty rows to the segments they're in and drop the cached matches that touch them,
+    // which in turn may have spanned rows that now belong to a different segment. Repeat until stable.
+    for (auto changed = true; changed;)
+    {
+        changed = false;
+
+        for (auto y = top; y <= bottom; ++y)
+        {
+            if (dirty[y - top])
+            {
+                auto beg = y;
+                auto end = y;
+                while (beg > top && !rowEndsInWhitespace(beg - 1))
+                {
+                    --beg;
+                }
+                while (end < bottom && !rowEndsInWhitespace(end))
+                {
+                    ++end;
+                }
+                markDirty(beg, end);
+                y = end;
+            }
+        }
+
+        for (const auto& match : cache.matches)
+        {
+            if (match.start.y < top || match.stop.y > bottom || isDirty(match.start.y, match.stop.y))
+            {
+                changed |= markDirty(match.start.y, match.stop.y);
+            }
+        }
+    }
+
+    std::erase_if(cache.matches, [&](const PointTree::interval& match) {
+        return match.start.y < top || match.stop.y > bottom || isDirty(match.start.y, match.stop.y);
+    });
+
+    for (auto y = top; y <= bottom; ++y)
+    {
+        if (dirty[y - top])
+        {
+            auto end = y;
+            while (end < bottom && dirty[end + 1 - top])
+            {
+                ++end;
+            }
+            _findPatterns(y, end, cache.matches);
+            y = end;
+        }
+    }
+
+    cache.buffer = &buffer;
+    cache.position = buffer.GetJournalPosition();
+    cache.top = top;
+    cache.bottom = bottom;
+
+    // The interval tree can't be modified once built, but constructing it from
+    // the cached matches is cheap compared to running the regexes again.
+    auto intervals = cache.matches;
+    for (auto& interval : intervals)
+    {
+        interval.start.y -= top;
+        interval.stop.y -= top;
+    }
+
     _InvalidatePatternTree();
-    _patternIntervalTree = _getPatterns(_VisibleStartIndex(), _VisibleEndIndex());
+    _patternIntervalTree = PointTree{ std::move(intervals) };
     _InvalidatePatternTree();
 }
 
@@ -1338,6 +1649,9 @@ TextBuffer& Terminal::_activeBuffer() const noexcept
 
 void Terminal::_updateUrlDetection()
 {
+    // This is called whenever we switch between the main and alt buffer, so we need to start from scratch.
+    _patternCache = {};
+
     if (_detectURLs)
     {
         UpdatePatternsUnderLock();
@@ -1415,36 +1729,204 @@ private:
 
 static URegularExpressionInterner uregexInterner;
 
-PointTree Terminal::_getPatterns(til::CoordType beg, til::CoordType end) const
+struct PatternDefinition
+{
+    std::wstring_view pattern;
+    // Every match of the pattern starts with one of these (ASCII) literals.
+    std::span<const std::wstring_view> prefixes;
+};
+
+static constexpr std::array<std::wstring_view, 4> urlPrefixes{ L"http://", L"https://", L"ftp://", L"file://" };
+static constexpr std::array<PatternDefinition, 1> patterns{ {
+    { LR"(\b(?:https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])", urlPrefixes },
+} };
+
+// Finds the positions at which any of the patterns could match in a single pass over the text, using
+// an Aho-Corasick automaton over their literal prefixes. This way the regex engine only needs
+// to run at a handful of candidate positions instead of scanning the entire text once per pattern.
+class LiteralPrefilter
 {
-    static constexpr std::array<std::wstring_view, 1> patterns{
-        LR"(\b(?:https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])",
+public:
+    using State = uint16_t;
+
+    template<size_t N>
+    explicit LiteralPrefilter(const std::array<PatternDefinition, N>& patterns)
+    {
+        static_assert(N <= 32, "the pattern masks are 32 bits wide");
+
+        // Build a trie out of all literals...
+        _nodes.emplace_back();
+        for (size_t i = 0; i < N; ++i)
+        {
+            for (const auto& literal : til::at(patterns, i).prefixes)
+            {
+                State state = 0;
+                for (const auto ch : literal)
+                {
+                    FAIL_FAST_IF(ch >= asciiCount);
+                    auto next = til::at(_nodes.at(state).next, ch);
+                    if (next == 0)
+                    {
+                        next = gsl::narrow_cast<State>(_nodes.size());
+                        til::at(_nodes.at(state).next, ch) = next;
+                        _nodes.emplace_back();
+                    }
+                    state = next;
+                }
+                _nodes.at(state).outputs.emplace_back(literal.size(), 1u << i);
+            }
+        }
+
+        // ...and turn it into a DFA by following the failure links breadth-first. Each node inherits
+        // the outputs of its failure node, because those literals are suffixes of the node's literal.
+        std::vector<State> failure(_nodes.size());
+        std::deque<State> queue;
+        for (const auto next : _nodes.front().next)
+        {
+            if (next != 0)
+            {
+                queue.emplace_back(next);
+            }
+        }
+        while (!queue.empty())
+        {
+            const auto state = queue.front();
+            queue.pop_front();
+
+            for (wchar_t ch = 0; ch < asciiCount; ++ch)
+            {
+                const auto fallback = til::at(_nodes.at(failure.at(state)).next, ch);
+                auto& next = til::at(_nodes.at(state).next, ch);
+                if (next == 0)
+                {
+                    next = fallback;
+                    continue;
+                }
+                failure.at(next) = fallback;
+                const auto& inherited = _nodes.at(fallback).outputs;
+                auto& outputs = _nodes.at(next).outputs;
+                outputs.insert(outputs.end(), inherited.begin(), inherited.end());
+                queue.emplace_back(next);
+            }
+        }
+    }
+
+    // Feeds `text` into the automaton, starting in (and returning) the given state.
+    // This allows literals to span multiple consecutive calls. For every literal that ends
+    // in `text`, `onMatch(end, length, mask)` is called with `end` being relative to `text`.
+    template<typename T>
+    State Scan(State state, const std::wstring_view& text, T&& onMatch) const
+    {
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const auto ch = til::at(text, i);
+            // None of the literals contain non-ASCII characters, so they can't be part of a match.
+            state = ch < asciiCount ? til::at(til::at(_nodes, state).next, ch) : 0;
+            for (const auto& [length, mask] : til::at(_nodes, state).outputs)
+            {
+                onMatch(i + 1, length, mask);
+            }
+        }
+        return state;
+    }
+
+private:
+    static constexpr wchar_t asciiCount = 0x80;
+
+    struct Node
+    {
+        std::array<State, asciiCount> next{};
+        // The length of each literal that ends in this node and the patterns it belongs to.
+        std::vector<std::pair<size_t, uint32_t>> outputs;
     };
 
-    auto text = ICU::UTextFromTextBuffer(_activeBuffer(), beg, end + 1);
-    UErrorCode status = U_ZERO_ERROR;
+    std::vector<Node> _nodes;
+};
+
+PointTree Terminal::_getPatterns(til::CoordType beg, til::CoordType end) const
+{
     PointTree::interval_vector intervals;
+    _findPatterns(beg, end, intervals);
 
-    for (size_t i = 0; i < patterns.size(); ++i)
+    // PointTree uses viewport-relative coordinates.
+    for (auto& interval : intervals)
     {
-        const auto re = uregexInterner.Intern(patterns.at(i));
-        uregex_setUText(re.get(), &text, &status);
+        interval.start.y -= beg;
+        interval.stop.y -= beg;
+    }
+
+    return PointTree{ std::move(intervals) };
+}
 
-        if (uregex_find(re.get(), -1, &status))
+// Appends the pattern matches in the rows [beg, end] to `intervals`, in absolute buffer coordinates.
+void Terminal::_findPatterns(til::CoordType beg, til::CoordType end, PointTree::interval_vector& intervals) const
+{
+    static const LiteralPrefilter prefilter{ patterns };
+
+    const auto& buffer = _activeBuffer();
+
+    // The native (UText) index at which a literal starts and the patterns that could match there.
+    // The native indices are the same as those of the UText below, because it concatenates the same rows.
+    std::vector<std::pair<int64_t, uint32_t>> candidates;
+    {
+        LiteralPrefilter::State state = 0;
+        int64_t rowStart = 0;
+
+        for (auto y = beg; y <= end; ++y)
+        {
+            const auto rowText = buffer.GetRowByOffset(y).GetText();
+            state = prefilter.Scan(state, rowText, [&](size_t literalEnd, size_t literalLength, uint32_t mask) {
+                candidates.emplace_back(rowStart + gsl::narrow_cast<int64_t>(literalEnd) - gsl::narrow_cast<int64_t>(literalLength), mask);
+            });
+            rowStart += gsl::narrow_cast<int64_t>(rowText.size());
+        }
+    }
+
+    if (candidates.empty())
+    {
+        return;
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    ICU::UTextIndex index;
+    auto text = ICU::UTextFromTextBuffer(buffer, beg, end + 1, index);
+    UErrorCode status = U_ZERO_ERROR;
+
+    // The regexes are only interned once a candidate for them shows up.
+    std::array<ICU::unique_uregex, patterns.size()> regexes;
+    // Like uregex_findNext(), matches of the same pattern don't overlap: A pattern only
+    // gets tested again at candidates that start at or after the end of its last match.
+    std::array<int64_t, patterns.size()> resumeAt{};
+
+    for (const auto& [start, mask] : candidates)
+    {
+        for (size_t i = 0; i < patterns.size(); ++i)
         {
-            do
+            if ((mask & (1u << i)) == 0 || start < til::at(resumeAt, i))
+            {
+                continue;
+            }
+
+            auto& re = til::at(regexes, i);
+            if (!re)
+            {
+                re = uregexInterner.Intern(til::at(patterns, i).pattern);
+                uregex_setUText(re.get(), &text, &status);
+            }
+
+            // lookingAt() anchors the match at `start`, but unlike a region it still
+            // lets the regex see the preceding text, which `\b` and friends depend on.
+            if (uregex_lookingAt64(re.get(), start, &status))
             {
                 auto range = ICU::BufferRangeFromMatch(&text, re.get());
-                // PointTree uses half-open ranges and viewport-relative coordinates.
-                range.start.y -= beg;
-                range.end.y -= beg;
+                // PointTree uses half-open ranges.
                 range.end.x++;
                 intervals.push_back(PointTree::interval(range.start, range.end, 0));
-            } while (uregex_findNext(re.get(), &status));
+                til::at(resumeAt, i) = uregex_end64(re.get(), 0, &status);
+            }
         }
     }
-
-    return PointTree{ std::move(intervals) };
 }
 
 // NOTE: This is the version of AddMark that comes from the UI. The VT api call into this too.
@@ -97,6 +97,17 @@ public:
 
     // Write comes from the PTY and goes to our parser to be stored in the output buffer
     void Write(std::wstring_view stringView);
+    // Like Write, but acquires the write lock itself, once per slice of at most sliceSize characters.
+    // Returns true if the terminal is fast-forwarding through a flood of output afterwards.
+    static constexpr size_t DefaultWriteSliceSize = 16 * 1024;
+    bool WriteSliced(std::wstring_view stringView, size_t sliceSize = DefaultWriteSliceSize);
+    static size_t WriteSliceLength(std::wstring_view stringView, size_t sliceSize) noexcept;
+    // Payloads at least this large put the terminal into fast-forward mode (if enabled),
+    // which it leaves once no such payload arrived for FastForwardIdleTime.
+    static constexpr size_t FastForwardThreshold = 64 * 1024;
+    static constexpr auto FastForwardIdleTime = std::chrono::milliseconds{ 100 };
+    bool IsFastForwarding() const noexcept;
+    bool EndFastForwardIfIdle();
 
     // WritePastedText comes from our input and goes back to the PTY's input channel
     void WritePastedText(std::wstring_view stringView);
@@ -384,6 +395,17 @@ private:
     Microsoft::Console::Types::Viewport _mutableViewport;
     til::CoordType _scrollbackLines = 0;
     bool _detectURLs = false;
+    bool _fastForwardOutput = false;
+
+    // While fast-forwarding, invalidations are coalesced by the renderer
+    // and the scroll and cursor notifications are deferred until the end.
+    struct FastForwardState
+    {
+        bool active = false;
+        bool scrolled = false;
+        bool cursorMoved = false;
+        std::chrono::steady_clock::time_point lastWrite;
+    } _fastForward;
 
     til::size _altBufferSize;
     std::optional<til::size> _deferredResize;
@@ -405,6 +427,16 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The matches found by the last UpdatePatternsUnderLock() call. They're stored in absolute buffer
+    // coordinates, so that the next call only needs to rescan the rows that changed in the meantime.
+    struct PatternCache
+    {
+        const TextBuffer* buffer = nullptr;
+        TextBufferJournal::Position position;
+        til::CoordType top = 0;
+        til::CoordType bottom = -1;
+        interval_tree::IntervalTree<til::point, size_t>::interval_vector matches;
+    } _patternCache;
     void _clearPatternTree();
     void _InvalidatePatternTree();
     void _InvalidateFromCoords(const til::point start, const til::point end);
@@ -450,11 +482,13 @@ private:
     void _NotifyScrollEvent();
 
     void _NotifyTerminalCursorPositionChanged() noexcept;
+    void _setFastForward(const bool enabled);
 
     bool _inAltBuffer() const noexcept;
     TextBuffer& _activeBuffer() const noexcept;
     void _updateUrlDetection();
     interval_tree::IntervalTree<til::point, size_t> _getPatterns(til::CoordType beg, til::CoordType end) const;
+    void _findPatterns(til::CoordType beg, til::CoordType end, interval_tree::IntervalTree<til::point, size_t>::interval_vector& intervals) const;
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
@@ -363,6 +363,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _ForceVTInput = globalSettings.ForceVTInput();
         _TrimBlockSelection = globalSettings.TrimBlockSelection();
         _DetectURLs = globalSettings.DetectURLs();
+        _FastForwardOutput = globalSettings.FastForwardOutput();
         _EnableUnfocusedAcrylic = globalSettings.EnableUnfocusedAcrylic();
     }
 
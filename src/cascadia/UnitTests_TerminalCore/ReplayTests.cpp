@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../renderer/inc/DummyRenderer.hpp"
+#include "../renderer/inc/RenderEngineBase.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../cascadia/inc/ConnectionRecording.h"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Terminal::Recording;
+using namespace Microsoft::Console::Render;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace
+{
+    // Counts the frames that had anything to paint. The painting itself is a no-op.
+    class CountingRenderEngine final : public RenderEngineBase
+    {
+    public:
+        size_t Frames() const noexcept
+        {
+            return _frames;
+        }
+
+        HRESULT StartPaint() noexcept
+        {
+            if (!std::exchange(_invalidated, false))
+            {
+                return S_FALSE;
+            }
+            _frames++;
+            return S_OK;
+        }
+        HRESULT EndPaint() noexcept { return S_OK; }
+        HRESULT Present() noexcept { return S_OK; }
+        HRESULT PrepareForTeardown(_Out_ bool* /*pForcePaint*/) noexcept { return S_OK; }
+        HRESULT ScrollFrame() noexcept { return S_OK; }
+        HRESULT Invalidate(const til::rect* /*psrRegion*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateCursor(const til::rect* /*psrRegion*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept { return S_OK; }
+        HRESULT InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateAll() noexcept { return _invalidate(); }
+        HRESULT InvalidateCircling(_Out_ bool* /*pForcePaint*/) noexcept { return S_OK; }
+        HRESULT PaintBackground() noexcept { return S_OK; }
+        HRESULT PaintBufferLine(std::span<const Cluster> /*clusters*/, til::point /*coord*/, bool /*fTrimLeft*/, bool /*lineWrapped*/) noexcept { return S_OK; }
+        HRESULT PaintBufferGridLines(GridLineSet /*lines*/, COLORREF /*color*/, size_t /*cchLine*/, til::point /*coordTarget*/) noexcept { return S_OK; }
+        HRESULT PaintSelection(const til::rect& /*rect*/) noexcept { return S_OK; }
+        HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept { return S_OK; }
+        HRESULT UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/, const RenderSettings& /*renderSettings*/, gsl::not_null<IRenderData*> /*pData*/, bool /*usingSoftFont*/, bool /*isSettingDefaultBrushes*/) noexcept { return S_OK; }
+        HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept { return S_OK; }
+        HRESULT UpdateDpi(int /*iDpi*/) noexcept { return S_OK; }
+        HRESULT UpdateViewport(const til::inclusive_rect& /*srNewViewport*/) noexcept { return S_OK; }
+        HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, int /*iDpi*/) noexcept { return S_OK; }
+        HRESULT GetDirtyArea(std::span<const til::rect>& /*area*/) noexcept { return S_OK; }
+        HRESULT GetFontSize(_Out_ til::size* /*pFontSize*/) noexcept { return S_OK; }
+        HRESULT IsGlyphWideByFont(std::wstring_view /*glyph*/, _Out_ bool* /*pResult*/) noexcept { return S_OK; }
+
+    protected:
+        HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept { return S_OK; }
+
+    private:
+        HRESULT _invalidate() noexcept
+        {
+            _invalidated = true;
+            return S_OK;
+        }
+
+        bool _invalidated = false;
+        size_t _frames = 0;
+    };
+}
+
+namespace TerminalCoreUnitTests
+{
+    class ReplayTests final
+    {
+        TEST_CLASS(ReplayTests);
+
+        TEST_METHOD(RecordingRoundtrip);
+        TEST_METHOD(ReplayRecording);
+    };
+};
+
+using namespace TerminalCoreUnitTests;
+
+void ReplayTests::RecordingRoundtrip()
+{
+    const auto path = (std::filesystem::temp_directory_path() / L"ReplayTests.RecordingRoundtrip.wtrec").wstring();
+    auto cleanup = wil::scope_exit([&]() { DeleteFileW(path.c_str()); });
+
+    // Long enough for the payload length to need a multi-byte varint.
+    const std::string output(1000, 'x');
+    {
+        RecordingWriter writer{ path };
+        writer.WriteResize(30, 120);
+        writer.Write(RecordType::Output, output);
+        writer.Write(RecordType::Input, "\x1b[A");
+        writer.Write(RecordType::Output, "");
+    }
+
+    const auto data = RecordingReader::LoadFile(path);
+    RecordingReader reader{ data };
+    std::chrono::microseconds lastTimestamp{};
+
+    const auto expectRecord = [&](const RecordType type, const std::string_view& payload) {
+        const auto record = reader.Next();
+        VERIFY_IS_TRUE(record.has_value());
+        VERIFY_IS_TRUE(type == record->type);
+        VERIFY_IS_TRUE(payload == record->payload);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(record->timestamp.count(), lastTimestamp.count());
+        lastTimestamp = record->timestamp;
+        return record->payload;
+    };
+
+    const auto resize = expectRecord(RecordType::Resize, std::string_view{ "\x1e\x78", 2 });
+    const auto [rows, columns] = RecordingReader::ParseResize(resize);
+    VERIFY_ARE_EQUAL(30u, rows);
+    VERIFY_ARE_EQUAL(120u, columns);
+
+    expectRecord(RecordType::Output, output);
+    expectRecord(RecordType::Input, "\x1b[A");
+    expectRecord(RecordType::Output, "");
+    VERIFY_IS_FALSE(reader.Next().has_value());
+
+    Log::Comment(L"Truncated recordings are rejected.");
+    RecordingReader truncated{ std::string_view{ data }.substr(0, data.size() - 2) };
+    VERIFY_NO_THROW(truncated.Next());
+    VERIFY_NO_THROW(truncated.Next());
+    VERIFY_NO_THROW(truncated.Next());
+    VERIFY_THROWS(truncated.Next(), wil::ResultException);
+
+    VERIFY_THROWS(RecordingReader{ "not a recording" }, wil::ResultException);
+}
+
+// Replays a recording made with the "experimental.connection.recordingPath" profile setting
+// and reports how long it took to parse and how it would've affected rendering:
+//   te.exe UnitTests_TerminalCore\Terminal.Core.Unit.Tests.dll /name:*ReplayRecording* /p:Recording=<path>
+// The output is parsed in the same slices as Terminal::WriteSliced(), each of which holds the lock.
+// Frames are painted every 1/60 s along the timestamps of the recording, no matter how long
+// parsing takes, so that the frame count only depends on the recording.
+void ReplayTests::ReplayRecording()
+{
+    using clock = std::chrono::steady_clock;
+    static constexpr std::chrono::microseconds frameInterval{ 16667 };
+
+    String recordingPath;
+    if (FAILED(RuntimeParameters::TryGetValue(L"Recording", recordingPath)) || recordingPath.IsEmpty())
+    {
+        Log::Comment(L"Pass /p:Recording=<path> to replay a recording.");
+        Log::Result(TestResults::Skipped);
+        return;
+    }
+
+    const auto data = RecordingReader::LoadFile(std::wstring{ static_cast<const wchar_t*>(recordingPath) });
+    RecordingReader reader{ data };
+
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    CountingRenderEngine engine;
+    renderer.AddRenderEngine(&engine);
+    term.Create({ 120, 30 }, 9001, renderer);
+
+    til::u8state u8State;
+    std::wstring u16Str;
+    uint64_t bytes = 0;
+    size_t slices = 0;
+    size_t slicesOverFrame = 0;
+    clock::duration parseTime{};
+    clock::duration maxLockHold{};
+    clock::duration paintTime{};
+    auto nextFrame = frameInterval;
+
+    const auto paint = [&]() {
+        const auto beg = clock::now();
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+        paintTime += clock::now() - beg;
+    };
+
+    while (const auto record = reader.Next())
+    {
+        if (record->timestamp >= nextFrame)
+        {
+            // Nothing changed during any of the frames we skip over.
+            paint();
+            nextFrame = (record->timestamp / frameInterval + 1) * frameInterval;
+        }
+
+        switch (record->type)
+        {
+        case RecordType::Output:
+        {
+            VERIFY_SUCCEEDED(til::u8u16(record->payload, u16Str, u8State));
+            bytes += record->payload.size();
+
+            for (std::wstring_view remaining{ u16Str }; !remaining.empty();)
+            {
+                const auto count = Terminal::WriteSliceLength(remaining, Terminal::DefaultWriteSliceSize);
+                const auto beg = clock::now();
+                {
+                    const auto lock = term.LockForWriting();
+                    term.Write(remaining.substr(0, count));
+                }
+                const auto duration = clock::now() - beg;
+
+                parseTime += duration;
+                maxLockHold = std::max(maxLockHold, duration);
+                slicesOverFrame += duration >= frameInterval;
+                slices++;
+                remaining = remaining.substr(count);
+            }
+            break;
+        }
+        case RecordType::Resize:
+        {
+            const auto [rows, columns] = RecordingReader::ParseResize(record->payload);
+            const auto lock = term.LockForWriting();
+            VERIFY_SUCCEEDED(term.UserResize({ gsl::narrow<til::CoordType>(columns), gsl::narrow<til::CoordType>(rows) }));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    paint();
+
+    const auto ms = [](const clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    Log::Comment(NoThrowString().Format(L"Output: %llu bytes", bytes));
+    Log::Comment(NoThrowString().Format(L"Parse time: %.3f ms in %zu slices", ms(parseTime), slices));
+    Log::Comment(NoThrowString().Format(L"Lock hold time: at most %.3f ms, %zu slices held it for a frame or longer", ms(maxLockHold), slicesOverFrame));
+    Log::Comment(NoThrowString().Format(L"Frames: %zu painted in %.3f ms", engine.Frames(), ms(paintTime)));
+}
@@ -12,6 +12,7 @@
 using namespace winrt::Microsoft::Terminal::Core;
 using namespace Microsoft::Terminal::Core;
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 
@@ -41,6 +42,14 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(UpdatePatternsIncrementally);
+        TEST_METHOD(GetPatternsFromLiteralPrefixes);
+
+        TEST_METHOD(WriteSlicedMatchesWrite);
+        TEST_METHOD(WriteSliceLengthKeepsClustersIntact);
+        TEST_METHOD(FastForwardMatchesWrite);
+        TEST_METHOD(WriteSlicedLockHoldBenchmark);
     };
 };
 
@@ -476,3 +485,305 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;D:\\中文\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"D:\\中文");
 }
+
+void TerminalApiTest::UpdatePatternsIncrementally()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 40, 10 }, 20, renderer);
+    term._detectURLs = true;
+
+    auto& stateMachine = *(term._stateMachine);
+
+    // Rescanning the entire viewport must always produce the same result as the incremental update.
+    // Returns the number of patterns that were found.
+    const auto updatePatterns = [&]() {
+        term.UpdatePatternsUnderLock();
+
+        const auto collect = [](const interval_tree::IntervalTree<til::point, size_t>& tree) {
+            std::vector<std::pair<til::point, til::point>> ranges;
+            tree.visit_all([&](const auto& interval) {
+                ranges.emplace_back(interval.start, interval.stop);
+            });
+            std::sort(ranges.begin(), ranges.end());
+            return ranges;
+        };
+        const auto actual = collect(term._patternIntervalTree);
+        const auto expected = collect(term._getPatterns(term._VisibleStartIndex(), term._VisibleEndIndex()));
+
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i].first, actual[i].first);
+            VERIFY_ARE_EQUAL(expected[i].second, actual[i].second);
+        }
+        return actual.size();
+    };
+
+    stateMachine.ProcessString(L"see https://example.com/a here\r\n");
+    VERIFY_ARE_EQUAL(1u, updatePatterns());
+
+    // A URL that wraps across three rows.
+    stateMachine.ProcessString(L"https://example.com/");
+    stateMachine.ProcessString(std::wstring(70, L'b'));
+    stateMachine.ProcessString(L"\r\n");
+    VERIFY_ARE_EQUAL(2u, updatePatterns());
+
+    // Turn the first URL into plain text by overwriting its scheme.
+    stateMachine.ProcessString(L"\x1b[1;5Hxxxxx\x1b[5;1H");
+    VERIFY_ARE_EQUAL(1u, updatePatterns());
+
+    // Break up the wrapped URL. It now ends on the second row.
+    stateMachine.ProcessString(L"\x1b[3;20H \x1b[5;1H");
+    VERIFY_ARE_EQUAL(1u, updatePatterns());
+
+    // Scroll the viewport down and then rotate the buffer, so that cached matches need to move.
+    for (auto i = 0; i < 30; ++i)
+    {
+        stateMachine.ProcessString(L"line ftp://example.com/line\r\n");
+        updatePatterns();
+    }
+    VERIFY_ARE_EQUAL(9u, updatePatterns());
+
+    // Scrolling into the scrollback reveals rows that weren't scanned yet.
+    term.UserScrollViewport(0);
+    VERIFY_ARE_EQUAL(10u, updatePatterns());
+    term.UserScrollViewport(5);
+    VERIFY_ARE_EQUAL(10u, updatePatterns());
+    term.UserScrollViewport(term._mutableViewport.Top());
+    VERIFY_ARE_EQUAL(9u, updatePatterns());
+
+    // A row that doesn't end in whitespace continues on the next one.
+    // Modifying the second row must find the match that starts on the first one.
+    stateMachine.ProcessString(L"\x1b[5;35Hhttp:/");
+    VERIFY_ARE_EQUAL(9u, updatePatterns());
+    stateMachine.ProcessString(L"\x1b[6;1H/");
+    VERIFY_ARE_EQUAL(10u, updatePatterns());
+}
+
+void TerminalApiTest::GetPatternsFromLiteralPrefixes()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 40, 10 }, 0, renderer);
+
+    auto& stateMachine = *(term._stateMachine);
+
+    // * "xhttp://" contains a literal prefix, but no word boundary in front of it.
+    // * The "https://" prefix at the end of the first row wraps onto the second one.
+    // * The second "https://" in "https://https://g" is part of the first match and mustn't produce another one.
+    stateMachine.ProcessString(L"xhttp://no.match http://a.bc ftp://d, ht");
+    stateMachine.ProcessString(L"tps://e.f https://https://g");
+
+    std::vector<std::pair<til::point, til::point>> actual;
+    term._getPatterns(0, 1).visit_all([&](const auto& interval) {
+        actual.emplace_back(interval.start, interval.stop);
+    });
+    std::sort(actual.begin(), actual.end());
+
+    const std::vector<std::pair<til::point, til::point>> expected{
+        { { 17, 0 }, { 28, 0 } },
+        { { 29, 0 }, { 36, 0 } },
+        { { 38, 0 }, { 9, 1 } },
+        { { 10, 1 }, { 27, 1 } },
+    };
+
+    VERIFY_ARE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(expected[i].first, actual[i].first);
+        VERIFY_ARE_EQUAL(expected[i].second, actual[i].second);
+    }
+}
+
+void TerminalApiTest::WriteSlicedMatchesWrite()
+{
+    // Escape sequences, a surrogate pair and wide glyphs, which will all get split across slices.
+    const std::wstring_view payload{ L"\x1b[31mred\x1b[m \U0001F600 \x1b]0;title\x07\u3042\u3044\r\n\x1b[2;5Hmoved\x1b[1K" };
+
+    Terminal expectedTerm;
+    DummyRenderer expectedRenderer{ &expectedTerm };
+    expectedTerm.Create({ 20, 5 }, 0, expectedRenderer);
+    {
+        const auto lock = expectedTerm.LockForWriting();
+        expectedTerm.Write(payload);
+    }
+    const auto& expectedBuffer = expectedTerm.GetTextBuffer();
+
+    for (const auto sliceSize : std::array<size_t, 5>{ 1, 2, 3, 7, 64 })
+    {
+        Log::Comment(NoThrowString().Format(L"sliceSize: %zu", sliceSize));
+
+        Terminal term;
+        DummyRenderer renderer{ &term };
+        term.Create({ 20, 5 }, 0, renderer);
+        term.WriteSliced(payload, sliceSize);
+
+        const auto& buffer = term.GetTextBuffer();
+        VERIFY_ARE_EQUAL(expectedBuffer.GetCursor().GetPosition(), buffer.GetCursor().GetPosition());
+        VERIFY_ARE_EQUAL(expectedTerm.GetConsoleTitle(), term.GetConsoleTitle());
+        for (til::CoordType y = 0; y < 5; ++y)
+        {
+            const auto& expectedRow = expectedBuffer.GetRowByOffset(y);
+            const auto& row = buffer.GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(expectedRow.GetText(), row.GetText());
+            VERIFY_IS_TRUE(expectedRow.Attributes() == row.Attributes());
+        }
+    }
+}
+
+void TerminalApiTest::WriteSliceLengthKeepsClustersIntact()
+{
+    Log::Comment(L"Slices that end on a cluster boundary are kept as is.");
+    VERIFY_ARE_EQUAL(3u, Terminal::WriteSliceLength(L"abcdef", 3));
+    VERIFY_ARE_EQUAL(3u, Terminal::WriteSliceLength(L"abc", 8));
+    VERIFY_ARE_EQUAL(3u, Terminal::WriteSliceLength(L"ae\u0301b", 3));
+
+    Log::Comment(L"Slices back off to the start of the cluster that straddles their end.");
+    VERIFY_ARE_EQUAL(1u, Terminal::WriteSliceLength(L"ae\u0301b", 2));
+    VERIFY_ARE_EQUAL(1u, Terminal::WriteSliceLength(L"a\U0001F600b", 2));
+    VERIFY_ARE_EQUAL(1u, Terminal::WriteSliceLength(L"a\U0001F600\u200D\U0001F525b", 4));
+    VERIFY_ARE_EQUAL(1u, Terminal::WriteSliceLength(L"a\r\nb", 2));
+
+    Log::Comment(L"Clusters longer than a slice are split, but not in the middle of a surrogate pair.");
+    VERIFY_ARE_EQUAL(2u, Terminal::WriteSliceLength(L"e\u0301\u0302\u0303", 2));
+    VERIFY_ARE_EQUAL(3u, Terminal::WriteSliceLength(L"\U0001F600\u200D\U0001F525", 4));
+}
+
+void TerminalApiTest::FastForwardMatchesWrite()
+{
+    // Colored, numbered lines that scroll through the entire scrollback.
+    std::wstring payload;
+    for (auto i = 0; payload.size() < Terminal::FastForwardThreshold; ++i)
+    {
+        payload.append(L"\x1b[3");
+        payload.append(std::to_wstring(i % 8));
+        payload.append(L"mline ");
+        payload.append(std::to_wstring(i));
+        payload.append(L"\x1b[m\r\n");
+    }
+
+    auto settings = winrt::make<MockTermSettings>(100, 20, 40);
+
+    Terminal expectedTerm;
+    DummyRenderer expectedRenderer{ &expectedTerm };
+    expectedTerm.CreateFromSettings(settings, expectedRenderer);
+    {
+        const auto lock = expectedTerm.LockForWriting();
+        expectedTerm.Write(payload);
+    }
+
+    settings.FastForwardOutput(true);
+
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.CreateFromSettings(settings, renderer);
+    auto scrollEvents = 0;
+    term.SetScrollPositionChangedCallback([&](const int, const int, const int) { ++scrollEvents; });
+
+    Log::Comment(L"Scroll notifications are deferred while fast-forwarding.");
+    VERIFY_IS_TRUE(term.WriteSliced(payload));
+    VERIFY_IS_TRUE(term.IsFastForwarding());
+    VERIFY_ARE_EQUAL(0, scrollEvents);
+    {
+        const auto lock = term.LockForWriting();
+        VERIFY_IS_FALSE(term.EndFastForwardIfIdle());
+    }
+
+    Sleep(gsl::narrow_cast<DWORD>(2 * Terminal::FastForwardIdleTime.count()));
+    {
+        const auto lock = term.LockForWriting();
+        VERIFY_IS_TRUE(term.EndFastForwardIfIdle());
+    }
+    VERIFY_IS_FALSE(term.IsFastForwarding());
+    VERIFY_ARE_EQUAL(1, scrollEvents);
+
+    Log::Comment(L"The buffer contents are identical to a regular Write().");
+    const auto& expectedBuffer = expectedTerm.GetTextBuffer();
+    const auto& buffer = term.GetTextBuffer();
+    VERIFY_ARE_EQUAL(expectedBuffer.GetCursor().GetPosition(), buffer.GetCursor().GetPosition());
+    VERIFY_ARE_EQUAL(expectedTerm.GetScrollOffset(), term.GetScrollOffset());
+    for (til::CoordType y = 0; y < expectedBuffer.GetSize().Height(); ++y)
+    {
+        const auto& expectedRow = expectedBuffer.GetRowByOffset(y);
+        const auto& row = buffer.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(expectedRow.GetText(), row.GetText());
+        VERIFY_IS_TRUE(expectedRow.Attributes() == row.Attributes());
+    }
+
+    Log::Comment(L"Payloads below the threshold don't enter the fast-forward mode.");
+    Terminal smallTerm;
+    DummyRenderer smallRenderer{ &smallTerm };
+    smallTerm.CreateFromSettings(settings, smallRenderer);
+    const auto smallPayload = payload.substr(0, Terminal::FastForwardThreshold - 1);
+    VERIFY_IS_FALSE(smallTerm.WriteSliced(smallPayload, 1024));
+    VERIFY_IS_FALSE(smallTerm.IsFastForwarding());
+}
+
+// Writes a large payload with Write() under a single lock and with WriteSliced(), while another thread
+// acquires the lock every millisecond like the renderer does, and reports the longest time it had to wait:
+//   te.exe UnitTests_TerminalCore\Terminal.Core.Unit.Tests.dll /name:*WriteSlicedLockHoldBenchmark* /p:WriteMegabytes=<count>
+void TerminalApiTest::WriteSlicedLockHoldBenchmark()
+{
+    using clock = std::chrono::steady_clock;
+
+    size_t megabytes = 4;
+    {
+        String value;
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"WriteMegabytes", value)) && !value.IsEmpty())
+        {
+            megabytes = wcstoul(value, nullptr, 10);
+        }
+    }
+
+    std::wstring payload;
+    for (auto i = 0; payload.size() * sizeof(wchar_t) < megabytes * 1024 * 1024; ++i)
+    {
+        payload.append(L"\x1b[3");
+        payload.append(std::to_wstring(i % 8));
+        payload.append(L"mline ");
+        payload.append(std::to_wstring(i));
+        payload.append(L"\x1b[m\r\n");
+    }
+
+    const auto measure = [&](const auto& write) {
+        Terminal term;
+        DummyRenderer renderer{ &term };
+        term.Create({ 120, 30 }, 9001, renderer);
+
+        std::atomic<bool> done{ false };
+        clock::duration maxWait{};
+        std::thread reader{ [&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const auto beg = clock::now();
+                {
+                    const auto lock = term.LockForReading();
+                }
+                maxWait = std::max(maxWait, clock::now() - beg);
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+            }
+        } };
+
+        const auto beg = clock::now();
+        write(term);
+        const auto duration = clock::now() - beg;
+
+        done.store(true, std::memory_order_relaxed);
+        reader.join();
+        return std::pair{ duration, maxWait };
+    };
+
+    const auto ms = [](const clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    const auto [writeTime, writeWait] = measure([&](Terminal& term) {
+        const auto lock = term.LockForWriting();
+        term.Write(payload);
+    });
+    const auto [slicedTime, slicedWait] = measure([&](Terminal& term) {
+        term.WriteSliced(payload);
+    });
+
+    Log::Comment(NoThrowString().Format(L"Output: %zu characters", payload.size()));
+    Log::Comment(NoThrowString().Format(L"Write: %.3f ms, longest wait for the lock: %.3f ms", ms(writeTime), ms(writeWait)));
+    Log::Comment(NoThrowString().Format(L"WriteSliced: %.3f ms, longest wait for the lock: %.3f ms", ms(slicedTime), ms(slicedWait)));
+}
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*++
+Module Name:
+- ConnectionRecording.h
+
+Abstract:
+- Reads and writes recordings of a connection's output, input and resizes.
+  A recording of a session can be replayed later as a reproducible benchmark.
+
+File format:
+- The 8 byte Magic, followed by any number of records, each consisting of:
+  - RecordType (1 byte)
+  - microseconds since the previous record (varint)
+  - payload length (varint)
+  - payload: For Output and Input the UTF-8 text as it was sent over the pipes.
+    For Resize the number of rows and columns (2 varints).
+- Varints are unsigned LEB128: 7 bits per byte, least significant group first,
+  with the high bit set on all but the last byte.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::Recording
+{
+    enum class RecordType : uint8_t
+    {
+        Output = 0,
+        Input = 1,
+        Resize = 2,
+    };
+
+    struct Record
+    {
+        RecordType type;
+        // The time since the start of the recording.
+        std::chrono::microseconds timestamp;
+        std::string_view payload;
+    };
+
+    inline constexpr std::string_view Magic{ "WTREC\x01\r\n", 8 };
+
+    namespace details
+    {
+        inline void appendVarint(std::string& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        // Consumes a varint from the front of `in`. Throws if it's truncated or too long.
+        inline uint64_t consumeVarint(std::string_view& in)
+        {
+            uint64_t value = 0;
+            for (auto shift = 0; shift < 64; shift += 7)
+            {
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), in.empty());
+                const auto byte = static_cast<uint8_t>(in.front());
+                in.remove_prefix(1);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (byte < 0x80)
+                {
+                    return value;
+                }
+            }
+            THROW_HR(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+    }
+
+    // Appends records to a new file. Write() may be called from multiple threads.
+    class RecordingWriter
+    {
+    public:
+        explicit RecordingWriter(const std::wstring& path) :
+            _file{ CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) },
+            _start{ std::chrono::steady_clock::now() }
+        {
+            THROW_LAST_ERROR_IF(!_file);
+            _write(Magic);
+        }
+
+        void Write(const RecordType type, const std::string_view& payload)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const std::lock_guard lock{ _mutex };
+
+            // Deltas are computed from the absolute time, so that rounding errors don't accumulate.
+            const auto timestamp = gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - _start).count());
+            const auto delta = timestamp - std::min(timestamp, _lastTimestamp);
+            _lastTimestamp = std::max(timestamp, _lastTimestamp);
+
+            _buffer.clear();
+            _buffer.push_back(static_cast<char>(type));
+            details::appendVarint(_buffer, delta);
+            details::appendVarint(_buffer, payload.size());
+            _buffer.append(payload);
+            _write(_buffer);
+        }
+
+        void WriteResize(const uint32_t rows, const uint32_t columns)
+        {
+            std::string payload;
+            details::appendVarint(payload, rows);
+            details::appendVarint(payload, columns);
+            Write(RecordType::Resize, payload);
+        }
+
+    private:
+        void _write(const std::string_view& data) const
+        {
+            DWORD written = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &written, nullptr));
+        }
+
+        wil::unique_hfile _file;
+        std::chrono::steady_clock::time_point _start;
+        uint64_t _lastTimestamp = 0;
+        std::string _buffer;
+        std::mutex _mutex;
+    };
+
+    // Parses a recording that was loaded into memory in its entirety.
+    // The returned payloads point into that memory.
+    class RecordingReader
+    {
+    public:
+        static std::string LoadFile(const std::wstring& path)
+        {
+            wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+
+            LARGE_INTEGER size{};
+            THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+
+            std::string data;
+            data.resize(gsl::narrow<size_t>(size.QuadPart));
+
+            // ReadFile can only read up to 4GB at once.
+            size_t offset = 0;
+            while (offset < data.size())
+            {
+                DWORD read = 0;
+                const auto remaining = gsl::narrow_cast<DWORD>(std::min<size_t>(data.size() - offset, 1u << 30));
+                THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), data.data() + offset, remaining, &read, nullptr));
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), read == 0);
+                offset += read;
+            }
+
+            return data;
+        }
+
+        explicit RecordingReader(std::string_view data) :
+            _remaining{ data }
+        {
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), !_remaining.starts_with(Magic));
+            _remaining.remove_prefix(Magic.size());
+        }
+
+        // Returns the next record, or nullopt at the end of the recording.
+        // Throws if the recording is truncated.
+        std::optional<Record> Next()
+        {
+            if (_remaining.empty())
+            {
+                return std::nullopt;
+            }
+
+            const auto type = static_cast<RecordType>(_remaining.front());
+            _remaining.remove_prefix(1);
+            _timestamp += std::chrono::microseconds{ details::consumeVarint(_remaining) };
+            const auto length = details::consumeVarint(_remaining);
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), length > _remaining.size());
+
+            const auto payload = _remaining.substr(0, gsl::narrow_cast<size_t>(length));
+            _remaining.remove_prefix(payload.size());
+            return Record{ type, _timestamp, payload };
+        }
+
+        // Returns the rows and columns stored in the payload of a Resize record.
+        static std::pair<uint32_t, uint32_t> ParseResize(std::string_view payload)
+        {
+            const auto rows = details::consumeVarint(payload);
+            const auto columns = details::consumeVarint(payload);
+            return { gsl::narrow<uint32_t>(rows), gsl::narrow<uint32_t>(columns) };
+        }
+
+    private:
+        std::string_view _remaining;
+        std::chrono::microseconds _timestamp{};
+    };
+}
@@ -77,6 +77,10 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
         {
             return S_FALSE;
         }
+
+        // The state machine writes each key and sequence to the input buffer individually.
+        // Wake up waiting readers only once the entire chunk has been processed.
+        const auto batch = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveInputBuffer()->BatchWakeups();
         _pInputStateMachine->ProcessString(wstr);
     }
     CATCH_RETURN();
@@ -107,7 +111,8 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
+    // Large enough to turn pastes into a few large batches instead of many small ones.
+    char buffer[4096];
     DWORD dwRead = 0;
     auto fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
 
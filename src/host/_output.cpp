@@ -88,10 +88,11 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
         return E_INVALIDARG;
     }
 
-    const OutputCellIterator it(attrs);
-    const auto done = screenInfo.Write(it, target);
-
-    used = done.GetCellDistance(it);
+    try
+    {
+        used = screenInfo.GetTextBuffer().WriteAttributes(target, attrs);
+    }
+    CATCH_RETURN();
 
     return S_OK;
 }
@@ -130,9 +131,7 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
 
     try
     {
-        OutputCellIterator it(chars);
-        const auto finished = screenInfo.Write(it, target);
-        used = finished.GetInputDistance(it);
+        used = screenInfo.GetTextBuffer().WriteText(target, chars);
     }
     CATCH_RETURN();
 
@@ -215,12 +214,9 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
 
     try
     {
-        TextAttribute useThisAttr(attribute);
-        const OutputCellIterator it(useThisAttr, lengthToWrite);
-        const auto done = screenBuffer.Write(it, startingCoordinate);
-        const auto cellsModifiedCoord = done.GetCellDistance(it);
-
-        cellsModified = cellsModifiedCoord;
+        const TextAttribute useThisAttr(attribute);
+        cellsModified = screenBuffer.GetTextBuffer().FillAttributes(startingCoordinate, useThisAttr, lengthToWrite);
+        const auto cellsModifiedCoord = gsl::narrow_cast<til::CoordType>(cellsModified);
 
         if (screenBuffer.HasAccessibilityEventing())
         {
@@ -277,14 +273,10 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
     auto hr = S_OK;
     try
     {
-        const OutputCellIterator it(character, lengthToWrite);
-
         // when writing to the buffer, specifically unset wrap if we get to the last column.
         // a fill operation should UNSET wrap in that scenario. See GH #1126 for more details.
-        const auto done = screenInfo.Write(it, startingCoordinate, false);
-        const auto cellsModifiedCoord = done.GetInputDistance(it);
-
-        cellsModified = cellsModifiedCoord;
+        cellsModified = screenInfo.GetTextBuffer().FillText(startingCoordinate, character, lengthToWrite, false);
+        const auto cellsModifiedCoord = gsl::narrow_cast<til::CoordType>(cellsModified);
 
         // Notify accessibility
         if (screenInfo.HasAccessibilityEventing())
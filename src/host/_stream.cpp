@@ -145,6 +145,7 @@ static void _writeCharsLegacyUnprocessed(SCREEN_INFORMATION& screenInfo, const s
     RowWriteState state{
         .text = text,
         .columnLimit = textBuffer.GetSize().RightExclusive(),
+        .joinPrecedingGlyph = true,
     };
 
     while (!state.text.empty())
@@ -415,6 +416,69 @@ NT_CATCH_RETURN()
     CATCH_RETURN();
 }
 
+// Routine Description:
+// - Widens the given text into `out` if it consists of 7-bit ASCII only.
+// - This doesn't depend on any console state and can thus be done before acquiring the console lock.
+// Arguments:
+// - text - char/byte text buffer provided by the client application
+// - out - receives the widened text. Its contents are unspecified if this function returns false.
+// Return Value:
+// - true if `text` was pure ASCII and `out` holds its UTF-16 equivalent.
+static bool _tryWidenAscii(const std::string_view& text, std::wstring& out)
+{
+    out.resize(text.size());
+
+    // Process the text in chunks so that we can bail out early for non-ASCII text,
+    // while keeping the inner loop simple enough for the compiler to vectorize it.
+    static constexpr size_t chunkSize = 64;
+    auto dst = out.data();
+
+    for (size_t beg = 0; beg < text.size(); beg += chunkSize)
+    {
+        const auto end = std::min(beg + chunkSize, text.size());
+        uint8_t accumulator = 0;
+
+        for (auto i = beg; i < end; ++i)
+        {
+            const auto ch = gsl::narrow_cast<uint8_t>(til::at(text, i));
+            accumulator |= ch;
+            til::at(dst, i) = ch;
+        }
+
+        if (accumulator >= 0x80)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - Returns true if the given codepage maps the 7-bit ASCII range 1:1 onto U+0000 to U+007F.
+// - That's the case for almost all codepages, but not for EBCDIC codepages or UTF-7 for instance.
+// - NOTE: Call under LockConsole(). The result for the last codepage is cached.
+static bool _isAsciiTransparentCodepage(const UINT codepage)
+{
+    static UINT cachedCodepage = CP_UTF8;
+    static bool cachedResult = true;
+
+    if (codepage != cachedCodepage)
+    {
+        char ascii[128];
+        wchar_t wide[128];
+        std::iota(std::begin(ascii), std::end(ascii), '\0');
+
+        const auto length = MultiByteToWideChar(codepage, 0, &ascii[0], 128, &wide[0], 128);
+        cachedResult = length == 128 && std::equal(std::begin(ascii), std::end(ascii), std::begin(wide), [](char a, wchar_t w) {
+                           return static_cast<wchar_t>(a) == w;
+                       });
+        cachedCodepage = codepage;
+    }
+
+    return cachedResult;
+}
+
 // Routine Description:
 // - Writes non-Unicode formatted data into the given console output object.
 // - This method will convert from the given input into wide characters before chain calling the wide character version of the function.
@@ -446,6 +510,23 @@ NT_CATCH_RETURN()
             return S_OK;
         }
 
+        // The conversion buffer is kept around between calls, because chatty clients tend to call
+        // WriteFile once per line and would otherwise pay for an allocation every single time.
+        // Only the IO thread calls into here, so it doesn't need the console lock. We only
+        // need to make sure that a single huge write doesn't pin a lot of memory forever.
+        auto& wstr{ context.WriteConsoleAScratch };
+        const auto trimScratch = wil::scope_exit([&]() noexcept {
+            if (wstr.capacity() > SCREEN_INFORMATION::WriteConsoleAScratchRetainedCapacity)
+            {
+                wstr = std::wstring{};
+            }
+        });
+
+        // Most text written by applications is pure ASCII. Widening it is independent of the
+        // codepage and any partial sequences, so we do it before acquiring the console lock
+        // and check whether the result can actually be used once we're holding it.
+        const auto isAscii{ _tryWidenAscii(buffer, wstr) };
+
         LockConsole();
         auto unlock{ wil::scope_exit([&] { UnlockConsole(); }) };
 
@@ -454,11 +535,27 @@ NT_CATCH_RETURN()
         const auto codepage{ consoleInfo.OutputCP };
         auto leadByteCaptured{ false };
         auto leadByteConsumed{ false };
-        std::wstring wstr{};
         static til::u8state u8State{};
 
+        // The widened ASCII can be used as-is, unless a partial UTF-8 sequence or
+        // DBCS lead byte from a previous call needs to be completed first.
+        const auto useAscii{ isAscii && (codepage == CP_UTF8 ? u8State.have == 0 : screenInfo.WriteConsoleDbcsLeadByte[0] == 0 && _isAsciiTransparentCodepage(codepage)) };
+
         // Convert our input parameters to Unicode
-        if (codepage == CP_UTF8)
+        if (useAscii)
+        {
+            if (codepage == CP_UTF8)
+            {
+                read = buffer.size();
+            }
+            else
+            {
+                // In case the codepage changes from UTF-8 to another,
+                // we discard partials that might still be cached.
+                u8State.reset();
+            }
+        }
+        else if (codepage == CP_UTF8)
         {
             RETURN_IF_FAILED(til::u8u16(buffer, wstr, u8State));
             read = buffer.size();
@@ -551,7 +648,12 @@ NT_CATCH_RETURN()
         {
             // Calculate how many bytes of the original A buffer were consumed in the W version of the call to satisfy mbBufferRead.
             // For UTF-8 conversions, we've already returned this information above.
-            if (CP_UTF8 != codepage)
+            if (useAscii)
+            {
+                // ASCII maps 1:1 between bytes and UTF-16 code units.
+                read = wcBufferWritten;
+            }
+            else if (CP_UTF8 != codepage)
             {
                 size_t mbBufferRead{};
 
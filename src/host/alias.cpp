@@ -19,9 +19,12 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
+// Both of these are transparent, so that aliases can be looked up with a std::wstring_view.
 struct case_insensitive_hash
 {
-    std::size_t operator()(const std::wstring& key) const
+    using is_transparent = void;
+
+    std::size_t operator()(const std::wstring_view& key) const
     {
         til::hasher h;
         for (const auto& ch : key)
@@ -34,21 +37,26 @@ struct case_insensitive_hash
 
 struct case_insensitive_equality
 {
-    bool operator()(const std::wstring& lhs, const std::wstring& rhs) const
+    using is_transparent = void;
+
+    bool operator()(const std::wstring_view& lhs, const std::wstring_view& rhs) const
     {
-        return 0 == _wcsicmp(lhs.data(), rhs.data());
+        return lhs.size() == rhs.size() && 0 == _wcsnicmp(lhs.data(), rhs.data(), lhs.size());
     }
 };
 
 std::unordered_map<std::wstring,
                    std::unordered_map<std::wstring,
-                                      std::wstring,
+                                      Alias::CompiledTarget,
                                       case_insensitive_hash,
                                       case_insensitive_equality>,
                    case_insensitive_hash,
                    case_insensitive_equality>
     g_aliasData;
 
+// The text of the last expanded alias. It's reused so that expanding an alias doesn't allocate.
+std::wstring g_aliasExpansion;
+
 // Routine Description:
 // - Adds a command line alias to the global set.
 // - Converts and calls the W version of this function.
@@ -114,7 +122,7 @@ std::unordered_map<std::wstring,
         else
         {
             // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
+            g_aliasData[exeNameString][sourceString] = Alias::s_CompileTarget(std::move(targetString));
         }
     }
     CATCH_RETURN();
@@ -149,17 +157,14 @@ std::unordered_map<std::wstring,
         til::at(*target, 0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-    std::wstring sourceString(source);
-
     // For compatibility, return ERROR_GEN_FAILURE for any result where the alias can't be found.
     // We use .find for the iterators then dereference to search without creating entries.
-    const auto exeIter = g_aliasData.find(exeNameString);
+    const auto exeIter = g_aliasData.find(exeName);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
-    const auto sourceIter = exeData.find(sourceString);
+    const auto& exeData = exeIter->second;
+    const auto sourceIter = exeData.find(source);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto& targetString = sourceIter->second.text;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -315,8 +320,6 @@ static std::wstring aliasesSeparator(L"=");
 
     try
     {
-        const std::wstring exeNameString(exeName);
-
         size_t cchNeeded = 0;
 
         // Each of the aliases will be made up of the source, a separator, the target, then a null character.
@@ -330,21 +333,20 @@ static std::wstring aliasesSeparator(L"=");
         }
 
         // Find without creating.
-        auto exeIter = g_aliasData.find(exeNameString);
+        const auto exeIter = g_aliasData.find(exeName);
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
-            for (auto& pair : list)
+            for (const auto& pair : exeIter->second)
             {
                 // Alias stores lengths in bytes.
                 auto cchSource = pair.first.size();
-                auto cchTarget = pair.second.size();
+                auto cchTarget = pair.second.text.size();
 
                 // If we're counting how much multibyte space will be needed, trial convert the source and target strings before we add.
                 if (!countInUnicode)
                 {
                     cchSource = GetALengthFromW(codepage, pair.first);
-                    cchTarget = GetALengthFromW(codepage, pair.second);
+                    cchTarget = GetALengthFromW(codepage, pair.second.text);
                 }
 
                 // Accumulate all sizes to the final string count.
@@ -451,8 +453,6 @@ void Alias::s_ClearCmdExeAliases()
         til::at(*aliasBuffer, 0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-
     auto AliasesBufferPtrW = aliasBuffer.has_value() ? aliasBuffer->data() : nullptr;
     size_t cchTotalLength = 0; // accumulate the characters we need/have copied as we walk the list
 
@@ -461,15 +461,14 @@ void Alias::s_ClearCmdExeAliases()
     const size_t cchNull = 1;
 
     // Find without creating.
-    auto exeIter = g_aliasData.find(exeNameString);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
-        for (auto& pair : list)
+        for (const auto& pair : exeIter->second)
         {
             // Alias stores lengths in bytes.
             const auto cchSource = pair.first.size();
-            const auto cchTarget = pair.second.size();
+            const auto cchTarget = pair.second.text.size();
 
             // Add up how many characters we will need for the full alias data.
             size_t cchNeeded = 0;
@@ -499,7 +498,7 @@ void Alias::s_ClearCmdExeAliases()
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, aliasesSeparator.size(), &cchAliasBufferRemaining));
                 AliasesBufferPtrW += aliasesSeparator.size();
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.data(), cchTarget));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.text.data(), cchTarget));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchTarget, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchTarget;
 
@@ -912,7 +911,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring& fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1024,58 +1023,50 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Parses the macros out of an alias target, so that they don't need to be
+//   searched for each time the alias is used.
+// - Macros that don't depend on the arguments are substituted right away.
+//   Argument macros ($1-$9 and $*) end the current literal span and are
+//   substituted by s_ExpandTarget.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - text - The target text as it was given to AddConsoleAlias.
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The compiled target, including the number of commands in it (line feeds, CRLFs)
+Alias::CompiledTarget Alias::s_CompileTarget(std::wstring text)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    CompiledTarget compiled;
+    auto& literals = compiled.literals;
+    literals.reserve(text.size() + 2);
+
+    size_t spanBegin = 0;
+    const auto endSpan = [&](const wchar_t argMacro) {
+        compiled.ops.push_back({ spanBegin, literals.size() - spanBegin, argMacro });
+        spanBegin = literals.size();
+    };
 
     // The target text may contain substitution macros indicated by $.
-    // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    // Walk through and substitute the ones that we can.
+    for (auto ch = text.cbegin(); ch < text.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < text.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
+                if ((*chNext >= L'1' && *chNext <= L'9') || L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
+                    endSpan(*chNext);
                 }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
-                }
-                if (!isProcessed)
+                else if (!s_TryReplaceInputRedirMacro(*chNext, literals) &&
+                         !s_TryReplaceOutputRedirMacro(*chNext, literals) &&
+                         !s_TryReplacePipeRedirMacro(*chNext, literals) &&
+                         !s_TryReplaceNextCommandMacro(*chNext, literals, compiled.lineCount))
                 {
                     // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
+                    literals.push_back(*ch);
+                    literals.push_back(*chNext);
                 }
 
                 // Since we read ahead and used that character,
@@ -1085,22 +1076,49 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
             else
             {
                 // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
+                literals.push_back(*ch);
             }
         }
         else
         {
             // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            literals.push_back(*ch);
         }
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(literals, compiled.lineCount);
+    endSpan(0);
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    compiled.text = std::move(text);
+    return compiled;
+}
+
+// Routine Description:
+// - Produces the final text of an alias by substituting the arguments into its compiled target.
+// Arguments:
+// - target - The compiled alias target.
+// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
+// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - finalText - Receives the expanded text. Its previous contents are discarded, but its capacity is reused.
+void Alias::s_ExpandTarget(const CompiledTarget& target,
+                           const std::deque<std::wstring>& tokens,
+                           const std::wstring& fullArgString,
+                           std::wstring& finalText)
+{
+    // Each argument macro expands to at most the full argument string.
+    finalText.clear();
+    finalText.reserve(target.literals.size() + (target.ops.size() - 1) * fullArgString.size());
+
+    for (const auto& op : target.ops)
+    {
+        finalText.append(target.literals, op.literalBegin, op.literalLength);
+
+        if (op.argMacro != 0 && !s_TryReplaceNumberedArgMacro(op.argMacro, finalText, tokens))
+        {
+            s_TryReplaceWildcardArgMacro(op.argMacro, finalText, fullArgString);
+        }
+    }
 }
 
 // Routine Description:
@@ -1112,22 +1130,23 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
 // Return Value:
 // - If we found a matching alias, this will be the processed data
 //   and lineCount is updated to the new number of lines.
+//   The text is only valid until the next call, since the same buffer is reused for every expansion.
 // - If we didn't match and process an alias, return an empty string.
-std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount)
+std::wstring_view Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount)
 {
     // Check if we have an EXE in the list that matches the request first.
     auto exeIter = g_aliasData.find(exeName);
     if (exeIter == g_aliasData.end())
     {
         // We found no data for this exe. Give back an empty string.
-        return std::wstring();
+        return {};
     }
 
-    auto exeList = exeIter->second;
+    const auto& exeList = exeIter->second;
     if (exeList.size() == 0)
     {
         // If there's no match, give back an empty string.
-        return std::wstring();
+        return {};
     }
 
     // Tokenize the text by spaces
@@ -1136,32 +1155,31 @@ std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std:
     // If there are no tokens, return an empty string
     if (tokens.size() == 0)
     {
-        return std::wstring();
+        return {};
     }
 
     // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
+    const auto& alias = tokens.front();
     const auto aliasIter = exeList.find(alias);
     if (aliasIter == exeList.end())
     {
         // We found no alias pair with this name. Give back an empty string.
-        return std::wstring();
+        return {};
     }
 
     const auto& target = aliasIter->second;
-    if (target.size() == 0)
+    if (target.text.size() == 0)
     {
-        return std::wstring();
+        return {};
     }
 
     // Get the string of all parameters as a shorthand for $* later.
     const auto allParams = s_GetArgString(sourceText);
 
     // The final text will be the target but with macros replaced.
-    auto finalText = target;
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
-
-    return finalText;
+    lineCount = target.lineCount;
+    s_ExpandTarget(target, tokens, allParams, g_aliasExpansion);
+    return g_aliasExpansion;
 }
 
 #ifdef UNIT_TESTING
@@ -1169,7 +1187,7 @@ void Alias::s_TestAddAlias(std::wstring& exe,
                            std::wstring& alias,
                            std::wstring& target)
 {
-    g_aliasData[exe][alias] = target;
+    g_aliasData[exe][alias] = s_CompileTarget(target);
 }
 
 void Alias::s_TestClearAliases()
@@ -14,23 +14,43 @@ Abstract:
 class Alias
 {
 public:
+    // An alias target with its macros already parsed: A sequence of literal text spans, each optionally
+    // followed by an argument macro ($1-$9 or $*). Macros that don't depend on the arguments
+    // ($L, $G, $B, $T and unknown ones) were already substituted into the literal text.
+    struct CompiledTarget
+    {
+        struct Op
+        {
+            size_t literalBegin = 0;
+            size_t literalLength = 0;
+            wchar_t argMacro = 0; // 0 if the span isn't followed by an argument macro.
+        };
+
+        std::wstring text; // The target as it was given to AddConsoleAlias.
+        std::wstring literals;
+        std::vector<Op> ops;
+        size_t lineCount = 0;
+    };
+
     static void s_ClearCmdExeAliases();
 
-    static std::wstring s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount);
+    static CompiledTarget s_CompileTarget(std::wstring text);
+    static std::wstring_view s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount);
 
 private:
     static std::deque<std::wstring> s_Tokenize(const std::wstring_view str);
     static std::wstring s_GetArgString(const std::wstring_view str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    static void s_ExpandTarget(const CompiledTarget& target,
+                               const std::deque<std::wstring>& tokens,
+                               const std::wstring& fullArgString,
+                               std::wstring& finalText);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
                                              const std::deque<std::wstring>& tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring& fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
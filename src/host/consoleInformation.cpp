@@ -23,10 +23,24 @@ bool CONSOLE_INFORMATION::IsConsoleLocked() const noexcept
     return _lock.is_locked();
 }
 
+// Routine Description:
+// - Locks the console. If that has to wait for another thread, the wait time
+//   gets reported via the "ConsoleLockContention" trace event.
+//   Uncontended acquisitions don't pay for reading the clock.
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole() noexcept
 {
-    _lock.lock();
+    if (!_lock.try_lock())
+    {
+        const auto start = std::chrono::steady_clock::now();
+        _lock.lock();
+        const auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        // These are only modified while holding the lock.
+        _lockContentions++;
+        _lockWaitTime += waitTime;
+        Tracing::s_TraceConsoleLockContention(waitTime, _lockContentions, _lockWaitTime);
+    }
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
@@ -470,7 +470,6 @@ CATCH_RETURN();
 {
     try
     {
-        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         const auto& storageBuffer = context.GetActiveBuffer().GetTextBuffer();
         const auto storageSize = storageBuffer.GetSize().Dimensions();
 
@@ -505,44 +504,20 @@ CATCH_RETURN();
         // The final "request rectangle" or the area inside the buffer we want to read, is the clipped dimensions.
         const auto clippedRequestRectangle = Viewport::FromExclusive(clip);
 
-        // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
-        const auto sourcePoint = clippedRequestRectangle.Origin();
-
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        til::point targetPos;
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Copy the clipped request a row at a time. Each row of the request maps onto a contiguous
+        // slice of the user's buffer, offset by targetPoint if we clipped away negative coordinates.
+        // The user's buffer may be smaller than the request, in which case we stop once it's full.
+        const auto width = gsl::narrow_cast<size_t>(std::max(0, clip.right - clip.left));
+        for (auto y = clip.top; y < clip.bottom && width != 0; ++y)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            const auto offset = gsl::narrow_cast<size_t>((targetPoint.y + y - clip.top) * targetSize.width + targetPoint.x);
+            if (offset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                ++sourceIter;
+                break;
             }
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            ++targetIter;
-
-            // Increment the target
-            targetPos.x++;
-            if (targetPos.x >= targetSize.width)
-            {
-                targetPos.x = 0;
-                targetPos.y++;
-            }
+            const auto count = std::min(width, targetBuffer.size() - offset);
+            storageBuffer.ReadCharInfos({ clip.left, y }, targetBuffer.subspan(offset, count));
         }
 
         // Reply with the region we read out of the backing buffer (potentially clipped)
@@ -686,9 +661,8 @@ CATCH_RETURN();
             // Convert to a CHAR_INFO view to fit into the iterator
             const auto charInfos = std::span<const CHAR_INFO>(subspan.data(), subspan.size());
 
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            // Write the row segment to the target position.
+            storageBuffer.GetTextBuffer().WriteCharInfos(target, charInfos);
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
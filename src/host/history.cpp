@@ -31,6 +31,8 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 // If CommandHistory::s_Allocate and friends stop shuffling elements
 // for maintaining LRU, then this datatype can be changed.
 std::list<CommandHistory> CommandHistory::s_historyLists;
+std::unordered_multimap<std::wstring, CommandHistory*> CommandHistory::s_historiesByExe;
+uint64_t CommandHistory::s_mruSequence = 0;
 
 CommandHistory* CommandHistory::s_Find(const HANDLE processHandle)
 {
@@ -120,6 +122,7 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if (GetNumberOfCommands() == _maxCommands)
             {
+                _IndexErase(0);
                 _commands.erase(_commands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
@@ -135,6 +138,7 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexInsert(GetNumberOfCommands() - 1);
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -211,6 +215,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _sortedCommands.clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -244,6 +249,7 @@ void CommandHistory::Realloc(const Index commands)
     }
 
     _commands.resize(std::min(_commands.size(), gsl::narrow_cast<size_t>(std::max(0, commands))));
+    _IndexTruncate(GetNumberOfCommands());
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = GetNumberOfCommands() - 1;
@@ -259,22 +265,28 @@ void CommandHistory::s_ReallocExeToFront(const std::wstring_view appName, const
         if (WI_IsFlagSet(it->Flags, CLE_ALLOCATED) && it->IsAppNameMatch(appName))
         {
             it->Realloc(size);
+            it->_MarkMostRecentlyUsed();
             s_historyLists.splice(s_historyLists.begin(), s_historyLists, it);
             return;
         }
     }
 }
 
+// Routine Description:
+// - Returns the most recently used, allocated history for the given app name.
 CommandHistory* CommandHistory::s_FindByExe(const std::wstring_view appName)
 {
-    for (auto& historyList : s_historyLists)
+    CommandHistory* found = nullptr;
+    const auto [beg, end] = s_historiesByExe.equal_range(s_ExeKey(appName));
+    for (auto it = beg; it != end; ++it)
     {
-        if (WI_IsFlagSet(historyList.Flags, CLE_ALLOCATED) && historyList.IsAppNameMatch(appName))
+        const auto history = it->second;
+        if (WI_IsFlagSet(history->Flags, CLE_ALLOCATED) && (!found || history->_mruSequence > found->_mruSequence))
         {
-            return &historyList;
+            found = history;
         }
     }
-    return nullptr;
+    return found;
 }
 
 size_t CommandHistory::s_CountOfHistories()
@@ -323,7 +335,10 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         History.LastDisplayed = -1;
         History._maxCommands = gsl::narrow<Index>(gci.GetHistoryBufferSize());
         History._processHandle = processHandle;
-        return &s_historyLists.emplace_front(History);
+        History._MarkMostRecentlyUsed();
+        auto& allocated = s_historyLists.emplace_front(History);
+        allocated._RegisterExe();
+        return &allocated;
     }
 
     // If we have no candidate already and we need one,
@@ -349,11 +364,15 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_sortedCommands.clear();
             BestCandidate->LastDisplayed = -1;
+            BestCandidate->_UnregisterExe();
             BestCandidate->_appName = appName;
+            BestCandidate->_RegisterExe();
         }
 
         BestCandidate->_processHandle = processHandle;
+        BestCandidate->_MarkMostRecentlyUsed();
         WI_SetFlag(BestCandidate->Flags, CLE_ALLOCATED);
 
         // move to the front of the list
@@ -412,6 +431,7 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return {};
     }
 
+    _IndexErase(iDel);
     const auto str = std::move(_commands.at(iDel));
     _commands.erase(_commands.begin() + iDel);
 
@@ -455,31 +475,128 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return true;
     }
 
-    try
+    if (indexFound < 0 || indexFound >= GetNumberOfCommands())
     {
-        for (size_t i = 0; i < _commands.size(); i++)
-        {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
-            {
-                if (til::starts_with(storedCommand, givenCommand))
-                {
-                    return true;
-                }
-            }
+        return false;
+    }
+
+    // All matching commands form a contiguous range in _sortedCommands.
+    const auto exact = WI_IsFlagSet(options, MatchOptions::ExactMatch);
+    const auto beg = std::lower_bound(_sortedCommands.begin(), _sortedCommands.end(), givenCommand, [&](const Index lhs, const std::wstring_view& rhs) {
+        const std::wstring_view command{ til::at(_commands, lhs) };
+        return (exact ? command : command.substr(0, rhs.size())) < rhs;
+    });
+    const auto end = std::upper_bound(beg, _sortedCommands.end(), givenCommand, [&](const std::wstring_view& lhs, const Index rhs) {
+        const std::wstring_view command{ til::at(_commands, rhs) };
+        return lhs < (exact ? command : command.substr(0, lhs.size()));
+    });
+
+    // We're looking for the first match when walking backwards from indexFound and wrapping around at the
+    // beginning. That's the largest matching index <= indexFound, or otherwise the largest matching index.
+    Index before = -1;
+    Index after = -1;
+    for (auto it = beg; it != end; ++it)
+    {
+        auto& best = *it <= indexFound ? before : after;
+        best = std::max(best, *it);
+    }
+
+    const auto found = before >= 0 ? before : after;
+    if (found < 0)
+    {
+        return false;
+    }
+
+    indexFound = found;
+    return true;
+}
+
+// Returns true if the command at lhs sorts before the one at rhs in _sortedCommands.
+bool CommandHistory::_IndexLess(const Index lhs, const Index rhs) const noexcept
+{
+    const std::wstring_view l{ til::at(_commands, lhs) };
+    const std::wstring_view r{ til::at(_commands, rhs) };
+    const auto cmp = l.compare(r);
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+// Returns the position of the given index in _sortedCommands, or end() if it's not indexed.
+std::vector<CommandHistory::Index>::iterator CommandHistory::_IndexFind(const Index index) noexcept
+{
+    const auto it = std::lower_bound(_sortedCommands.begin(), _sortedCommands.end(), index, [&](const Index lhs, const Index rhs) {
+        return _IndexLess(lhs, rhs);
+    });
+    return it != _sortedCommands.end() && *it == index ? it : _sortedCommands.end();
+}
+
+// Adds the command at the given index to _sortedCommands, which mustn't contain it yet.
+void CommandHistory::_IndexInsert(const Index index)
+{
+    const auto it = std::upper_bound(_sortedCommands.begin(), _sortedCommands.end(), index, [&](const Index lhs, const Index rhs) {
+        return _IndexLess(lhs, rhs);
+    });
+    _sortedCommands.insert(it, index);
+}
+
+// Removes the command at the given index from _sortedCommands, in preparation of it being erased from _commands.
+void CommandHistory::_IndexErase(const Index index) noexcept
+{
+    const auto it = _IndexFind(index);
+    if (it != _sortedCommands.end())
+    {
+        _sortedCommands.erase(it);
+    }
 
-            _Prev(indexFound);
+    // Shifting all following indices down by one doesn't change their relative order.
+    for (auto& i : _sortedCommands)
+    {
+        if (i > index)
+        {
+            --i;
         }
     }
-    CATCH_LOG();
+}
 
-    return false;
+// Removes all indices >= count from _sortedCommands, after _commands was shrunk to count items.
+void CommandHistory::_IndexTruncate(const Index count) noexcept
+{
+    std::erase_if(_sortedCommands, [=](const Index i) { return i >= count; });
+}
+
+// Returns the key under which histories for the given app name are stored in s_historiesByExe.
+// IsAppNameMatch() compares app names ordinally, ignoring case, which is equivalent to
+// comparing them after converting both to uppercase with the invariant casing table.
+std::wstring CommandHistory::s_ExeKey(const std::wstring_view appName)
+{
+    std::wstring key{ appName };
+    if (!key.empty())
+    {
+        const auto size = gsl::narrow<int>(key.size());
+        THROW_LAST_ERROR_IF(0 == LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, appName.data(), size, key.data(), size, nullptr, nullptr, 0));
+    }
+    return key;
+}
+
+void CommandHistory::_RegisterExe()
+{
+    s_historiesByExe.emplace(s_ExeKey(_appName), this);
+}
+
+void CommandHistory::_UnregisterExe() noexcept
+{
+    std::erase_if(s_historiesByExe, [this](const auto& entry) { return entry.second == this; });
+}
+
+void CommandHistory::_MarkMostRecentlyUsed() noexcept
+{
+    _mruSequence = ++s_mruSequence;
 }
 
 #ifdef UNIT_TESTING
 void CommandHistory::s_ClearHistoryListStorage()
 {
     s_historyLists.clear();
+    s_historiesByExe.clear();
 }
 #endif
 
@@ -495,7 +612,12 @@ void CommandHistory::Swap(const Index indexA, const Index indexB)
         indexA >= 0 && indexA < num &&
         indexB >= 0 && indexB < num)
     {
+        // Both entries have to be re-sorted, since they now refer to different commands.
+        _sortedCommands.erase(_IndexFind(indexA));
+        _sortedCommands.erase(_IndexFind(indexB));
         std::swap(_commands.at(indexA), _commands.at(indexB));
+        _IndexInsert(indexA);
+        _IndexInsert(indexB);
     }
 }
 
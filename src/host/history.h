@@ -65,6 +65,17 @@ public:
 private:
     void _Reset();
 
+    bool _IndexLess(Index lhs, Index rhs) const noexcept;
+    std::vector<Index>::iterator _IndexFind(Index index) noexcept;
+    void _IndexInsert(Index index);
+    void _IndexErase(Index index) noexcept;
+    void _IndexTruncate(Index count) noexcept;
+
+    static std::wstring s_ExeKey(const std::wstring_view appName);
+    void _RegisterExe();
+    void _UnregisterExe() noexcept;
+    void _MarkMostRecentlyUsed() noexcept;
+
     // _Next and _Prev go to the next and prev command
     // _Inc  and _Dec go to the next and prev slots
     // Don't get the two confused - it matters when the cmd history is not full!
@@ -78,10 +89,20 @@ private:
     std::vector<std::wstring> _commands;
     Index _maxCommands = 0;
 
+    // Indices into _commands, sorted by the command they refer to (and by index for equal commands).
+    // All commands starting with a given prefix form a contiguous range in here, which allows
+    // FindMatchingCommand() to skip the commands that don't match without comparing them.
+    std::vector<Index> _sortedCommands;
+
     std::wstring _appName;
     HANDLE _processHandle = nullptr;
+    // Larger values were moved to the front of s_historyLists more recently.
+    uint64_t _mruSequence = 0;
 
     static std::list<CommandHistory> s_historyLists;
+    // Maps the case-folded app name to all histories that use it.
+    static std::unordered_multimap<std::wstring, CommandHistory*> s_historiesByExe;
+    static uint64_t s_mruSequence;
 
 public:
     DWORD Flags = 0;
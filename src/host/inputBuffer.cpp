@@ -7,6 +7,8 @@
 #include "stream.h"
 #include "../types/inc/GlyphWidth.hpp"
 
+#include <bit>
+
 #include <til/bytes.h>
 
 #include "misc.h"
@@ -156,16 +158,10 @@ size_t InputBuffer::ConsumeCached(bool isUnicode, size_t count, InputEventQueue&
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
-
-    while (i < count && !_cachedInputEvents.empty())
-    {
-        target.push_back(std::move(_cachedInputEvents.front()));
-        _cachedInputEvents.pop_front();
-        i++;
-    }
-
-    return i;
+    const auto n = std::min(count, _cachedInputEvents.size());
+    _cachedInputEvents.copy_to(target, n);
+    _cachedInputEvents.pop_front(n);
+    return n;
 }
 
 // Copies up to `count`, previously cached events into `target`.
@@ -173,20 +169,9 @@ size_t InputBuffer::PeekCached(bool isUnicode, size_t count, InputEventQueue& ta
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
-
-    for (const auto& e : _cachedInputEvents)
-    {
-        if (i >= count)
-        {
-            break;
-        }
-
-        target.push_back(e);
-        i++;
-    }
-
-    return i;
+    const auto n = std::min(count, _cachedInputEvents.size());
+    _cachedInputEvents.copy_to(target, n);
+    return n;
 }
 
 // Trims `source` to have a size below or equal to `expectedSourceSize` by
@@ -197,10 +182,7 @@ void InputBuffer::Cache(bool isUnicode, InputEventQueue& source, size_t expected
 
     if (source.size() > expectedSourceSize)
     {
-        _cachedInputEvents.insert(
-            _cachedInputEvents.end(),
-            std::make_move_iterator(source.begin() + expectedSourceSize),
-            std::make_move_iterator(source.end()));
+        _cachedInputEvents.append({ source.data() + expectedSourceSize, source.size() - expectedSourceSize });
         source.resize(expectedSourceSize);
     }
 }
@@ -221,7 +203,7 @@ void InputBuffer::_switchReadingModeSlowPath(ReadingMode mode)
     _cachedTextW = std::wstring{};
     _cachedTextReaderW = {};
 
-    _cachedInputEvents = std::deque<INPUT_RECORD>{};
+    _cachedInputEvents.clear();
 
     _readingMode = mode;
 }
@@ -284,9 +266,34 @@ void InputBuffer::ReinitializeInputBuffer()
 // - None
 void InputBuffer::WakeUpReadersWaitingForData()
 {
+    if (_wakeupBatchDepth)
+    {
+        _wakeupPending = true;
+        return;
+    }
+
+    _stats.wakeups++;
     WaitQueue.NotifyWaiters(false);
 }
 
+// Routine Description:
+// - Ends a batch started by BatchWakeups(). If any writes happened during the
+//   outermost batch, waiting readers are woken up exactly once.
+// Arguments:
+// - None
+// Return Value:
+// - None
+void InputBuffer::_EndWakeupBatch() noexcept
+try
+{
+    assert(_wakeupBatchDepth > 0);
+    if (--_wakeupBatchDepth == 0 && std::exchange(_wakeupPending, false))
+    {
+        WakeUpReadersWaitingForData();
+    }
+}
+CATCH_LOG()
+
 // Routine Description:
 // - Wakes up any readers waiting for data when a ctrl-c or ctrl-break is input.
 // Arguments:
@@ -295,6 +302,14 @@ void InputBuffer::WakeUpReadersWaitingForData()
 // - None
 void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 {
+    // Readers must see any input that was written before the ctrl-c,
+    // even if its wakeup was deferred by an ongoing batch.
+    if (std::exchange(_wakeupPending, false))
+    {
+        _stats.wakeups++;
+        WaitQueue.NotifyWaiters(false);
+    }
+
     WaitQueue.NotifyWaiters(true, Flag);
 }
 
@@ -335,10 +350,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const INPUT_RECORD& event) {
+    _storage.remove_if([](const INPUT_RECORD& event) noexcept {
         return event.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 // Routine Description:
@@ -379,14 +393,24 @@ try
         ConsumeCached(Unicode, AmountToRead, OutEvents);
     }
 
-    auto it = _storage.begin();
-    const auto end = _storage.end();
+    size_t i = 0;
+    const auto end = _storage.size();
+
+    // Fast path: Unicode, non-stream reads return the stored records as-is,
+    // which allows us to copy them over in bulk.
+    if (Unicode && !Stream && OutEvents.size() < AmountToRead)
+    {
+        i = std::min(AmountToRead - OutEvents.size(), end);
+        _storage.copy_to(OutEvents, i);
+    }
 
-    while (it != end && OutEvents.size() < AmountToRead)
+    while (i != end && OutEvents.size() < AmountToRead)
     {
-        if (it->EventType == KEY_EVENT)
+        auto& record = _storage[i];
+
+        if (record.EventType == KEY_EVENT)
         {
-            auto event = *it;
+            auto event = record;
             WORD repeat = 1;
 
             // for stream reads we need to split any key events that have been coalesced
@@ -429,21 +453,21 @@ try
 
             if (repeat && !Peek)
             {
-                it->Event.KeyEvent.wRepeatCount = repeat;
+                record.Event.KeyEvent.wRepeatCount = repeat;
                 break;
             }
         }
         else
         {
-            OutEvents.push_back(*it);
+            OutEvents.push_back(record);
         }
 
-        ++it;
+        ++i;
     }
 
     if (!Peek)
     {
-        _storage.erase(_storage.begin(), it);
+        _storage.pop_front(i);
     }
 
     Cache(Unicode, OutEvents, AmountToRead);
@@ -489,11 +513,11 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<INPUT_RECORD> existingStorage;
+        RecordRing existingStorage;
         existingStorage.swap(_storage);
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
+        // However, because we swapped the storage out from under it with an empty ring, it will always
         // return true after the first one (as it is filling the newly emptied backing deque.)
         // Then after the second one, because we've inserted some input, it will always say false.
         auto unusedWaitStatus = false;
@@ -503,10 +527,8 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
         _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
-        for (const auto& event : existingStorage)
-        {
-            _storage.push_back(event);
-        }
+        _storage.append(existingStorage);
+        _stats.peakSize = std::max(_stats.peakSize, _storage.size());
 
         // We need to set the wait event if there were 0 events in the
         // input queue when we started.
@@ -605,6 +627,8 @@ void InputBuffer::WriteFocusEvent(bool focused) noexcept
         // This is a mini-version of Write().
         const auto wasEmpty = _storage.empty();
         _storage.push_back(SynthesizeFocusEvent(focused));
+        _stats.recordsWritten++;
+        _stats.peakSize = std::max(_stats.peakSize, _storage.size());
         if (wasEmpty)
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
@@ -660,6 +684,7 @@ static bool IsPauseKey(const KEY_EVENT_RECORD& event)
 
 // Routine Description:
 // - Coalesces input events and transfers them to storage queue.
+// - Runs of records that need no special handling are appended in bulk.
 // Arguments:
 // - inRecords - The events to store.
 // - eventsWritten - The number of events written since this function
@@ -676,23 +701,46 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
 
     eventsWritten = 0;
     setWaitEvent = false;
+    _stats.writes++;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
-    for (const auto& inEvent : inEvents)
+    // we only check for possible coalescing when storing one
+    // record at a time because this is the original behavior of
+    // the input buffer. Changing this behavior may break stuff
+    // that was depending on it.
+    const auto mayCoalesce = inEvents.size() == 1 && !initiallyEmptyQueue;
+
+    // [runBeg, i) is the run of pending records that will be appended as-is.
+    // It gets flushed whenever a record needs to be dropped or replaced.
+    size_t runBeg = 0;
+    const auto flushRun = [&](size_t runEnd) {
+        if (runEnd > runBeg)
+        {
+            _storage.append(inEvents.subspan(runBeg, runEnd - runBeg));
+            _stats.recordsWritten += runEnd - runBeg;
+            eventsWritten += runEnd - runBeg;
+        }
+        runBeg = runEnd + 1;
+    };
+
+    for (size_t i = 0; i < inEvents.size(); ++i)
     {
+        const auto& inEvent = til::at(inEvents, i);
+
         if (inEvent.EventType == KEY_EVENT && inEvent.Event.KeyEvent.bKeyDown)
         {
             // if output is suspended, any keyboard input releases it.
             if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) && !IsSystemKey(inEvent.Event.KeyEvent.wVirtualKeyCode))
             {
+                flushRun(i);
                 UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
                 continue;
             }
             // intercept control-s
             if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && IsPauseKey(inEvent.Event.KeyEvent))
             {
+                flushRun(i);
                 WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
                 continue;
             }
@@ -707,26 +755,28 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
             // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
             if (const auto out = _termInput.HandleKey(inEvent))
             {
+                flushRun(i);
                 _HandleTerminalInputCallback(*out);
                 eventsWritten++;
                 continue;
             }
         }
 
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty() && _CoalesceEvent(inEvents[0]))
+        if (mayCoalesce && _CoalesceEvent(inEvent))
         {
+            runBeg = i + 1;
+            _stats.recordsCoalesced++;
             eventsWritten++;
-            return;
+            continue;
         }
 
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(inEvent);
-        ++eventsWritten;
+        // It stays part of the current run and gets appended by flushRun().
     }
+
+    flushRun(inEvents.size());
+    _stats.peakSize = std::max(_stats.peakSize, _storage.size());
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -818,6 +868,8 @@ void InputBuffer::_HandleTerminalInputCallback(const TerminalInput::StringType&
         {
             _storage.push_back(SynthesizeKeyEvent(true, 1, 0, 0, wch, 0));
         }
+        _stats.recordsWritten += text.size();
+        _stats.peakSize = std::max(_stats.peakSize, _storage.size());
 
         if (!_vtInputShouldSuppress)
         {
@@ -835,3 +887,151 @@ TerminalInput& InputBuffer::GetTerminalInput()
 {
     return _termInput;
 }
+
+const InputBuffer::Statistics& InputBuffer::GetStatistics() const noexcept
+{
+    return _stats;
+}
+
+bool InputBuffer::RecordRing::empty() const noexcept
+{
+    return _size == 0;
+}
+
+size_t InputBuffer::RecordRing::size() const noexcept
+{
+    return _size;
+}
+
+INPUT_RECORD& InputBuffer::RecordRing::operator[](size_t index) noexcept
+{
+    assert(index < _size);
+    return _buffer[(_head + index) & (_capacity - 1)];
+}
+
+const INPUT_RECORD& InputBuffer::RecordRing::operator[](size_t index) const noexcept
+{
+    assert(index < _size);
+    return _buffer[(_head + index) & (_capacity - 1)];
+}
+
+INPUT_RECORD& InputBuffer::RecordRing::front() noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputBuffer::RecordRing::back() noexcept
+{
+    return (*this)[_size - 1];
+}
+
+void InputBuffer::RecordRing::push_back(const INPUT_RECORD& record)
+{
+    _reserve(_size + 1);
+    _buffer[(_head + _size) & (_capacity - 1)] = record;
+    _size++;
+}
+
+void InputBuffer::RecordRing::append(std::span<const INPUT_RECORD> records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+
+    _reserve(_size + records.size());
+
+    // The free space may wrap around the end of the buffer,
+    // in which case we need to copy the records in two parts.
+    const auto tail = (_head + _size) & (_capacity - 1);
+    const auto first = std::min(records.size(), _capacity - tail);
+    std::copy_n(records.data(), first, _buffer.get() + tail);
+    std::copy_n(records.data() + first, records.size() - first, _buffer.get());
+    _size += records.size();
+}
+
+void InputBuffer::RecordRing::append(const RecordRing& other)
+{
+    const auto first = other._firstSpan(other._size);
+    append(first);
+    append({ other._buffer.get(), other._size - first.size() });
+}
+
+// Appends the first `count` records to `target` without removing them.
+void InputBuffer::RecordRing::copy_to(InputEventQueue& target, size_t count) const
+{
+    count = std::min(count, _size);
+    const auto first = _firstSpan(count);
+    target.insert(target.end(), first.data(), first.data() + first.size());
+    target.insert(target.end(), _buffer.get(), _buffer.get() + (count - first.size()));
+}
+
+void InputBuffer::RecordRing::pop_front(size_t count) noexcept
+{
+    if (!count)
+    {
+        return;
+    }
+
+    assert(count <= _size);
+    _head = (_head + count) & (_capacity - 1);
+    _size -= count;
+    _releaseIfEmpty();
+}
+
+void InputBuffer::RecordRing::clear() noexcept
+{
+    _size = 0;
+    _releaseIfEmpty();
+}
+
+void InputBuffer::RecordRing::swap(RecordRing& other) noexcept
+{
+    std::swap(_buffer, other._buffer);
+    std::swap(_capacity, other._capacity);
+    std::swap(_head, other._head);
+    std::swap(_size, other._size);
+}
+
+// Returns the contiguous part of the first `count` records, which starts at `_head`.
+// The remaining `count - span.size()` records (if any) wrapped around to index 0.
+std::span<const INPUT_RECORD> InputBuffer::RecordRing::_firstSpan(size_t count) const noexcept
+{
+    return { _buffer.get() + _head, std::min(count, _capacity - _head) };
+}
+
+void InputBuffer::RecordRing::_reserve(size_t capacity)
+{
+    if (capacity <= _capacity)
+    {
+        return;
+    }
+
+    const auto newCapacity = std::bit_ceil(std::max(capacity, MinimumCapacity));
+    auto buffer = std::make_unique_for_overwrite<INPUT_RECORD[]>(newCapacity);
+
+    // Linearize the existing contents, so that _head can start at 0 again.
+    const auto first = _firstSpan(_size);
+    std::copy_n(first.data(), first.size(), buffer.get());
+    std::copy_n(_buffer.get(), _size - first.size(), buffer.get() + first.size());
+
+    _buffer = std::move(buffer);
+    _capacity = newCapacity;
+    _head = 0;
+}
+
+void InputBuffer::RecordRing::_releaseIfEmpty() noexcept
+{
+    if (_size)
+    {
+        return;
+    }
+
+    _head = 0;
+
+    if (_capacity > RetainedCapacity)
+    {
+        _buffer.reset();
+        _capacity = 0;
+    }
+}
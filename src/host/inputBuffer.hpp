@@ -10,8 +10,6 @@
 #include "../server/ObjectHeader.h"
 #include "../terminal/input/terminalInput.hpp"
 
-#include <deque>
-
 namespace Microsoft::Console::Render
 {
     class Renderer;
@@ -21,6 +19,17 @@ namespace Microsoft::Console::Render
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
+    // Counters describing how input arrives at the buffer. They're cheap enough to
+    // always be maintained and allow tests and benchmarks to observe batching.
+    struct Statistics
+    {
+        size_t writes = 0; // calls to Write() / Prepend()
+        size_t recordsWritten = 0; // records appended to the storage
+        size_t recordsCoalesced = 0; // records merged into the previous record
+        size_t wakeups = 0; // times waiting readers were notified
+        size_t peakSize = 0; // the highest number of records stored at once
+    };
+
     DWORD InputMode;
     ConsoleWaitQueue WaitQueue; // formerly ReadWaitQueue
     bool fInComposition; // specifies if there's an ongoing text composition
@@ -43,6 +52,17 @@ public:
 
     void ReinitializeInputBuffer();
     void WakeUpReadersWaitingForData();
+
+    // While the returned object is alive, reader wakeups are deferred and
+    // coalesced into a single one when the outermost batch ends. This allows
+    // callers like VtInputThread to write thousands of records one sequence
+    // at a time without running the wait queue after each of them.
+    [[nodiscard]] auto BatchWakeups() noexcept
+    {
+        ++_wakeupBatchDepth;
+        return wil::scope_exit([this]() { _EndWakeupBatch(); });
+    }
+
     void TerminateRead(_In_ WaitTerminationReason Flag);
     size_t GetNumberOfReadyEvents() const noexcept;
     void Flush();
@@ -63,8 +83,63 @@ public:
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
+    const Statistics& GetStatistics() const noexcept;
 
 private:
+    // A growable FIFO of INPUT_RECORDs in a single contiguous allocation.
+    // Unlike a std::deque it allows appending and reading whole spans of records
+    // with at most two memcpy()s, which matters for pastes and win32-input-mode,
+    // where VtInputThread may produce tens of thousands of records in a burst.
+    class RecordRing
+    {
+    public:
+        bool empty() const noexcept;
+        size_t size() const noexcept;
+        INPUT_RECORD& operator[](size_t index) noexcept;
+        const INPUT_RECORD& operator[](size_t index) const noexcept;
+        INPUT_RECORD& front() noexcept;
+        INPUT_RECORD& back() noexcept;
+
+        void push_back(const INPUT_RECORD& record);
+        void append(std::span<const INPUT_RECORD> records);
+        void append(const RecordRing& other);
+        void copy_to(InputEventQueue& target, size_t count) const;
+        void pop_front(size_t count) noexcept;
+        void clear() noexcept;
+        void swap(RecordRing& other) noexcept;
+
+        template<typename Pred>
+        void remove_if(Pred&& pred) noexcept
+        {
+            size_t write = 0;
+            for (size_t read = 0; read < _size; ++read)
+            {
+                const auto& record = (*this)[read];
+                if (!pred(record))
+                {
+                    (*this)[write++] = record;
+                }
+            }
+            _size = write;
+            _releaseIfEmpty();
+        }
+
+    private:
+        // Once drained, allocations larger than this are released eagerly
+        // so that a large paste doesn't pin its memory forever.
+        static constexpr size_t RetainedCapacity = 4096;
+        static constexpr size_t MinimumCapacity = 16;
+
+        std::span<const INPUT_RECORD> _firstSpan(size_t count) const noexcept;
+        void _reserve(size_t capacity);
+        void _releaseIfEmpty() noexcept;
+
+        std::unique_ptr<INPUT_RECORD[]> _buffer;
+        size_t _capacity = 0; // always 0 or a power of 2
+        size_t _head = 0;
+        size_t _size = 0;
+    };
+
     enum class ReadingMode : uint8_t
     {
         StringA,
@@ -77,10 +152,10 @@ private:
     std::string_view _cachedTextReaderA;
     std::wstring _cachedTextW;
     std::wstring_view _cachedTextReaderW;
-    std::deque<INPUT_RECORD> _cachedInputEvents;
+    RecordRing _cachedInputEvents;
     ReadingMode _readingMode = ReadingMode::StringA;
 
-    std::deque<INPUT_RECORD> _storage;
+    RecordRing _storage;
     INPUT_RECORD _writePartialByteSequence{};
     bool _writePartialByteSequenceAvailable = false;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -91,11 +166,16 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
+    size_t _wakeupBatchDepth = 0;
+    bool _wakeupPending = false;
+    Statistics _stats;
+
     void _switchReadingMode(ReadingMode mode);
     void _switchReadingModeSlowPath(ReadingMode mode);
     void _WriteBuffer(const std::span<const INPUT_RECORD>& inRecords, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent);
     bool _CoalesceEvent(const INPUT_RECORD& inEvent) noexcept;
     void _HandleTerminalInputCallback(const Microsoft::Console::VirtualTerminal::TerminalInput::StringType& text);
+    void _EndWakeupBatch() noexcept;
 
 #ifdef UNIT_TESTING
     friend class InputBufferTests;
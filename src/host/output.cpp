@@ -10,6 +10,7 @@
 #include "getset.h"
 #include "misc.h"
 
+#include "../buffer/out/textBufferRunIterator.hpp"
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/Viewport.hpp"
 #include "../types/inc/convert.hpp"
@@ -140,34 +141,45 @@ std::vector<WORD> ReadOutputAttributes(const SCREEN_INFORMATION& screenInfo,
         return {};
     }
 
-    // Get iterator to the position we should start reading at.
-    auto it = screenInfo.GetCellDataAt(coordRead);
+    const auto& buffer = screenInfo.GetTextBuffer();
+    const auto bufferSize = screenInfo.GetBufferSize();
     // Count up the number of cells we've attempted to read.
-    ULONG amountRead = 0;
+    size_t amountRead = 0;
     // Prepare the return value string.
     std::vector<WORD> retVal;
     // Reserve the number of cells. If we have >U+FFFF, it will auto-grow later and that's OK.
     retVal.reserve(amountToRead);
 
-    // While we haven't read enough cells yet and the iterator is still valid (hasn't reached end of buffer)
-    while (amountRead < amountToRead && it)
+    // Walk through the buffer one attribute run at a time, until we've read enough cells or reached the end of the buffer.
+    for (auto pos = coordRead; amountRead < amountToRead && pos.y < bufferSize.BottomExclusive(); pos = { 0, pos.y + 1 })
     {
-        const auto legacyAttributes = it->TextAttr().GetLegacyAttributes();
+        const auto& row = buffer.GetRowByOffset(pos.y);
+        const auto remaining = gsl::narrow_cast<til::CoordType>(std::min<size_t>(amountToRead - amountRead, bufferSize.Width()));
+        const auto columnEnd = std::min(pos.x + remaining, bufferSize.Width());
 
-        // If the first thing we read is trailing, pad with a space.
-        // OR If the last thing we read is leading, pad with a space.
-        if ((amountRead == 0 && it->DbcsAttr() == DbcsAttribute::Trailing) ||
-            (amountRead == (amountToRead - 1) && it->DbcsAttr() == DbcsAttribute::Leading))
+        for (TextBufferRunIterator it{ row, pos.x, columnEnd }; it; ++it)
         {
-            retVal.push_back(legacyAttributes);
-        }
-        else
-        {
-            retVal.push_back(legacyAttributes | GeneratePublicApiAttributeFormat(it->DbcsAttr()));
-        }
+            const auto legacyAttributes = it->attr.GetLegacyAttributes();
 
-        amountRead++;
-        it++;
+            for (auto column = it->columnBegin; column < it->columnEnd; ++column)
+            {
+                const auto dbcsAttr = row.DbcsAttrAt(column);
+
+                // If the first thing we read is trailing, pad with a space.
+                // OR If the last thing we read is leading, pad with a space.
+                if ((amountRead == 0 && dbcsAttr == DbcsAttribute::Trailing) ||
+                    (amountRead == (amountToRead - 1) && dbcsAttr == DbcsAttribute::Leading))
+                {
+                    retVal.push_back(legacyAttributes);
+                }
+                else
+                {
+                    retVal.push_back(legacyAttributes | GeneratePublicApiAttributeFormat(dbcsAttr));
+                }
+
+                amountRead++;
+            }
+        }
     }
 
     return retVal;
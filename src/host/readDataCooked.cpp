@@ -233,6 +233,8 @@ void COOKED_READ_DATA::EraseBeforeResize()
         _unwindCursorPosition(_distanceEnd);
         _distanceCursor = 0;
         _distanceEnd = 0;
+        _bufferDisplayed.clear();
+        _anchors.resize(1);
     }
 }
 
@@ -653,7 +655,7 @@ void COOKED_READ_DATA::_handlePostCharInputLoop(const bool isUnicode, size_t& nu
         static constexpr std::wstring_view cr{ L"\r" };
         static constexpr std::wstring_view crlf{ L"\r\n" };
         const auto newlineSuffix = WI_IsFlagSet(_pInputBuffer->InputMode, ENABLE_PROCESSED_INPUT) ? crlf : cr;
-        std::wstring alias;
+        std::wstring_view alias;
 
         // Here's why we can't easily use _flushBuffer() to handle newlines:
         //
@@ -688,7 +690,7 @@ void COOKED_READ_DATA::_handlePostCharInputLoop(const bool isUnicode, size_t& nu
 
         if (!alias.empty())
         {
-            _buffer = std::move(alias);
+            _buffer.assign(alias);
         }
         else
         {
@@ -753,6 +755,11 @@ void COOKED_READ_DATA::_markAsDirty()
 }
 
 // Draws the contents of _buffer onto the screen.
+//
+// Only the part that changed since the last call is drawn: We resume drawing at the last anchor in front of the
+// first changed character and stop once we arrive at an unchanged part of the previous contents at the same column
+// it was drawn at before. Everything after that point is still on the screen. Anything that affects the layout of
+// the remaining text, like inserting characters, still redraws everything after the change, since it has to move.
 // NOTE: Don't call _flushBuffer() after appending newlines to the buffer! See _handlePostCharInputLoop for more information.
 void COOKED_READ_DATA::_flushBuffer()
 {
@@ -767,20 +774,105 @@ void COOKED_READ_DATA::_flushBuffer()
 
     if (WI_IsFlagSet(_pInputBuffer->InputMode, ENABLE_ECHO_INPUT))
     {
-        _unwindCursorPosition(_distanceCursor);
-
         const std::wstring_view view{ _buffer };
-        const auto distanceBeforeCursor = _writeChars(view.substr(0, _bufferCursor));
-        const auto distanceAfterCursor = _writeChars(view.substr(_bufferCursor));
-        const auto distanceEnd = distanceBeforeCursor + distanceAfterCursor;
-        const auto eraseDistance = std::max<ptrdiff_t>(0, _distanceEnd - distanceEnd);
+        const std::wstring_view displayed{ _bufferDisplayed };
+
+        auto prefix = gsl::narrow_cast<size_t>(std::mismatch(view.begin(), view.end(), displayed.begin(), displayed.end()).first - view.begin());
+        auto suffix = displayed.size();
+
+        // If only the cursor moved, we can stop at any of the anchors. Otherwise, only at the ones in the unchanged
+        // suffix and the last glyph of the unchanged prefix is drawn again, because the changed text may be joined
+        // with it (for instance if it starts with combining marks).
+        if (prefix != view.size() || prefix != displayed.size())
+        {
+            if (prefix != 0)
+            {
+                prefix = TextBuffer::GraphemePrev(view, prefix);
+            }
+
+            const auto suffixMax = std::min(view.size(), displayed.size()) - prefix;
+            suffix = gsl::narrow_cast<size_t>(std::mismatch(view.rbegin(), view.rbegin() + suffixMax, displayed.rbegin()).first - view.rbegin());
+        }
+
+        // We also need to draw everything from the cursor onwards, because that's how we measure where it is.
+        const auto resumeOffset = std::min(prefix, _bufferCursor);
+        auto resumeIt = std::upper_bound(_anchors.begin(), _anchors.end(), resumeOffset, [](const size_t offset, const Anchor& anchor) {
+            return offset < anchor.offset;
+        });
+        --resumeIt;
+
+        // The anchors inside the unchanged suffix are still valid once we account for the change in length.
+        // It's only their distance that might have changed and that's what we check for while drawing.
+        std::vector<Anchor> reusable;
+        const auto suffixBeg = displayed.size() - suffix;
+        for (auto it = resumeIt; it != _anchors.end(); ++it)
+        {
+            if (it->offset >= suffixBeg)
+            {
+                reusable.push_back({ view.size() - (displayed.size() - it->offset), it->distance });
+            }
+        }
+        _anchors.erase(resumeIt + 1, _anchors.end());
+
+        auto offset = resumeIt->offset;
+        auto distance = resumeIt->distance;
+        auto distanceCursor = distance;
+        auto converged = false;
+        auto reuse = reusable.begin();
+
+        _moveCursorPosition(_distanceCursor, distance);
 
-        // If the contents of _buffer became shorter we'll have to erase the previously printed contents.
-        _erase(eraseDistance);
-        _unwindCursorPosition(distanceAfterCursor + eraseDistance);
+        for (;;)
+        {
+            if (offset == _bufferCursor)
+            {
+                distanceCursor = distance;
+            }
+
+            for (; reuse != reusable.end() && reuse->offset <= offset; ++reuse)
+            {
+                if (reuse->offset == offset && reuse->distance == distance && offset >= _bufferCursor)
+                {
+                    _anchors.insert(_anchors.end(), reuse + 1, reusable.end());
+                    converged = true;
+                    break;
+                }
+            }
 
-        _distanceCursor = distanceBeforeCursor;
-        _distanceEnd = distanceEnd;
+            if (converged || offset == view.size())
+            {
+                break;
+            }
+
+            // Draw up to the next anchor interval, the cursor, or the next anchor we may reuse, whichever comes first.
+            auto next = offset + AnchorInterval;
+            next = next < view.size() ? TextBuffer::GraphemeNext(view, TextBuffer::GraphemePrev(view, next)) : view.size();
+            if (_bufferCursor > offset)
+            {
+                next = std::min(next, _bufferCursor);
+            }
+            if (reuse != reusable.end())
+            {
+                next = std::min(next, reuse->offset);
+            }
+
+            distance += _writeChars(view.substr(offset, next - offset));
+            offset = next;
+            _anchors.push_back({ offset, distance });
+        }
+
+        if (!converged)
+        {
+            // If the contents of _buffer became shorter we'll have to erase the previously printed contents.
+            const auto eraseDistance = std::max<ptrdiff_t>(0, _distanceEnd - distance);
+            _erase(eraseDistance);
+            _distanceEnd = distance;
+            distance += eraseDistance;
+        }
+
+        _moveCursorPosition(distance, distanceCursor);
+        _distanceCursor = distanceCursor;
+        _bufferDisplayed.assign(view);
     }
 
     _bufferDirty = false;
@@ -853,6 +945,23 @@ til::point COOKED_READ_DATA::_offsetPosition(til::point pos, ptrdiff_t distance)
     };
 }
 
+// Moves the cursor from `from` to `to`, both of which are distances from the start of the prompt in columns.
+// Unlike _unwindCursorPosition this can also move the cursor forward, into previously drawn parts of the prompt.
+void COOKED_READ_DATA::_moveCursorPosition(ptrdiff_t from, ptrdiff_t to) const
+{
+    if (from == to)
+    {
+        return;
+    }
+
+    const auto& textBuffer = _screenInfo.GetTextBuffer();
+    const auto& cursor = textBuffer.GetCursor();
+    const auto pos = _offsetPosition(cursor.GetPosition(), to - from);
+
+    std::ignore = _screenInfo.SetCursorPosition(pos, true);
+    _screenInfo.MakeCursorVisible(pos);
+}
+
 // This moves the cursor `distance`-many cells back up in the buffer.
 // It's intended to be used in combination with _writeChars.
 void COOKED_READ_DATA::_unwindCursorPosition(ptrdiff_t distance) const
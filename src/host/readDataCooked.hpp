@@ -40,6 +40,8 @@ public:
 
 private:
     static constexpr uint8_t CommandNumberMaxInputLength = 5;
+    // _flushBuffer() records an Anchor at least this often (in code units) while drawing the prompt.
+    static constexpr size_t AnchorInterval = 256;
 
     enum class State : uint8_t
     {
@@ -72,6 +74,16 @@ private:
         CommandList,
     };
 
+    // A position in the prompt that _flushBuffer() has previously drawn,
+    // so that it can resume drawing from there without redrawing everything before it.
+    struct Anchor
+    {
+        // The offset into _buffer.
+        size_t offset = 0;
+        // The distance between the start of the prompt and the glyph at `offset` in columns.
+        ptrdiff_t distance = 0;
+    };
+
     struct Popup
     {
         PopupKind kind;
@@ -123,6 +135,7 @@ private:
     void _erase(ptrdiff_t distance) const;
     ptrdiff_t _writeChars(const std::wstring_view& text) const;
     til::point _offsetPosition(til::point pos, ptrdiff_t distance) const;
+    void _moveCursorPosition(ptrdiff_t from, ptrdiff_t to) const;
     void _unwindCursorPosition(ptrdiff_t distance) const;
     void _replaceBuffer(const std::wstring_view& str);
 
@@ -153,6 +166,11 @@ private:
     // _distanceEnd is the distance between the start of the prompt and its last
     // glyph at the end in columns (including wide glyph padding columns).
     ptrdiff_t _distanceEnd = 0;
+    // The contents of _buffer as of the last time they were drawn, and positions within it
+    // whose distances we know, sorted by offset. The first anchor is always at { 0, 0 }.
+    // They allow _flushBuffer() to only redraw the part of the prompt that changed.
+    std::wstring _bufferDisplayed;
+    std::vector<Anchor> _anchors{ Anchor{} };
     bool _bufferDirty = false;
     bool _insertMode = false;
     State _state = State::Accumulating;
@@ -94,6 +94,23 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
                                                           const TextAttribute popupAttributes,
                                                           const UINT uiCursorSize,
                                                           _Outptr_ SCREEN_INFORMATION** const ppScreen)
+{
+    return _CreateInstance(coordWindowSize, fontInfo, coordScreenBufferSize, defaultAttributes, popupAttributes, uiCursorSize, nullptr, ppScreen);
+}
+
+// Routine Description:
+// - Same as CreateInstance, but can reuse a previously used text buffer instead of allocating a new one.
+// Arguments:
+// - recycledTextBuffer - if not null, a text buffer with a size of coordScreenBufferSize,
+//                        which will be reset and used by the new screen buffer.
+[[nodiscard]] NTSTATUS SCREEN_INFORMATION::_CreateInstance(_In_ til::size coordWindowSize,
+                                                           const FontInfo fontInfo,
+                                                           _In_ til::size coordScreenBufferSize,
+                                                           const TextAttribute defaultAttributes,
+                                                           const TextAttribute popupAttributes,
+                                                           const UINT uiCursorSize,
+                                                           std::unique_ptr<TextBuffer> recycledTextBuffer,
+                                                           _Outptr_ SCREEN_INFORMATION** const ppScreen)
 {
     *ppScreen = nullptr;
 
@@ -114,11 +131,21 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
         pScreen->UpdateBottom();
 
         // Set up text buffer
-        pScreen->_textBuffer = std::make_unique<TextBuffer>(coordScreenBufferSize,
-                                                            defaultAttributes,
-                                                            uiCursorSize,
-                                                            pScreen->IsActiveScreenBuffer(),
-                                                            *ServiceLocator::LocateGlobals().pRender);
+        if (recycledTextBuffer)
+        {
+            assert(recycledTextBuffer->GetSize().Dimensions() == coordScreenBufferSize);
+            recycledTextBuffer->Recycle(defaultAttributes, uiCursorSize);
+            recycledTextBuffer->SetAsActiveBuffer(pScreen->IsActiveScreenBuffer());
+            pScreen->_textBuffer = std::move(recycledTextBuffer);
+        }
+        else
+        {
+            pScreen->_textBuffer = std::make_unique<TextBuffer>(coordScreenBufferSize,
+                                                                defaultAttributes,
+                                                                uiCursorSize,
+                                                                pScreen->IsActiveScreenBuffer(),
+                                                                *ServiceLocator::LocateGlobals().pRender);
+        }
 
         const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         pScreen->_textBuffer->GetCursor().SetType(gci.GetCursorType());
@@ -1065,6 +1092,12 @@ void SCREEN_INFORMATION::_InternalSetViewportSize(const til::size* const pcoordS
     const auto DeltaY = pcoordSize->height - _viewport.Height();
     const auto coordScreenBufferSize = GetBufferSize().Dimensions();
 
+    // The alternate buffer is as large as the viewport. A recycled one won't fit anymore.
+    if (DeltaX != 0 || DeltaY != 0)
+    {
+        _recycledAltTextBuffer.reset();
+    }
+
     // do adjustments on a copy that's easily manipulated.
     auto srNewViewport = _viewport.ToInclusive();
 
@@ -1479,6 +1512,9 @@ NT_CATCH_RETURN()
         return STATUS_SUCCESS;
     }
 
+    // A recycled alternate text buffer most likely won't fit anymore.
+    _recycledAltTextBuffer.reset();
+
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     auto status = STATUS_SUCCESS;
 
@@ -1812,13 +1848,22 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 
     const auto& existingFont = GetCurrentFont();
 
-    auto Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
-                                                     existingFont,
-                                                     WindowSize,
-                                                     initAttributes,
-                                                     GetPopupAttributes(),
-                                                     Cursor::CURSOR_SMALL_SIZE,
-                                                     ppsiNewScreenBuffer);
+    // Applications like pagers and editors switch between the main and alternate buffer all the time.
+    // Reusing the text buffer of the previous alternate buffer saves us from allocating a new one each time.
+    auto recycledTextBuffer = std::move(GetMainBuffer()._recycledAltTextBuffer);
+    if (recycledTextBuffer && recycledTextBuffer->GetSize().Dimensions() != WindowSize)
+    {
+        recycledTextBuffer.reset();
+    }
+
+    auto Status = SCREEN_INFORMATION::_CreateInstance(WindowSize,
+                                                      existingFont,
+                                                      WindowSize,
+                                                      initAttributes,
+                                                      GetPopupAttributes(),
+                                                      Cursor::CURSOR_SMALL_SIZE,
+                                                      std::move(recycledTextBuffer),
+                                                      ppsiNewScreenBuffer);
     if (SUCCEEDED_NTSTATUS(Status))
     {
         // Update the alt buffer's cursor style, visibility, and position to match our own.
@@ -1999,6 +2044,10 @@ void SCREEN_INFORMATION::UseMainScreenBuffer()
         // Copy the alt buffer's output mode back to the main buffer.
         psiMain->OutputMode = psiAlt->OutputMode;
 
+        // Keep the alt buffer's text buffer around for the next _CreateAltBuffer().
+        // This is safe, because the main buffer is the active one again at this point.
+        psiMain->_recycledAltTextBuffer = std::move(psiAlt->_textBuffer);
+
         s_RemoveScreenBuffer(psiAlt); // this will also delete the alt buffer
         // deleting the alt buffer will give the GetSet back to its main
 
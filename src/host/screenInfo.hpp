@@ -169,6 +169,11 @@ private:
 public:
     SCREEN_INFORMATION* Next;
     BYTE WriteConsoleDbcsLeadByte[2];
+
+    // Reusable buffer for WriteConsoleA to convert its input to UTF-16.
+    // Capacity above WriteConsoleAScratchRetainedCapacity is released after each call.
+    static constexpr size_t WriteConsoleAScratchRetainedCapacity = 16 * 1024;
+    std::wstring WriteConsoleAScratch;
     BYTE FillOutDbcsLeadChar;
 
     // non ownership pointer
@@ -249,6 +254,15 @@ private:
     [[nodiscard]] NTSTATUS ResizeWithReflow(const til::size coordnewScreenSize);
     [[nodiscard]] NTSTATUS ResizeTraditional(const til::size coordNewScreenSize);
 
+    [[nodiscard]] static NTSTATUS _CreateInstance(_In_ til::size coordWindowSize,
+                                                  const FontInfo fontInfo,
+                                                  _In_ til::size coordScreenBufferSize,
+                                                  const TextAttribute defaultAttributes,
+                                                  const TextAttribute popupAttributes,
+                                                  const UINT uiCursorSize,
+                                                  std::unique_ptr<TextBuffer> recycledTextBuffer,
+                                                  _Outptr_ SCREEN_INFORMATION** const ppScreen);
+
     [[nodiscard]] NTSTATUS _InitializeOutputStateMachine();
     void _FreeOutputStateMachine();
 
@@ -269,6 +283,9 @@ private:
 
     SCREEN_INFORMATION* _psiAlternateBuffer; // The VT "Alternate" screen buffer.
     SCREEN_INFORMATION* _psiMainBuffer; // A pointer to the main buffer, if this is the alternate buffer.
+    // The text buffer of the last alternate buffer, kept by the main buffer so that the next
+    // alternate buffer of the same size can reuse it. Dropped when the buffer or viewport is resized.
+    std::unique_ptr<TextBuffer> _recycledAltTextBuffer;
 
     til::rect _rcAltSavedClientNew;
     til::rect _rcAltSavedClientOld;
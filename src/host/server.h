@@ -148,6 +148,8 @@ public:
 
 private:
     til::recursive_ticket_lock _lock;
+    uint64_t _lockContentions = 0;
+    std::chrono::microseconds _lockWaitTime{};
 
     std::wstring _Title;
     std::wstring _Prefix; // Eg Select, Mark - things that we manually prepend to the title.
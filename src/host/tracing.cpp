@@ -208,6 +208,21 @@ void Tracing::s_TraceConsoleAttachDetach(_In_ ConsoleProcessHandle* const pConso
     }
 }
 
+// Emitted whenever acquiring the console lock had to wait for another thread.
+// The totals cover all contended acquisitions since the console started.
+void Tracing::s_TraceConsoleLockContention(const std::chrono::microseconds waitTime, const uint64_t contentions, const std::chrono::microseconds totalWaitTime) noexcept
+{
+    TraceLoggingWrite(
+        g_hConhostV2EventTraceProvider,
+        "ConsoleLockContention",
+        TraceLoggingInt64(waitTime.count(), "WaitTimeUs"),
+        TraceLoggingUInt64(contentions, "ContentionCount"),
+        TraceLoggingInt64(totalWaitTime.count(), "TotalWaitTimeUs"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE),
+        TraceLoggingKeyword(TraceKeywords::General));
+}
+
 void __stdcall Tracing::TraceFailure(const wil::FailureInfo& failure) noexcept
 {
     TraceLoggingWrite(
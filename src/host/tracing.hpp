@@ -53,6 +53,7 @@ public:
 
     static void s_TraceCookedRead(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, const std::wstring_view& text);
     static void s_TraceConsoleAttachDetach(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, _In_ bool bIsAttach);
+    static void s_TraceConsoleLockContention(std::chrono::microseconds waitTime, uint64_t contentions, std::chrono::microseconds totalWaitTime) noexcept;
 
     static void __stdcall TraceFailure(const wil::FailureInfo& failure) noexcept;
 
@@ -125,7 +125,7 @@ class AliasTests
         size_t linesActual = 0;
         const auto actual = Alias::s_MatchAndCopyAlias(original, exe, linesActual);
 
-        VERIFY_ARE_EQUAL(expected, actual);
+        VERIFY_ARE_EQUAL(std::wstring_view{ expected }, actual);
         VERIFY_ARE_EQUAL(linesExpected, linesActual);
     }
 
@@ -435,4 +435,68 @@ class AliasTests
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
         VERIFY_ARE_EQUAL(lineCountExpected, lineCountActual);
     }
+
+    TEST_METHOD(CompileTarget)
+    {
+        // In the expected strings, # followed by the macro character marks
+        // where an argument will be substituted during expansion.
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:targetExpectedPair",
+                                 L"{"
+                                 L"foo=foo%,"
+                                 L"foo$1bar=foo#1bar%,"
+                                 L"$*=#*%,"
+                                 L"$1$2$9=#1#2#9%,"
+                                 L"$t$T$*=%%#*%,"
+                                 L"$l$G$b=<>|%,"
+                                 L"$0$A=$0$A%,"
+                                 L"$$1=$$1%,"
+                                 L"foo$=foo$%,"
+                                 L"}")
+        END_TEST_METHOD_PROPERTIES()
+
+        std::wstring target;
+        std::wstring expected;
+        _RetrieveTargetExpectedPair(target, expected);
+
+        const auto linesExpected = _ReplacePercentWithCRLF(expected);
+
+        const auto compiled = Alias::s_CompileTarget(target);
+
+        std::wstring actual;
+        for (const auto& op : compiled.ops)
+        {
+            actual.append(compiled.literals, op.literalBegin, op.literalLength);
+            if (op.argMacro != 0)
+            {
+                actual.push_back(L'#');
+                actual.push_back(op.argMacro);
+            }
+        }
+
+        VERIFY_ARE_EQUAL(String(target.data()), String(compiled.text.data()));
+        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
+        VERIFY_ARE_EQUAL(linesExpected, compiled.lineCount);
+        VERIFY_ARE_EQUAL(L'\0', compiled.ops.back().argMacro);
+    }
+
+    TEST_METHOD(TestMatchAndCopyIgnoresCase)
+    {
+        std::wstring exe(L"exe.exe");
+        std::wstring source(L"source");
+        std::wstring target(L"target $1");
+        Alias::s_TestAddAlias(exe, source, target);
+
+        size_t lines = 0;
+        const std::wstring upperExe(L"EXE.EXE");
+        const auto buffer = Alias::s_MatchAndCopyAlias(L"SOURCE arg", upperExe, lines);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"target arg\r\n" }, buffer);
+        VERIFY_ARE_EQUAL(1u, lines);
+
+        Log::Comment(L"A prefix of the alias name must not match.");
+        lines = 0;
+        VERIFY_IS_TRUE(Alias::s_MatchAndCopyAlias(L"sourc arg", exe, lines).empty());
+        VERIFY_IS_TRUE(Alias::s_MatchAndCopyAlias(L"sources arg", exe, lines).empty());
+        VERIFY_ARE_EQUAL(0u, lines);
+    }
 };
@@ -418,6 +418,64 @@ class ApiRoutinesTests
         }
     }
 
+    TEST_METHOD(ApiWriteConsoleAAsciiCompletesPartials)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:dwCodePage", L"{437, 65001}")
+        END_TEST_METHOD_PROPERTIES();
+
+        DWORD dwCodePage;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"dwCodePage", dwCodePage), L"Get the codepage for the test.");
+
+        Log::Comment(L"ASCII text is widened before the console lock is taken. Ensure that it still "
+                     L"completes partial sequences left over from previous calls, and that the "
+                     L"conversion buffer is reused across calls.");
+
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        gci.OutputCP = dwCodePage;
+        SetConsoleCPInfo(TRUE);
+
+        si.GetActiveBuffer().ClearTextData();
+        si.GetTextBuffer().GetCursor().SetPosition({ 0, 0 });
+
+        const auto write = [&](const std::string_view text) {
+            size_t cchRead = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            VERIFY_ARE_EQUAL(S_OK, _pApiRoutines->WriteConsoleAImpl(si, text, cchRead, false, waiter));
+            VERIFY_IS_NULL(waiter.get());
+            VERIFY_ARE_EQUAL(text.size(), cchRead);
+        };
+
+        std::wstring_view expected;
+        if (dwCodePage == CP_UTF8)
+        {
+            // The incomplete sequence is cached, then gets terminated by the ASCII text.
+            write("ab\xe3\x82");
+            write("cd");
+            write("ef");
+            expected = L"ab\uFFFDcdefgh";
+        }
+        else
+        {
+            write("ab");
+            write("cd");
+            write("\x80\x81");
+            expected = L"abcd\u00C7\u00FCgh";
+        }
+
+        const auto capacity = si.WriteConsoleAScratch.capacity();
+        write("gh");
+        VERIFY_ARE_EQUAL(capacity, si.WriteConsoleAScratch.capacity(), L"The conversion buffer should be reused.");
+
+        const auto text = si.GetTextBuffer().GetRowByOffset(0).GetText();
+        VERIFY_ARE_EQUAL(expected, text.substr(0, expected.size()));
+    }
+
     TEST_METHOD(ApiWriteConsoleW)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -866,4 +924,71 @@ class ApiRoutinesTests
 
         ValidateComplexScreen(si, background, fill, scrollRect, Viewport::FromInclusive(scroll), destination, clipViewport);
     }
+
+    TEST_METHOD(ApiReadWriteConsoleOutputBenchmark)
+    {
+        Log::Comment(L"Blits a full 200x60 window with WriteConsoleOutputW and reads it back with ReadConsoleOutputW.");
+        Log::Comment(L"Use /p:BlitIterations=<count> to change the number of frames.");
+
+        size_t iterations = 10;
+        {
+            WEX::Common::String value;
+            if (SUCCEEDED(WEX::TestExecution::RuntimeParameters::TryGetValue(L"BlitIterations", value)) && !value.IsEmpty())
+            {
+                iterations = wcstoul(value, nullptr, 10);
+            }
+        }
+
+        static constexpr til::size windowSize{ 200, 60 };
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->PrepareGlobalScreenBuffer(windowSize.width, windowSize.height, windowSize.width, windowSize.height);
+
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+        const auto window = Viewport::FromDimensions({ 0, 0 }, windowSize);
+
+        // A frame like a TUI would draw it: Runs of text in a handful of different colors.
+        std::vector<CHAR_INFO> frame(windowSize.area<size_t>());
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            frame[i].Char.UnicodeChar = static_cast<wchar_t>(L'!' + i % 94);
+            frame[i].Attributes = static_cast<WORD>(1 + (i / 13) % 15);
+        }
+
+        std::vector<CHAR_INFO> writeBuffer(frame.size());
+        std::vector<CHAR_INFO> readBuffer(frame.size());
+        std::chrono::steady_clock::duration writeTime{};
+        std::chrono::steady_clock::duration readTime{};
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            // WriteConsoleOutputW may modify the buffer in place, so every frame gets a fresh copy.
+            writeBuffer = frame;
+
+            auto written = Viewport::Empty();
+            const auto writeBeg = std::chrono::steady_clock::now();
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, writeBuffer, window, written));
+            const auto writeEnd = std::chrono::steady_clock::now();
+            VERIFY_ARE_EQUAL(window, written);
+
+            auto read = Viewport::Empty();
+            const auto readBeg = std::chrono::steady_clock::now();
+            VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, readBuffer, window, read));
+            const auto readEnd = std::chrono::steady_clock::now();
+            VERIFY_ARE_EQUAL(window, read);
+
+            writeTime += writeEnd - writeBeg;
+            readTime += readEnd - readBeg;
+        }
+
+        for (size_t i = 0; iterations && i < frame.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(frame[i], readBuffer[i]);
+        }
+
+        const auto frames = gsl::narrow_cast<long long>(std::max<size_t>(iterations, 1));
+        const auto writeUs = std::chrono::duration_cast<std::chrono::microseconds>(writeTime).count() / frames;
+        const auto readUs = std::chrono::duration_cast<std::chrono::microseconds>(readTime).count() / frames;
+        Log::Comment(NoThrowString().Format(L"frames: %zu, write: %lldus/frame, read: %lldus/frame", iterations, writeUs, readUs));
+    }
 };
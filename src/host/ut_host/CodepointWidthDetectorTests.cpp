@@ -69,21 +69,41 @@ class CodepointWidthDetectorTests
         widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
 
         // Ensure fallback cache is empty.
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCacheCount);
 
         // Lookup ambiguous width character.
         widthDetector.IsWide(ambiguous);
 
         // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCacheCount);
 
         // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous[0], it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous) ? 2u : 1u, it->second);
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous) ? 2u : 1u, widthDetector._fallbackCacheFind(ambiguous[0]));
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCacheCount);
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCacheFind(ambiguous[0]));
+    }
+
+    TEST_METHOD(AmbiguousCacheGrows)
+    {
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+
+        // U+2460-U+24E9 (circled digits and letters) are all ambiguous.
+        // That's enough to make the cache rehash a few times.
+        for (wchar_t ch = 0x2460; ch <= 0x24E9; ++ch)
+        {
+            const std::wstring_view glyph{ &ch, 1 };
+            VERIFY_ARE_EQUAL(FallbackMethod(glyph), widthDetector.IsWide(glyph));
+        }
+
+        VERIFY_ARE_EQUAL(0x24E9u - 0x2460u + 1u, widthDetector._fallbackCacheCount);
+        for (wchar_t ch = 0x2460; ch <= 0x24E9; ++ch)
+        {
+            const std::wstring_view glyph{ &ch, 1 };
+            VERIFY_ARE_EQUAL(FallbackMethod(glyph) ? 2u : 1u, widthDetector._fallbackCacheFind(ch));
+        }
     }
 };
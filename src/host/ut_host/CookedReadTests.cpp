@@ -0,0 +1,285 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "readDataCooked.hpp"
+#include "../interactivity/inc/ServiceLocator.hpp"
+#include "../types/inc/IInputEvent.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class CookedReadTests
+{
+    TEST_CLASS(CookedReadTests);
+
+    std::unique_ptr<CommonState> m_state;
+
+    // The prompt starts somewhere in the middle of a row, so that wide glyphs end up at the end of some rows.
+    static constexpr til::point promptStart{ 7, 3 };
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+
+        m_state->InitEvents();
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalInputBuffer();
+        m_state->PrepareGlobalScreenBuffer();
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalInputBuffer();
+        m_state->CleanupGlobalFont();
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.pInputBuffer->InputMode = ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT | ENABLE_PROCESSED_INPUT;
+        gci.SetInsertMode(true);
+
+        m_state->PrepareReadHandle();
+        _preparePrompt();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        _cleanupPrompt();
+        m_state->CleanupReadHandle();
+        return true;
+    }
+
+    void _preparePrompt()
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        m_state->PrepareNewTextBufferInfo();
+        VERIFY_SUCCEEDED(gci.GetActiveOutputBuffer().SetCursorPosition(promptStart, true));
+        m_state->PrepareCookedReadData();
+    }
+
+    void _cleanupPrompt()
+    {
+        m_state->CleanupCookedReadData();
+        m_state->CleanupNewTextBufferInfo();
+    }
+
+    static void _type(const std::wstring_view& text)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        for (const auto ch : text)
+        {
+            gci.pInputBuffer->Write(SynthesizeKeyEvent(true, 1, 0, 0, ch, 0));
+        }
+        _read();
+    }
+
+    static void _press(const uint16_t vkey, size_t count = 1)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        // Backspace is handled as a character, all other keys we use are command line editing keys.
+        const auto ch = vkey == VK_BACK ? UNICODE_BACKSPACE : UNICODE_NULL;
+        for (; count != 0; --count)
+        {
+            gci.pInputBuffer->Write(SynthesizeKeyEvent(true, 1, vkey, 0, ch, 0));
+        }
+        _read();
+    }
+
+    static void _read()
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        size_t numBytes = 0;
+        ULONG controlKeyState = 0;
+        VERIFY_IS_FALSE(gci.CookedReadData().Read(true, numBytes, controlKeyState));
+    }
+
+    // Returns the contents of all rows the prompt is on.
+    static std::vector<std::wstring> _promptRows()
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+        const auto boundaries = gci.CookedReadData().GetBoundaries();
+
+        std::vector<std::wstring> rows;
+        for (auto y = boundaries.start.y; y <= boundaries.end.y; ++y)
+        {
+            rows.emplace_back(textBuffer.GetRowByOffset(y).GetText());
+        }
+        return rows;
+    }
+
+    static til::point _cursorPosition()
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        return gci.GetActiveOutputBuffer().GetTextBuffer().GetCursor().GetPosition();
+    }
+
+    static void _setCell(const til::point pos, const std::wstring_view& ch)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveOutputBuffer().GetTextBuffer().GetMutableRowByOffset(pos.y).ReplaceCharacters(pos.x, 1, ch);
+    }
+
+    static wchar_t _getCell(const til::point pos)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        return gci.GetActiveOutputBuffer().GetTextBuffer().GetRowByOffset(pos.y).GetText(pos.x, pos.x + 1).front();
+    }
+
+    static std::wstring _makeText(const size_t length)
+    {
+        // A mix of narrow and wide glyphs, so that the line wraps at various columns.
+        static constexpr std::wstring_view pattern{ L"abc \u3042de\u3044fgh " };
+        std::wstring text;
+        while (text.size() < length)
+        {
+            text.append(pattern.substr(0, std::min(pattern.size(), length - text.size())));
+        }
+        return text;
+    }
+
+    TEST_METHOD(EditsMatchFullRedraw)
+    {
+        // Each step edits the prompt and mirrors the edit in `text` and `cursor`.
+        auto text = _makeText(300);
+        size_t cursor = text.size();
+        _type(text);
+
+        _press(VK_LEFT, 57);
+        cursor -= 57;
+        _type(L"xy\u3042");
+        text.insert(cursor, L"xy\u3042");
+        cursor += 3;
+
+        _press(VK_BACK, 2);
+        text.erase(cursor - 2, 2);
+        cursor -= 2;
+
+        _press(VK_LEFT, 30);
+        cursor -= 30;
+        _press(VK_DELETE, 4);
+        text.erase(cursor, 4);
+
+        _press(VK_HOME);
+        cursor = 0;
+        _type(L"\u3046");
+        text.insert(cursor, L"\u3046");
+        cursor += 1;
+
+        _press(VK_END);
+        cursor = text.size();
+        _press(VK_BACK, 25);
+        text.erase(cursor - 25);
+        cursor -= 25;
+
+        _press(VK_LEFT, 100);
+        cursor -= 100;
+
+        const auto rowsActual = _promptRows();
+        const auto cursorActual = _cursorPosition();
+
+        Log::Comment(L"Draw the final text from scratch and compare.");
+        _cleanupPrompt();
+        _preparePrompt();
+
+        _type(text);
+        _press(VK_LEFT, text.size() - cursor);
+
+        const auto rowsExpected = _promptRows();
+        VERIFY_ARE_EQUAL(rowsExpected.size(), rowsActual.size());
+        for (size_t i = 0; i < rowsExpected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(String(rowsExpected[i].c_str()), String(rowsActual[i].c_str()));
+        }
+        VERIFY_ARE_EQUAL(_cursorPosition(), cursorActual);
+    }
+
+    TEST_METHOD(EditDoesNotRedrawUnchangedPrefix)
+    {
+        _type(_makeText(1000));
+
+        Log::Comment(L"Mark the first cell of the prompt. Edits near the end shouldn't touch it.");
+        _setCell(promptStart, L"#");
+
+        _press(VK_LEFT, 10);
+        _type(L"xyz");
+        _press(VK_BACK);
+        _press(VK_HOME);
+        _press(VK_END);
+
+        VERIFY_ARE_EQUAL(L'#', _getCell(promptStart));
+    }
+
+    TEST_METHOD(OverwriteDoesNotRedrawUnchangedSuffix)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        _type(_makeText(1000));
+        const auto end = gci.CookedReadData().GetBoundaries().end;
+        VERIFY_IS_GREATER_THAN(end.x, 0);
+        const til::point last{ end.x - 1, end.y };
+
+        Log::Comment(L"Mark the last cell of the prompt. Overwriting text in the middle with text of the same width shouldn't touch it.");
+        _setCell(last, L"#");
+
+        gci.CookedReadData().SetInsertMode(false);
+        _press(VK_HOME);
+        // 396 is a multiple of the length of the pattern used by _makeText, so this overwrites "abc".
+        _press(VK_RIGHT, 396);
+        _type(L"xyz");
+
+        VERIFY_ARE_EQUAL(L'#', _getCell(last));
+
+        Log::Comment(L"A change in width has to redraw everything after it.");
+        _type(L"\u3042");
+
+        VERIFY_ARE_NOT_EQUAL(L'#', _getCell(last));
+    }
+
+    TEST_METHOD(EditLongPromptBenchmark)
+    {
+        Log::Comment(L"Edits the middle of a long prompt one key at a time.");
+        Log::Comment(L"Use /p:PromptLength=<count> to change the length of the prompt.");
+
+        size_t length = 4000;
+        {
+            String value;
+            if (SUCCEEDED(RuntimeParameters::TryGetValue(L"PromptLength", value)) && !value.IsEmpty())
+            {
+                length = wcstoul(value, nullptr, 10);
+            }
+        }
+
+        auto beg = std::chrono::steady_clock::now();
+        _type(_makeText(length));
+        auto end = std::chrono::steady_clock::now();
+        Log::Comment(NoThrowString().Format(L"pasting %zu characters: %lldus", length, std::chrono::duration_cast<std::chrono::microseconds>(end - beg).count()));
+
+        _press(VK_LEFT, length / 2);
+
+        static constexpr size_t edits = 200;
+        beg = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < edits; ++i)
+        {
+            _type(L"x");
+            _press(i % 2 ? VK_BACK : VK_LEFT);
+        }
+        end = std::chrono::steady_clock::now();
+        Log::Comment(NoThrowString().Format(L"%zu edits in the middle: %lldus", 2 * edits, std::chrono::duration_cast<std::chrono::microseconds>(end - beg).count()));
+    }
+};
@@ -242,7 +242,160 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandMatchesLinearSearch)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        static constexpr std::array<std::wstring_view, 8> prefixes{ L"d", L"dir", L"dir /w", L"ip", L"ipconfig", L"net", L"x", L"dir /p /w /x" };
+
+        const auto verifyAll = [&]() {
+            for (const auto prefix : prefixes)
+            {
+                for (CommandHistory::Index start = -1; start <= history->GetNumberOfCommands(); ++start)
+                {
+                    for (const auto options : { CommandHistory::MatchOptions::JustLooking, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch })
+                    {
+                        CommandHistory::Index expected;
+                        const auto expectedFound = _LinearFindMatchingCommand(*history, prefix, start, expected, options);
+                        CommandHistory::Index actual;
+                        const auto actualFound = history->FindMatchingCommand(prefix, start, actual, options);
+                        const auto msg = NoThrowString().Format(L"prefix=%.*s start=%d", gsl::narrow_cast<int>(prefix.size()), prefix.data(), start);
+                        VERIFY_ARE_EQUAL(expectedFound, actualFound, msg);
+                        if (expectedFound)
+                        {
+                            VERIFY_ARE_EQUAL(expected, actual, msg);
+                        }
+                    }
+                }
+            }
+        };
+
+        Log::Comment(L"Add more commands than fit, with duplicates, so that the oldest get evicted.");
+        for (size_t i = 0; i < 3 * _manyHistoryItems.size(); i++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[(i * 7) % _manyHistoryItems.size()], i % 2 == 0));
+            verifyAll();
+        }
+
+        Log::Comment(L"Remove, swap and shrink.");
+        history->Remove(3);
+        verifyAll();
+        history->Swap(0, history->GetNumberOfCommands() - 1);
+        verifyAll();
+        history->Swap(1, 2);
+        verifyAll();
+        history->Realloc(5);
+        verifyAll();
+        VERIFY_SUCCEEDED(history->Add(L"dir /w /x", false));
+        verifyAll();
+
+        Log::Comment(L"Empty.");
+        history->Empty();
+        verifyAll();
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        verifyAll();
+    }
+
+    TEST_METHOD(FindByExeReturnsMostRecentlyUsed)
+    {
+        Log::Comment(L"Two histories for the same app, differing in case.");
+        const auto first = CommandHistory::s_Allocate(L"cmd.exe", _MakeHandle(0));
+        const auto second = CommandHistory::s_Allocate(L"CMD.EXE", _MakeHandle(1));
+        VERIFY_IS_NOT_NULL(first);
+        VERIFY_IS_NOT_NULL(second);
+        VERIFY_ARE_NOT_EQUAL(first, second);
+
+        VERIFY_ARE_EQUAL(_LinearFindByExe(L"Cmd.Exe"), CommandHistory::s_FindByExe(L"Cmd.Exe"));
+        VERIFY_ARE_EQUAL(second, CommandHistory::s_FindByExe(L"Cmd.Exe"));
+
+        CommandHistory::s_ReallocExeToFront(L"cmd.exe", s_BufferSize);
+        VERIFY_ARE_EQUAL(_LinearFindByExe(L"cmd.exe"), CommandHistory::s_FindByExe(L"cmd.exe"));
+
+        Log::Comment(L"Freed histories can't be found.");
+        CommandHistory::s_Free(_MakeHandle(0));
+        CommandHistory::s_Free(_MakeHandle(1));
+        VERIFY_IS_NULL(CommandHistory::s_FindByExe(L"cmd.exe"));
+
+        Log::Comment(L"Reusing a freed history for a different app renames it.");
+        for (size_t i = 0; i < s_NumberOfBuffers; i++)
+        {
+            VERIFY_IS_NOT_NULL(CommandHistory::s_Allocate(_manyApps[i], _MakeHandle(10 + i)));
+        }
+        VERIFY_IS_NULL(CommandHistory::s_FindByExe(L"cmd.exe"));
+        for (size_t i = 0; i < s_NumberOfBuffers; i++)
+        {
+            VERIFY_ARE_EQUAL(_LinearFindByExe(_manyApps[i]), CommandHistory::s_FindByExe(_manyApps[i]));
+            VERIFY_IS_NOT_NULL(CommandHistory::s_FindByExe(_manyApps[i]));
+        }
+    }
+
 private:
+    // The linear implementation of CommandHistory::FindMatchingCommand that preceded the prefix index.
+    // Unlike the real one it doesn't modify the history, so it must only be used with JustLooking.
+    static bool _LinearFindMatchingCommand(const CommandHistory& history,
+                                           const std::wstring_view givenCommand,
+                                           const CommandHistory::Index startingIndex,
+                                           CommandHistory::Index& indexFound,
+                                           const CommandHistory::MatchOptions options)
+    {
+        const auto count = history.GetNumberOfCommands();
+        indexFound = startingIndex;
+
+        if (count == 0)
+        {
+            return false;
+        }
+
+        const auto prev = [&]() {
+            if (indexFound <= 0)
+            {
+                indexFound = count;
+            }
+            indexFound--;
+        };
+
+        prev();
+
+        if (givenCommand.empty())
+        {
+            return true;
+        }
+
+        for (CommandHistory::Index i = 0; i < count; i++)
+        {
+            if (indexFound < 0 || indexFound >= count)
+            {
+                return false;
+            }
+
+            const auto storedCommand = history.GetNth(indexFound);
+            if ((WI_IsFlagClear(options, CommandHistory::MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            {
+                if (til::starts_with(storedCommand, givenCommand))
+                {
+                    return true;
+                }
+            }
+
+            prev();
+        }
+
+        return false;
+    }
+
+    static CommandHistory* _LinearFindByExe(const std::wstring_view appName)
+    {
+        for (auto& history : CommandHistory::s_historyLists)
+        {
+            if (WI_IsFlagSet(history.Flags, CommandHistory::CLE_ALLOCATED) && history.IsAppNameMatch(appName))
+            {
+                return &history;
+            }
+        }
+        return nullptr;
+    }
+
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
         L"bar.exe",
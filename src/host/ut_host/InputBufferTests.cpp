@@ -642,4 +642,146 @@ class InputBufferTests
         VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(outEvents.front().Event.KeyEvent.wRepeatCount, 1u);
     }
+
+    TEST_METHOD(StorageWrapsAroundInOrder)
+    {
+        Log::Comment(L"Records must come out in order, even once the storage has wrapped around its end");
+
+        InputBuffer inputBuffer;
+        InputEventQueue inEvents;
+        InputEventQueue outEvents;
+        // Start above the range of virtual key codes, to avoid sending VK_PAUSE by accident.
+        WCHAR nextIn = 0x100;
+        WCHAR nextOut = 0x100;
+
+        // Repeatedly write 11 and read 7 records, so that the head moves
+        // through the storage and the free space wraps around regularly.
+        for (auto iteration = 0; iteration < 64; ++iteration)
+        {
+            inEvents.clear();
+            for (auto i = 0; i < 11; ++i, ++nextIn)
+            {
+                inEvents.push_back(MakeKeyEvent(TRUE, 1, nextIn, 0, nextIn, 0));
+            }
+            VERIFY_ARE_EQUAL(inputBuffer.Write(inEvents), inEvents.size());
+
+            outEvents.clear();
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 7, false, false, true, false));
+            VERIFY_ARE_EQUAL(outEvents.size(), 7u);
+            for (const auto& event : outEvents)
+            {
+                VERIFY_ARE_EQUAL(event.Event.KeyEvent.uChar.UnicodeChar, nextOut++);
+            }
+        }
+
+        // Prepending to a wrapped storage must keep the existing records in order as well.
+        const auto prependRecord = MakeKeyEvent(TRUE, 1, L'!', 0, L'!', 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Prepend({ &prependRecord, 1 }), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), static_cast<size_t>(nextIn - nextOut + 1));
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), prependRecord);
+
+        outEvents.clear();
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 1, false, false, true, false));
+        outEvents.clear();
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, SIZE_MAX, false, false, true, false));
+        VERIFY_ARE_EQUAL(outEvents.size(), static_cast<size_t>(nextIn - nextOut));
+        for (const auto& event : outEvents)
+        {
+            VERIFY_ARE_EQUAL(event.Event.KeyEvent.uChar.UnicodeChar, nextOut++);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(BatchedWritesWakeUpReadersOnce)
+    {
+        InputBuffer inputBuffer;
+        const auto record = MakeKeyEvent(TRUE, 1, L'a', 0, L'a', 0);
+        const auto wakeupsBefore = inputBuffer.GetStatistics().wakeups;
+
+        {
+            const auto batch = inputBuffer.BatchWakeups();
+            for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+            {
+                VERIFY_IS_GREATER_THAN(inputBuffer.Write(record), 0u);
+            }
+            VERIFY_ARE_EQUAL(inputBuffer.GetStatistics().wakeups, wakeupsBefore);
+        }
+
+        VERIFY_ARE_EQUAL(inputBuffer.GetStatistics().wakeups, wakeupsBefore + 1);
+        VERIFY_ARE_EQUAL(inputBuffer.GetStatistics().recordsCoalesced, RECORD_INSERT_COUNT - 1);
+
+        // An empty batch mustn't cause a wakeup.
+        {
+            const auto batch = inputBuffer.BatchWakeups();
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetStatistics().wakeups, wakeupsBefore + 1);
+    }
+
+    TEST_METHOD(PasteSizedInputBenchmark)
+    {
+        Log::Comment(L"Writes a paste-sized amount of key events the way VtInputThread does and reads them back.");
+        Log::Comment(L"Use /p:PasteSize=<chars> to change the size of the simulated paste.");
+
+        size_t pasteSize = 64 * 1024;
+        {
+            WEX::Common::String value;
+            if (SUCCEEDED(WEX::TestExecution::RuntimeParameters::TryGetValue(L"PasteSize", value)) && !value.IsEmpty())
+            {
+                pasteSize = wcstoul(value, nullptr, 10);
+            }
+        }
+
+        // Every character of a paste results in a key-down and a key-up record.
+        InputEventQueue paste;
+        paste.reserve(pasteSize * 2);
+        for (size_t i = 0; i < pasteSize; ++i)
+        {
+            const auto ch = static_cast<WCHAR>(L'a' + i % 26);
+            paste.push_back(MakeKeyEvent(TRUE, 1, ch, 0, ch, 0));
+            paste.push_back(MakeKeyEvent(FALSE, 1, ch, 0, ch, 0));
+        }
+
+        InputBuffer inputBuffer;
+        InputEventQueue outEvents;
+        outEvents.reserve(paste.size());
+
+        // VtInputThread writes one record per call while batching wakeups per chunk it read.
+        const auto writeBeg = std::chrono::steady_clock::now();
+        {
+            const auto batch = inputBuffer.BatchWakeups();
+            for (const auto& record : paste)
+            {
+                inputBuffer.Write(record);
+            }
+        }
+        const auto writeEnd = std::chrono::steady_clock::now();
+
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), paste.size());
+
+        // Clients like ReadConsoleInput usually read in chunks of a few hundred records.
+        const auto readBeg = std::chrono::steady_clock::now();
+        while (inputBuffer.GetNumberOfReadyEvents())
+        {
+            InputEventQueue chunk;
+            VERIFY_NT_SUCCESS(inputBuffer.Read(chunk, 512, false, false, true, false));
+            outEvents.insert(outEvents.end(), chunk.begin(), chunk.end());
+        }
+        const auto readEnd = std::chrono::steady_clock::now();
+
+        VERIFY_ARE_EQUAL(outEvents.size(), paste.size());
+        VERIFY_ARE_EQUAL(0, memcmp(outEvents.data(), paste.data(), paste.size() * sizeof(INPUT_RECORD)));
+
+        const auto& stats = inputBuffer.GetStatistics();
+        const auto writeUs = std::chrono::duration_cast<std::chrono::microseconds>(writeEnd - writeBeg).count();
+        const auto readUs = std::chrono::duration_cast<std::chrono::microseconds>(readEnd - readBeg).count();
+        Log::Comment(NoThrowString().Format(L"records: %zu, write: %lldus, read: %lldus", paste.size(), writeUs, readUs));
+        Log::Comment(NoThrowString().Format(L"writes: %zu, coalesced: %zu, wakeups: %zu, peak: %zu",
+                                            stats.writes,
+                                            stats.recordsCoalesced,
+                                            stats.wakeups,
+                                            stats.peakSize));
+
+        VERIFY_ARE_EQUAL(stats.wakeups, 1u);
+        VERIFY_ARE_EQUAL(stats.peakSize, paste.size());
+    }
 };
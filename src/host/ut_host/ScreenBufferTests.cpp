@@ -102,6 +102,8 @@ class ScreenBufferTests
 
     TEST_METHOD(AlternateBufferCursorInheritanceTest);
 
+    TEST_METHOD(AlternateBufferTextBufferIsRecycled);
+
     TEST_METHOD(TestReverseLineFeed);
 
     TEST_METHOD(TestResetClearTabStops);
@@ -262,6 +264,7 @@ class ScreenBufferTests
     TEST_METHOD(CopyDoubleWidthRectangularArea);
 
     TEST_METHOD(DelayedWrapReset);
+    TEST_METHOD(DelayedWrapJoinsGraphemeCluster);
 
     TEST_METHOD(EraseColorMode);
 };
@@ -451,6 +454,49 @@ void ScreenBufferTests::AlternateBufferCursorInheritanceTest()
     VERIFY_ARE_EQUAL(altCursorBlinking, mainCursor.IsBlinkingAllowed());
 }
 
+void ScreenBufferTests::AlternateBufferTextBufferIsRecycled()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    auto& mainBuffer = gci.GetActiveOutputBuffer();
+    VERIFY_IS_NULL(mainBuffer._recycledAltTextBuffer.get());
+
+    Log::Comment(L"Write some text into the first alternate buffer.");
+    VERIFY_SUCCEEDED(mainBuffer.UseAlternateScreenBuffer({}));
+    auto altBuffer = &gci.GetActiveOutputBuffer();
+    const auto altTextBuffer = &altBuffer->GetTextBuffer();
+    altBuffer->GetStateMachine().ProcessString(L"\x1b[31mfoo\nbar");
+    altBuffer->UseMainScreenBuffer();
+
+    Log::Comment(L"The main buffer keeps the alternate buffer's text buffer around.");
+    VERIFY_ARE_EQUAL(altTextBuffer, mainBuffer._recycledAltTextBuffer.get());
+
+    Log::Comment(L"The next alternate buffer reuses it, but doesn't show the old contents.");
+    VERIFY_SUCCEEDED(mainBuffer.UseAlternateScreenBuffer({}));
+    altBuffer = &gci.GetActiveOutputBuffer();
+    auto& textBuffer = altBuffer->GetTextBuffer();
+    VERIFY_ARE_EQUAL(altTextBuffer, &textBuffer);
+    VERIFY_IS_NULL(mainBuffer._recycledAltTextBuffer.get());
+
+    const auto blankRow = std::wstring(textBuffer.GetSize().Width(), L' ');
+    for (til::CoordType y = 0; y < 2; ++y)
+    {
+        VERIFY_ARE_EQUAL(std::wstring_view{ blankRow }, textBuffer.GetRowByOffset(y).GetText());
+        VERIFY_ARE_EQUAL(altBuffer->GetAttributes(), textBuffer.GetRowByOffset(y).GetAttrByColumn(0));
+    }
+    VERIFY_ARE_EQUAL(mainBuffer.GetTextBuffer().GetCursor().GetPosition(), textBuffer.GetCursor().GetPosition());
+    altBuffer->UseMainScreenBuffer();
+
+    Log::Comment(L"Resizing the main buffer drops the recycled text buffer.");
+    VERIFY_IS_NOT_NULL(mainBuffer._recycledAltTextBuffer.get());
+    auto newBufferSize = mainBuffer.GetBufferSize().Dimensions();
+    newBufferSize.width += 1;
+    VERIFY_SUCCEEDED(mainBuffer.ResizeScreenBuffer(newBufferSize, false));
+    VERIFY_IS_NULL(mainBuffer._recycledAltTextBuffer.get());
+}
+
 void ScreenBufferTests::TestReverseLineFeed()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -8308,6 +8354,36 @@ void ScreenBufferTests::DelayedWrapReset()
     }
 }
 
+void ScreenBufferTests::DelayedWrapJoinsGraphemeCluster()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& textBuffer = si.GetTextBuffer();
+    auto& cursor = textBuffer.GetCursor();
+    const auto width = textBuffer.GetSize().Width();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    const auto startRow = 5;
+    const auto startPos = til::point{ width - 1, startRow };
+
+    Log::Comment(L"A combining mark written separately after the last column should join the glyph there");
+    cursor.SetPosition(startPos);
+    stateMachine.ProcessCharacter(L'X');
+    VERIFY_IS_TRUE(cursor.IsDelayedEOLWrap());
+    stateMachine.ProcessString(L"\u0301");
+    VERIFY_IS_TRUE(cursor.IsDelayedEOLWrap());
+    VERIFY_ARE_EQUAL(startPos, cursor.GetPosition());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"X\u0301" }, textBuffer.GetRowByOffset(startRow).GlyphAt(width - 1));
+
+    Log::Comment(L"Anything that doesn't join the glyph should still wrap onto the next line");
+    stateMachine.ProcessString(L"\u0302Y");
+    VERIFY_IS_FALSE(cursor.IsDelayedEOLWrap());
+    VERIFY_ARE_EQUAL(til::point(1, startRow + 1), cursor.GetPosition());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"X\u0301\u0302" }, textBuffer.GetRowByOffset(startRow).GlyphAt(width - 1));
+    VERIFY_ARE_EQUAL(L"Y", textBuffer.GetRowByOffset(startRow + 1).GlyphAt(0));
+}
+
 void ScreenBufferTests::EraseColorMode()
 {
     BEGIN_TEST_METHOD_PROPERTIES()
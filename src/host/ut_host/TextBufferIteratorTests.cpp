@@ -10,6 +10,7 @@
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
 #include "../buffer/out/textBufferCellIterator.hpp"
+#include "../buffer/out/textBufferRunIterator.hpp"
 #include "../buffer/out/textBufferTextIterator.hpp"
 
 #include "input.h"
@@ -314,6 +315,9 @@ class TextBufferIteratorTests
 
     TEST_METHOD(ConstructedNoLimit);
     TEST_METHOD(ConstructedLimits);
+
+    TEST_METHOD(RunIteratorMatchesCells);
+    TEST_METHOD(RunIteratorBenchmark);
 };
 
 void TextBufferIteratorTests::BoolOperatorText()
@@ -581,3 +585,130 @@ void TextBufferIteratorTests::ConstructedLimits()
                            wil::ResultException,
                            [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
 }
+
+void TextBufferIteratorTests::RunIteratorMatchesCells()
+{
+    m_state->FillTextBuffer();
+
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+    const auto width = textBuffer.GetSize().Width();
+
+    // Give the last row a few short attribute runs, some of which split a wide glyph in half.
+    const til::CoordType y = 4;
+    auto& row = textBuffer.GetMutableRowByOffset(y);
+    row.ReplaceCharacters(2, 2, L"\u304B");
+    row.ReplaceCharacters(6, 2, L"\u304B");
+    row.ReplaceAttributes(3, 4, TextAttribute{ FOREGROUND_RED });
+    row.ReplaceAttributes(7, 9, TextAttribute{ FOREGROUND_GREEN });
+
+    for (til::CoordType rowIndex = 0; rowIndex <= y; ++rowIndex)
+    {
+        const auto& currentRow = textBuffer.GetRowByOffset(rowIndex);
+        auto cellIt = textBuffer.GetCellLineDataAt({ 1, rowIndex });
+        til::CoordType expectedBegin = 1;
+        std::optional<TextAttribute> previousAttr;
+
+        for (TextBufferRunIterator it{ currentRow, 1, width }; it; ++it)
+        {
+            VERIFY_ARE_EQUAL(expectedBegin, it->columnBegin);
+            VERIFY_IS_LESS_THAN(it->columnBegin, it->columnEnd);
+            VERIFY_ARE_EQUAL(currentRow.DbcsAttrAt(it->columnBegin) == DbcsAttribute::Trailing, it->leadingHalfClipped);
+            VERIFY_ARE_EQUAL(currentRow.DbcsAttrAt(it->columnEnd - 1) == DbcsAttribute::Leading, it->trailingHalfClipped);
+
+            // Runs should be as long as possible.
+            if (previousAttr)
+            {
+                VERIFY_ARE_NOT_EQUAL(*previousAttr, it->attr);
+            }
+            previousAttr = it->attr;
+
+            for (auto column = it->columnBegin; column < it->columnEnd; ++column, ++cellIt)
+            {
+                VERIFY_ARE_EQUAL(cellIt->TextAttr(), it->attr);
+                VERIFY_ARE_NOT_EQUAL(std::wstring_view::npos, it->text.find(cellIt->Chars()));
+            }
+
+            expectedBegin = it->columnEnd;
+        }
+
+        VERIFY_ARE_EQUAL(width, expectedBegin);
+    }
+}
+
+void TextBufferIteratorTests::RunIteratorBenchmark()
+{
+    Log::Comment(L"Compares the attributes of every row in the buffer, once cell by cell and once run by run.");
+    Log::Comment(L"Use /p:RunIterations=<count> to change the number of passes over the buffer.");
+
+    size_t iterations = 100;
+    {
+        String value;
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"RunIterations", value)) && !value.IsEmpty())
+        {
+            iterations = wcstoul(value, nullptr, 10);
+        }
+    }
+
+    m_state->FillTextBuffer();
+
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+    const auto size = textBuffer.GetSize();
+
+    // Colored words, like the output of a compiler or `ls` would have them.
+    for (auto y = size.Top(); y < size.BottomExclusive(); ++y)
+    {
+        auto& row = textBuffer.GetMutableRowByOffset(y);
+        for (auto x = size.Left(); x < size.RightExclusive(); x += 8)
+        {
+            row.ReplaceAttributes(x, std::min(x + 5, size.RightExclusive()), TextAttribute{ gsl::narrow_cast<WORD>(1 + (x / 8) % 15) });
+        }
+    }
+
+    size_t cellChanges = 0;
+    size_t runChanges = 0;
+    std::chrono::steady_clock::duration cellTime{};
+    std::chrono::steady_clock::duration runTime{};
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        cellChanges = 0;
+        runChanges = 0;
+
+        const auto cellBeg = std::chrono::steady_clock::now();
+        for (auto y = size.Top(); y < size.BottomExclusive(); ++y)
+        {
+            std::optional<TextAttribute> previousAttr;
+            for (auto it = textBuffer.GetCellLineDataAt({ size.Left(), y }); it; ++it)
+            {
+                if (previousAttr != it->TextAttr())
+                {
+                    previousAttr = it->TextAttr();
+                    cellChanges++;
+                }
+            }
+        }
+        const auto cellEnd = std::chrono::steady_clock::now();
+
+        const auto runBeg = std::chrono::steady_clock::now();
+        for (auto y = size.Top(); y < size.BottomExclusive(); ++y)
+        {
+            for (TextBufferRunIterator it{ textBuffer.GetRowByOffset(y), size.Left(), size.RightExclusive() }; it; ++it)
+            {
+                runChanges++;
+            }
+        }
+        const auto runEnd = std::chrono::steady_clock::now();
+
+        cellTime += cellEnd - cellBeg;
+        runTime += runEnd - runBeg;
+    }
+
+    VERIFY_ARE_EQUAL(cellChanges, runChanges);
+
+    const auto passes = gsl::narrow_cast<long long>(std::max<size_t>(iterations, 1));
+    const auto cellUs = std::chrono::duration_cast<std::chrono::microseconds>(cellTime).count() / passes;
+    const auto runUs = std::chrono::duration_cast<std::chrono::microseconds>(runTime).count() / passes;
+    Log::Comment(NoThrowString().Format(L"passes: %zu, runs: %zu, cells: %lldus/pass, runs: %lldus/pass", iterations, runChanges, cellUs, runUs));
+}
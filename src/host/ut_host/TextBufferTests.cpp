@@ -12,6 +12,7 @@
 
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
+#include "../buffer/out/UTextAdapter.h"
 
 #include "input.h"
 #include "_stream.h"
@@ -148,11 +149,17 @@ class TextBufferTests
     TEST_METHOD(TestBurrito);
     TEST_METHOD(TestOverwriteChars);
     TEST_METHOD(TestRowReplaceText);
+    TEST_METHOD(SpanWritesMatchOutputCellIterator);
+    TEST_METHOD(SpanReadsMatchCellIterator);
+    TEST_METHOD(ChangeJournal);
+    TEST_METHOD(GraphemeClusters);
+    TEST_METHOD(UTextRandomAccess);
 
     TEST_METHOD(TestAppendRTFText);
 
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
+    TEST_METHOD(GetWordBoundariesMixedText);
     TEST_METHOD(MoveByWord);
     TEST_METHOD(GetGlyphBoundaries);
 
@@ -2084,6 +2091,427 @@ void TextBufferTests::TestRowReplaceText()
 #undef complex
 }
 
+void TextBufferTests::SpanWritesMatchOutputCellIterator()
+{
+    static constexpr til::size bufferSize{ 9, 4 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer expected{ bufferSize, attr, cursorSize, false, _renderer };
+    TextBuffer actual{ bufferSize, attr, cursorSize, false, _renderer };
+
+    const auto verifyBuffers = [&]() {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            const auto& e = expected.GetRowByOffset(y);
+            const auto& a = actual.GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(e.GetText(), a.GetText());
+            VERIFY_ARE_EQUAL(e.WasWrapForced(), a.WasWrapForced());
+            VERIFY_ARE_EQUAL(e.WasDoubleBytePadded(), a.WasDoubleBytePadded());
+            for (til::CoordType x = 0; x < bufferSize.width; ++x)
+            {
+                VERIFY_IS_TRUE(e.DbcsAttrAt(x) == a.DbcsAttrAt(x));
+                VERIFY_IS_TRUE(e.GetAttrByColumn(x) == a.GetAttrByColumn(x));
+            }
+        }
+    };
+
+    Log::Comment(L"Text with a wide glyph that doesn't fit into the last column.");
+    {
+        static constexpr std::wstring_view text{ L"abc\u304Bd\u304Be\u304Bfg" };
+        const OutputCellIterator it{ text };
+        const auto done = expected.Write(it, { 2, 0 });
+        const auto used = actual.WriteText({ 2, 0 }, text);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(done.GetInputDistance(it)), used);
+        verifyBuffers();
+    }
+
+    Log::Comment(L"Filling with a wide glyph across rows, without wrapping.");
+    {
+        const OutputCellIterator it{ L'\u304B', 7 };
+        const auto done = expected.Write(it, { 4, 1 }, false);
+        const auto used = actual.FillText({ 4, 1 }, L'\u304B', 7, false);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(done.GetInputDistance(it)), used);
+        verifyBuffers();
+    }
+
+    Log::Comment(L"Legacy attributes with lead/trail byte flags, across rows.");
+    {
+        static constexpr std::array<WORD, 12> attrs{
+            FOREGROUND_RED,
+            FOREGROUND_RED | COMMON_LVB_LEADING_BYTE,
+            FOREGROUND_RED | COMMON_LVB_TRAILING_BYTE,
+            FOREGROUND_GREEN,
+            FOREGROUND_GREEN,
+            BACKGROUND_BLUE,
+            BACKGROUND_BLUE,
+            BACKGROUND_BLUE,
+            FOREGROUND_RED,
+            FOREGROUND_RED,
+            FOREGROUND_GREEN,
+            FOREGROUND_GREEN,
+        };
+        const OutputCellIterator it{ attrs };
+        const auto done = expected.Write(it, { 6, 0 });
+        const auto used = actual.WriteAttributes({ 6, 0 }, attrs);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(done.GetCellDistance(it)), used);
+        verifyBuffers();
+    }
+
+    Log::Comment(L"Filling attributes across rows.");
+    {
+        const TextAttribute fill{ BACKGROUND_GREEN };
+        const OutputCellIterator it{ fill, 11 };
+        const auto done = expected.Write(it, { 5, 1 });
+        const auto used = actual.FillAttributes({ 5, 1 }, fill, 11);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(done.GetCellDistance(it)), used);
+        verifyBuffers();
+    }
+
+    Log::Comment(L"CHAR_INFOs starting with a trailing half and ending with a leading half.");
+    {
+        static constexpr std::array<CHAR_INFO, 6> charInfos{ {
+            { { L'\u304B' }, FOREGROUND_RED | COMMON_LVB_TRAILING_BYTE },
+            { { L'x' }, FOREGROUND_RED },
+            { { L'\u304B' }, FOREGROUND_GREEN | COMMON_LVB_LEADING_BYTE },
+            { { L'\u304B' }, FOREGROUND_GREEN | COMMON_LVB_TRAILING_BYTE },
+            { { L'y' }, BACKGROUND_BLUE },
+            { { L'\u304B' }, BACKGROUND_BLUE | COMMON_LVB_LEADING_BYTE },
+        } };
+        const OutputCellIterator it{ charInfos };
+        expected.Write(it, { 2, 3 });
+        const auto used = actual.WriteCharInfos({ 2, 3 }, charInfos);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<til::CoordType>(charInfos.size()), used);
+        verifyBuffers();
+    }
+}
+
+void TextBufferTests::SpanReadsMatchCellIterator()
+{
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    static constexpr til::size bufferSize{ 12, 2 };
+    static constexpr UINT cursorSize = 12;
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x7f }, cursorSize, false, _renderer };
+
+    TextAttribute rgb{ FOREGROUND_GREEN };
+    rgb.SetForeground(RGB(64, 128, 255));
+    rgb.SetBackground(RGB(32, 0, 0));
+
+    // Row 0: Wide glyphs, a surrogate pair and a wide glyph that gets padded at the end.
+    buffer.WriteText({ 0, 0 }, L"a\u304Bb\U0001F600c\u304Bde\u304B", false);
+    buffer.FillAttributes({ 1, 0 }, TextAttribute{ FOREGROUND_RED }, 3);
+    buffer.FillAttributes({ 4, 0 }, rgb, 5);
+    // Row 1: Attribute runs that begin and end inside of wide glyphs.
+    buffer.FillText({ 0, 1 }, L'\u304B', 6, false);
+    buffer.FillAttributes({ 1, 1 }, TextAttribute{ BACKGROUND_BLUE }, 2);
+    buffer.FillAttributes({ 5, 1 }, rgb, 4);
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        for (til::CoordType begin = 0; begin < bufferSize.width; ++begin)
+        {
+            for (auto end = begin + 1; end <= bufferSize.width; ++end)
+            {
+                const auto limit = Viewport::FromExclusive({ begin, y, end, y + 1 });
+                std::vector<CHAR_INFO> expected;
+                for (auto it = buffer.GetCellDataAt({ begin, y }, limit); it; ++it)
+                {
+                    expected.emplace_back(gci.AsCharInfo(*it));
+                }
+
+                std::vector<CHAR_INFO> actual(expected.size());
+                const auto read = buffer.ReadCharInfos({ begin, y }, actual);
+                VERIFY_ARE_EQUAL(gsl::narrow_cast<til::CoordType>(expected.size()), read);
+                for (size_t i = 0; i < expected.size(); ++i)
+                {
+                    VERIFY_ARE_EQUAL(expected[i], actual[i], NoThrowString().Format(L"y=%d begin=%d end=%d i=%zu", y, begin, end, i));
+                }
+            }
+        }
+    }
+
+    Log::Comment(L"Reads are clamped to the end of the row.");
+    {
+        std::vector<CHAR_INFO> actual(bufferSize.width);
+        VERIFY_ARE_EQUAL(4, buffer.ReadCharInfos({ 8, 1 }, actual));
+    }
+}
+
+void TextBufferTests::ChangeJournal()
+{
+    using Rows = std::vector<std::pair<til::CoordType, til::CoordType>>;
+
+    static constexpr til::size bufferSize{ 10, 8 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    const auto touch = [&](til::CoordType y) {
+        buffer.GetMutableRowByOffset(y).ReplaceCharacters(0, 1, L"x");
+    };
+
+    Log::Comment(L"Without a journal, consumers always need to invalidate everything.");
+    {
+        const auto position = buffer.GetJournalPosition();
+        VERIFY_IS_TRUE(buffer.GetChangesSince(position).invalidateAll);
+    }
+
+    buffer.EnableChangeJournal(2);
+
+    Log::Comment(L"Neighboring rows are coalesced.");
+    const auto position0 = buffer.GetJournalPosition();
+    touch(1);
+    touch(2);
+    {
+        const auto changes = buffer.GetChangesSince(position0);
+        VERIFY_IS_FALSE(changes.invalidateAll);
+        VERIFY_ARE_EQUAL(0, changes.scrolled);
+        VERIFY_IS_TRUE(changes.dirtyRows == Rows{ { 1, 3 } });
+    }
+
+    Log::Comment(L"Rotating the buffer shifts earlier changes and dirties the new bottom row.");
+    const auto position1 = buffer.GetJournalPosition();
+    buffer.IncrementCircularBuffer();
+    touch(0);
+    {
+        // The write to row 0 got coalesced with the earlier ones, which is why this reports more than necessary.
+        const auto changes = buffer.GetChangesSince(position1);
+        VERIFY_IS_FALSE(changes.invalidateAll);
+        VERIFY_ARE_EQUAL(1, changes.scrolled);
+        VERIFY_IS_TRUE(changes.dirtyRows == (Rows{ { 0, 2 }, { 7, 8 } }));
+    }
+    {
+        const auto changes = buffer.GetChangesSince(position0);
+        VERIFY_IS_FALSE(changes.invalidateAll);
+        VERIFY_ARE_EQUAL(1, changes.scrolled);
+        VERIFY_IS_TRUE(changes.dirtyRows == (Rows{ { 0, 2 }, { 7, 8 } }));
+    }
+
+    Log::Comment(L"Evicting an entry invalidates everyone who hasn't seen it yet.");
+    touch(4);
+    const auto position2 = buffer.GetJournalPosition();
+    touch(6);
+    {
+        VERIFY_IS_TRUE(buffer.GetChangesSince(position0).invalidateAll);
+        const auto changes = buffer.GetChangesSince(position2);
+        VERIFY_IS_FALSE(changes.invalidateAll);
+        VERIFY_IS_TRUE(changes.dirtyRows == Rows{ { 6, 7 } });
+    }
+
+    Log::Comment(L"Resetting the buffer invalidates all prior positions.");
+    buffer.Reset();
+    {
+        VERIFY_IS_TRUE(buffer.GetChangesSince(position2).invalidateAll);
+        const auto changes = buffer.GetChangesSince(buffer.GetJournalPosition());
+        VERIFY_IS_FALSE(changes.invalidateAll);
+        VERIFY_IS_TRUE(changes.dirtyRows.empty());
+    }
+}
+
+void TextBufferTests::GraphemeClusters()
+{
+    Log::Comment(L"GraphemeNext/GraphemePrev step over extended grapheme clusters in both directions.");
+    {
+        struct Test
+        {
+            std::wstring_view text;
+            std::vector<size_t> boundaries;
+        };
+
+        // clang-format off
+        const std::vector<Test> tests{
+            { L"abc", { 0, 1, 2, 3 } },
+            { L"a\r\nb", { 0, 1, 3, 4 } },
+            { L"e\u0301e\u0301\u0302", { 0, 2, 5 } },
+            { L"x\U0001F600y", { 0, 1, 3, 4 } },
+            // MAN, ZWJ, WOMAN, ZWJ, GIRL
+            { L"\U0001F468\u200D\U0001F469\u200D\U0001F467!", { 0, 8, 9 } },
+            // Regional indicators pair up: US, DE and a lone U
+            { L"\U0001F1FA\U0001F1F8\U0001F1E9\U0001F1EA\U0001F1FA", { 0, 4, 8, 10 } },
+            // THUMBS UP, skin tone modifier
+            { L"\U0001F44D\U0001F3FD.", { 0, 4, 5 } },
+            // Hangul L, V, T jamo and a precomposed LV syllable followed by a T jamo
+            { L"\u1100\u1161\u11A8\uAC00\u11A8", { 0, 3, 5 } },
+            // Devanagari KA, VIRAMA, SSA (GB9c isn't implemented) and a SpacingMark
+            { L"\u0915\u094D\u0937\u093F", { 0, 2, 4 } },
+            // A ZWJ not preceded by an Extended_Pictographic doesn't join the following emoji
+            { L"a\u200D\U0001F600", { 0, 2, 4 } },
+            // Unpaired surrogates are clusters of their own
+            { L"\xD800" L"a" L"\xDC00", { 0, 1, 2, 3 } },
+        };
+        // clang-format on
+
+        for (const auto& test : tests)
+        {
+            std::vector<size_t> forward{ 0 };
+            for (size_t i = 0; i < test.text.size();)
+            {
+                i = TextBuffer::GraphemeNext(test.text, i);
+                forward.emplace_back(i);
+            }
+            VERIFY_IS_TRUE(forward == test.boundaries);
+
+            std::vector<size_t> backward{ test.text.size() };
+            for (auto i = test.text.size(); i > 0;)
+            {
+                i = TextBuffer::GraphemePrev(test.text, i);
+                backward.insert(backward.begin(), i);
+            }
+            VERIFY_IS_TRUE(backward == test.boundaries);
+        }
+    }
+
+    Log::Comment(L"ROW stores each grapheme cluster in a single cell.");
+    {
+        static constexpr til::size bufferSize{ 10, 1 };
+        static constexpr UINT cursorSize = 12;
+        const TextAttribute attr{ 0x7f };
+        TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+        auto& row = buffer.GetMutableRowByOffset(0);
+
+        // The combining mark must be joined with the preceding ASCII character, even though
+        // that one was already written by the ASCII fast-path in ROW::ReplaceText.
+        RowWriteState state{ .text = L"ae\u0301\U0001F600\u200D\U0001F525z" };
+        row.ReplaceText(state);
+
+        VERIFY_IS_TRUE(state.text.empty());
+        VERIFY_ARE_EQUAL(5, state.columnEnd);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"a" }, row.GlyphAt(0));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"e\u0301" }, row.GlyphAt(1));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\U0001F600\u200D\U0001F525" }, row.GlyphAt(2));
+        VERIFY_IS_TRUE(row.DbcsAttrAt(2) == DbcsAttribute::Leading);
+        VERIFY_IS_TRUE(row.DbcsAttrAt(3) == DbcsAttribute::Trailing);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"z" }, row.GlyphAt(4));
+
+        // A cluster that follows a row full of ASCII gets joined with the last cell and must not be left over.
+        state = RowWriteState{ .text = L"0123456789\u0301", .columnBegin = 0, .columnLimit = bufferSize.width };
+        row.ReplaceText(state);
+
+        VERIFY_IS_TRUE(state.text.empty());
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"9\u0301" }, row.GlyphAt(9));
+    }
+
+    Log::Comment(L"Clusters that are split across writes are joined as if they were written at once.");
+    {
+        static constexpr til::size bufferSize{ 10, 1 };
+        static constexpr UINT cursorSize = 12;
+        const TextAttribute attr{ 0x7f };
+        TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+        auto& row = buffer.GetMutableRowByOffset(0);
+
+        static constexpr std::wstring_view writes[]{ L"ae", L"\u0301", L"\U0001F600\u200D", L"\U0001F525", L"\u0302z", L"\U0001F1E9", L"\U0001F1EA" };
+        til::CoordType column = 0;
+        for (const auto& text : writes)
+        {
+            RowWriteState state{ .text = text, .columnBegin = column, .columnLimit = bufferSize.width, .joinPrecedingGlyph = true };
+            row.ReplaceText(state);
+            VERIFY_IS_TRUE(state.text.empty());
+            column = state.columnEnd;
+        }
+
+        VERIFY_ARE_EQUAL(7, column);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"a" }, row.GlyphAt(0));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"e\u0301" }, row.GlyphAt(1));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\U0001F600\u200D\U0001F525\u0302" }, row.GlyphAt(2));
+        VERIFY_IS_TRUE(row.DbcsAttrAt(3) == DbcsAttribute::Trailing);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"z" }, row.GlyphAt(4));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\U0001F1E9\U0001F1EA" }, row.GlyphAt(5));
+
+        Log::Comment(L"Writing over the trailing half of a wide glyph doesn't join with it.");
+        RowWriteState state{ .text = L"\u0301", .columnBegin = 6, .columnLimit = bufferSize.width, .joinPrecedingGlyph = true };
+        row.ReplaceText(state);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, row.GlyphAt(5));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u0301" }, row.GlyphAt(6));
+    }
+
+    Log::Comment(L"Writes at a given position and fills put combining marks and joiners into cells of their own.");
+    {
+        static constexpr til::size bufferSize{ 10, 2 };
+        static constexpr UINT cursorSize = 12;
+        const TextAttribute attr{ 0x7f };
+        TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+        buffer.WriteText({ 0, 0 }, L"abc", false);
+        VERIFY_ARE_EQUAL(1u, buffer.WriteText({ 1, 0 }, L"\u0301", false));
+        VERIFY_ARE_EQUAL(3u, buffer.FillText({ 3, 0 }, L'\u0301', 3, false));
+        VERIFY_ARE_EQUAL(2u, buffer.FillText({ 6, 0 }, L'\u200D', 2, false));
+
+        const auto& row0 = buffer.GetRowByOffset(0);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"a" }, row0.GlyphAt(0));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u0301" }, row0.GlyphAt(1));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"c" }, row0.GlyphAt(2));
+        for (til::CoordType x = 3; x < 6; ++x)
+        {
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"\u0301" }, row0.GlyphAt(x));
+        }
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u200D" }, row0.GlyphAt(6));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u200D" }, row0.GlyphAt(7));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, row0.GlyphAt(8));
+
+        for (const auto fill : { std::wstring_view{ L"\u0301" }, std::wstring_view{ L"\u200D" } })
+        {
+            buffer.FillRect({ 2, 1, 8, 2 }, fill, attr);
+            const auto& row1 = buffer.GetRowByOffset(1);
+            VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, row1.GlyphAt(1));
+            for (til::CoordType x = 2; x < 8; ++x)
+            {
+                VERIFY_ARE_EQUAL(fill, row1.GlyphAt(x));
+            }
+            VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, row1.GlyphAt(8));
+        }
+    }
+}
+
+void TextBufferTests::UTextRandomAccess()
+{
+    // The rows are short enough for the UText to group several of them into a single chunk.
+    static constexpr til::size bufferSize{ 12, 64 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    std::vector<std::wstring> lines;
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        lines.emplace_back(y % 7 == 3 ? std::wstring{ L"\u732B\u732B wide" } : fmt::format(L"row {}", y));
+    }
+    // "abcd" straddles the boundary between rows 40 and 41.
+    lines[40] = L"0123456789ab";
+    lines[41] = L"cd";
+    WriteLinesToBuffer(lines, buffer);
+
+    static constexpr til::CoordType rowBeg = 5;
+    static constexpr til::CoordType rowEnd = 60;
+    std::wstring expected;
+    for (auto y = rowBeg; y < rowEnd; ++y)
+    {
+        expected.append(buffer.GetRowByOffset(y).GetText());
+    }
+
+    Microsoft::Console::ICU::UTextIndex index;
+    auto text = Microsoft::Console::ICU::UTextFromTextBuffer(buffer, rowBeg, rowEnd, index);
+    VERIFY_ARE_EQUAL(gsl::narrow_cast<int64_t>(expected.size()), utext_nativeLength(&text));
+
+    Log::Comment(L"Jumping around the text yields the same characters as the concatenated rows.");
+    for (size_t i = 0, pos = 0; i < expected.size(); ++i, pos = (pos + 197) % expected.size())
+    {
+        VERIFY_ARE_EQUAL(static_cast<UChar32>(expected[pos]), utext_char32At(&text, gsl::narrow_cast<int64_t>(pos)));
+    }
+
+    Log::Comment(L"Iterating backwards from the end yields the same characters as well.");
+    utext_setNativeIndex(&text, utext_nativeLength(&text));
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it)
+    {
+        VERIFY_ARE_EQUAL(static_cast<UChar32>(*it), utext_previous32(&text));
+    }
+    VERIFY_ARE_EQUAL(U_SENTINEL, utext_previous32(&text));
+
+    Log::Comment(L"Matches are mapped back to the rows they were found in.");
+    const auto results = buffer.SearchText(L"abcd", false, rowBeg, rowEnd);
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL((til::point{ 10, 40 }), results[0].start);
+    VERIFY_ARE_EQUAL((til::point{ 1, 41 }), results[0].end);
+}
+
 void TextBufferTests::TestAppendRTFText()
 {
     {
@@ -2247,6 +2675,59 @@ void TextBufferTests::GetWordBoundaries()
     }
 }
 
+void TextBufferTests::GetWordBoundariesMixedText()
+{
+    til::size bufferSize{ 80, 10 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // The rows are long enough to exercise the vectorized delimiter search in ROW and contain
+    // wide glyphs, surrogate pairs, combining marks and a non-ASCII delimiter (U+2502).
+    const std::vector<std::wstring> text = {
+        L"C:\\Windows\\System32\\drivers\\etc\\hosts -> /mnt/c/Windows/System32 --flag=value",
+        L"\u732B\u732B cat\u2502dog \U0001F600\U0001F600 e\u0301e\u0301e\u0301 \u2502\u2502 x  y(z)",
+    };
+    WriteLinesToBuffer(text, *_buffer);
+
+    const std::wstring_view delimiters = L" /\\()\"'-.,:;<>~!@#$%^&*|+=[]{}~?\u2502";
+
+    // This is how DelimiterClassAt() used to work: One column at a time.
+    const auto referenceClassAt = [&](til::point pos) {
+        const auto glyph = _buffer->GetRowByOffset(pos.y).GlyphAt(pos.x).front();
+        if (glyph <= L' ')
+        {
+            return DelimiterClass::ControlChar;
+        }
+        return delimiters.find(glyph) != std::wstring_view::npos ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+    };
+
+    for (til::CoordType y = 0; y < 2; ++y)
+    {
+        for (til::CoordType x = 0; x < bufferSize.width; ++x)
+        {
+            const til::point pos{ x, y };
+            const auto cls = referenceClassAt(pos);
+
+            auto expectedStart = pos;
+            while (expectedStart.x > 0 && referenceClassAt({ expectedStart.x - 1, y }) == cls)
+            {
+                --expectedStart.x;
+            }
+
+            auto expectedEnd = pos;
+            while (expectedEnd.x < bufferSize.width - 1 && referenceClassAt({ expectedEnd.x + 1, y }) == cls)
+            {
+                ++expectedEnd.x;
+            }
+
+            Log::Comment(NoThrowString().Format(L"til::point (%d, %d)", x, y));
+            VERIFY_ARE_EQUAL(expectedStart, _buffer->GetWordStart(pos, delimiters));
+            VERIFY_ARE_EQUAL(expectedEnd, _buffer->GetWordEnd(pos, delimiters));
+        }
+    }
+}
+
 void TextBufferTests::MoveByWord()
 {
     til::size bufferSize{ 80, 9001 };
@@ -12,8 +12,13 @@ Abstract:
 Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
-Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+Back then the decision was made to keep using the platform functions
+MultiByteToWideChar and WideCharToMultiByte. Since the terminal output is
+predominantly ASCII and arrives in small chunks, the conversion is now done
+in-place with an SSE2/NEON fast path for ASCII and a validating scalar
+decoder for everything else. Invalid input is replaced with U+FFFD the same
+way the platform functions do it. TestThroughput in
+src\til\ut_til\u8u16convertTests.cpp compares the throughput of both.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -47,8 +52,298 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
     };
 
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26446 26459 26472 26481 26482 26490) // use not_null, subscript operator, use span, static_cast, pointer arithmetic, dynamic array indexing, reinterpret_cast
+
+        inline constexpr char32_t replacementChar = 0xFFFD;
+
+        struct u8decoded
+        {
+            char32_t cp; // the decoded code point or U+FFFD
+            uint8_t len; // the number of bytes that were consumed
+            bool incomplete; // true if the input ended in the middle of an otherwise valid sequence
+        };
+
+        // Decodes the UTF-8 sequence at `it`. Ill-formed sequences are replaced with U+FFFD
+        // following the Unicode "best practice" of replacing maximal subparts (Unicode section 3.9),
+        // which is also how MultiByteToWideChar behaves: An invalid lead byte consumes 1 byte
+        // and a sequence that's cut short consumes all bytes up to the offending one.
+        constexpr u8decoded u8decode(const char* it, const char* end) noexcept
+        {
+            const auto b0 = static_cast<uint8_t>(*it);
+            // The valid range of the second byte depends on the lead byte, in order to
+            // exclude overlong encodings, surrogates and code points above U+10FFFF.
+            uint8_t lo = 0x80;
+            uint8_t hi = 0xBF;
+            uint8_t trail;
+            char32_t cp;
+
+            if (b0 < 0x80)
+            {
+                return { b0, 1, false };
+            }
+            if (b0 < 0xC2)
+            {
+                return { replacementChar, 1, false };
+            }
+            if (b0 < 0xE0)
+            {
+                trail = 1;
+                cp = b0 & 0x1F;
+            }
+            else if (b0 < 0xF0)
+            {
+                trail = 2;
+                cp = b0 & 0x0F;
+                lo = b0 == 0xE0 ? 0xA0 : 0x80;
+                hi = b0 == 0xED ? 0x9F : 0xBF;
+            }
+            else if (b0 < 0xF5)
+            {
+                trail = 3;
+                cp = b0 & 0x07;
+                lo = b0 == 0xF0 ? 0x90 : 0x80;
+                hi = b0 == 0xF4 ? 0x8F : 0xBF;
+            }
+            else
+            {
+                return { replacementChar, 1, false };
+            }
+
+            for (uint8_t len = 1; len <= trail; ++len)
+            {
+                if (it + len == end)
+                {
+                    return { replacementChar, len, true };
+                }
+
+                const auto b = static_cast<uint8_t>(it[len]);
+                if (b < lo || b > hi)
+                {
+                    return { replacementChar, len, false };
+                }
+
+                cp = (cp << 6) | (b & 0x3F);
+                lo = 0x80;
+                hi = 0xBF;
+            }
+
+            return { cp, static_cast<uint8_t>(trail + 1), false };
+        }
+
+        // Returns the length of the sequence that starts with the given (valid) lead byte.
+        constexpr uint8_t u8length(const char lead) noexcept
+        {
+            const auto b0 = static_cast<uint8_t>(lead);
+            return b0 < 0x80 ? 1 : b0 < 0xE0 ? 2 : b0 < 0xF0 ? 3 : 4;
+        }
+
+        // Converts UTF-8 from `it` to `end` into UTF-16 and returns the new end of `out`, which must have room for
+        // at least `end - it` code units. Pure ASCII is processed 16 and 32 bytes at a time. If `keepIncomplete`
+        // is true, a valid but incomplete sequence at the end of the input is left unconverted and `it`
+        // will point to its start. Otherwise `it` will equal `end` on return.
+        inline wchar_t* u8u16(const char*& it, const char* const end, wchar_t* out, const bool keepIncomplete) noexcept
+        {
+            while (it != end)
+            {
+#if defined(TIL_SSE_INTRINSICS)
+                const auto zero = _mm_setzero_si128();
+
+                for (; end - it >= 32; it += 32, out += 32)
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 16));
+                    if (_mm_movemask_epi8(_mm_or_si128(a, b)))
+                    {
+                        break;
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(a, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(a, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpacklo_epi8(b, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm_unpackhi_epi8(b, zero));
+                }
+
+                while (end - it >= 16)
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    const auto mask = _mm_movemask_epi8(a);
+
+                    // This is safe even if not all 16 bytes are ASCII, because the output always has room
+                    // for at least as many code units as there are remaining input bytes. Any excess
+                    // code units are simply overwritten by the non-ASCII ones that follow.
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(a, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(a, zero));
+
+                    if (mask)
+                    {
+                        unsigned long offset;
+                        _BitScanForward(&offset, mask);
+                        it += offset;
+                        out += offset;
+                        break;
+                    }
+
+                    it += 16;
+                    out += 16;
+                }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+                for (; end - it >= 16; it += 16, out += 16)
+                {
+                    const auto a = vld1q_u8(reinterpret_cast<const uint8_t*>(it));
+                    const auto test = vreinterpretq_u64_u8(vandq_u8(a, vdupq_n_u8(0x80)));
+                    if (vgetq_lane_u64(test, 0) | vgetq_lane_u64(test, 1))
+                    {
+                        break;
+                    }
+                    vst1q_u16(reinterpret_cast<uint16_t*>(out), vmovl_u8(vget_low_u8(a)));
+                    vst1q_u16(reinterpret_cast<uint16_t*>(out + 8), vmovl_u8(vget_high_u8(a)));
+                }
+#endif
+
+                if (it == end)
+                {
+                    break;
+                }
+
+                // Decode code points one by one until we're back at ASCII text.
+                // The fast path above will then pick up from there.
+                do
+                {
+                    const auto d = u8decode(it, end);
+
+                    if (d.incomplete && keepIncomplete)
+                    {
+                        return out;
+                    }
+
+                    if (d.cp < 0x10000)
+                    {
+                        *out++ = static_cast<wchar_t>(d.cp);
+                    }
+                    else
+                    {
+                        *out++ = static_cast<wchar_t>(0xD7C0 + (d.cp >> 10));
+                        *out++ = static_cast<wchar_t>(0xDC00 | (d.cp & 0x3FF));
+                    }
+
+                    it += d.len;
+                } while (it != end && static_cast<uint8_t>(*it) >= 0x80);
+            }
+
+            return out;
+        }
+
+        // Converts UTF-16 from `it` to `end` into UTF-8 and returns the new end of `out`, which must have room for
+        // at least `(end - it) * 3` code units. Pure ASCII is processed 8 and 16 code units at a time. Unpaired
+        // surrogates are replaced with U+FFFD. If `keepIncomplete` is true, a high surrogate at the end of
+        // the input is left unconverted and `it` will point to it. Otherwise `it` will equal `end` on return.
+        inline char* u16u8(const wchar_t*& it, const wchar_t* const end, char* out, const bool keepIncomplete) noexcept
+        {
+            while (it != end)
+            {
+#if defined(TIL_SSE_INTRINSICS)
+                const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+                const auto zero = _mm_setzero_si128();
+
+                for (; end - it >= 16; it += 16, out += 16)
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 8));
+                    const auto test = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, zero)) != 0xFFFF)
+                    {
+                        break;
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+                }
+
+                for (; end - it >= 8; it += 8, out += 8)
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(a, nonAscii), zero)) != 0xFFFF)
+                    {
+                        break;
+                    }
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, a));
+                }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+                for (; end - it >= 8; it += 8, out += 8)
+                {
+                    const auto a = vld1q_u16(reinterpret_cast<const uint16_t*>(it));
+                    const auto test = vreinterpretq_u64_u16(vandq_u16(a, vdupq_n_u16(0xFF80)));
+                    if (vgetq_lane_u64(test, 0) | vgetq_lane_u64(test, 1))
+                    {
+                        break;
+                    }
+                    vst1_u8(reinterpret_cast<uint8_t*>(out), vmovn_u16(a));
+                }
+#endif
+
+                if (it == end)
+                {
+                    break;
+                }
+
+                do
+                {
+                    char32_t cp = *it;
+                    uint8_t len = 1;
+
+                    if (cp >= 0xD800 && cp <= 0xDFFF)
+                    {
+                        if (cp <= 0xDBFF && end - it >= 2 && it[1] >= 0xDC00 && it[1] <= 0xDFFF)
+                        {
+                            cp = (cp << 10) + it[1] - 0x35FDC00;
+                            len = 2;
+                        }
+                        else if (cp <= 0xDBFF && end - it == 1 && keepIncomplete)
+                        {
+                            return out;
+                        }
+                        else
+                        {
+                            cp = replacementChar;
+                        }
+                    }
+
+                    if (cp < 0x80)
+                    {
+                        *out++ = static_cast<char>(cp);
+                    }
+                    else if (cp < 0x800)
+                    {
+                        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+                        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+                    }
+                    else if (cp < 0x10000)
+                    {
+                        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+                        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+                    }
+                    else
+                    {
+                        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+                        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+                    }
+
+                    it += len;
+                } while (it != end && *it >= 0x80);
+            }
+
+            return out;
+        }
+
+#pragma warning(pop)
+    }
+
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
+    // - Invalid or incomplete sequences are replaced with U+FFFD.
     // Arguments:
     // - in - UTF-8 string to be converted
     // - out - reference to the resulting UTF-16 string
@@ -56,7 +351,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out) noexcept
@@ -69,11 +363,13 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            out.resize(in.length());
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            auto it = in.data();
+            const auto beg = out.data();
+            const auto end = details::u8u16(it, in.data() + in.length(), beg, false);
+            out.resize(gsl::narrow_cast<size_t>(end - beg));
+            return S_OK;
         }
         CATCH_RETURN();
     }
@@ -82,6 +378,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 #pragma warning(disable : 26429 26446 26459 26481 26482) // use not_null, subscript operator, use span, pointer arithmetic, dynamic array indexing
     // Routine Description:
     // - Takes a UTF-8 string, complements and/or caches partials, and performs the conversion to UTF-16.
+    // - Invalid sequences are replaced with U+FFFD. An incomplete sequence at the end of the string is cached in `state`.
     // Arguments:
     // - in - UTF-8 string to be converted
     // - out - reference to the resulting UTF-16 string
@@ -90,7 +387,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out, u8state& state) noexcept
@@ -105,66 +401,50 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             RETURN_HR_IF(E_ABORT, !base::CheckAdd(in.length(), state.have).AssignIfValid(&capa16));
 
             out.resize(gsl::narrow_cast<size_t>(capa16));
-            auto len8{ gsl::narrow_cast<int>(in.length()) };
-            int len16{};
-            auto cursor8{ in.data() };
+            const auto beg = out.data();
+            auto cursor16 = beg;
+            auto cursor8 = in.data();
+            const auto end8 = in.data() + in.length();
+
             if (state.have)
             {
-                const auto copyable{ std::min<int>(state.want, len8) };
-                std::move(cursor8, cursor8 + copyable, &state.partials[state.have]);
-                state.have += gsl::narrow_cast<uint8_t>(copyable);
-                state.want -= gsl::narrow_cast<uint8_t>(copyable);
-                if (state.want) // we still didn't get enough data to complete the code point, however this is not an error
+                // Complete the cached sequence with as many bytes as it could possibly need.
+                char buffer[4];
+                const auto copyable = std::min<size_t>(4 - state.have, in.length());
+                std::copy_n(&state.partials[0], state.have, &buffer[0]);
+                std::copy_n(cursor8, copyable, &buffer[state.have]);
+
+                const auto bufferEnd = &buffer[state.have + copyable];
+                const auto d = details::u8decode(&buffer[0], bufferEnd);
+
+                if (d.incomplete) // we still didn't get enough data to complete the code point, however this is not an error
                 {
+                    std::copy(&buffer[0], bufferEnd, &state.partials[0]);
+                    state.have = gsl::narrow_cast<uint8_t>(bufferEnd - &buffer[0]);
+                    state.want = gsl::narrow_cast<uint8_t>(details::u8length(buffer[0]) - state.have);
                     out.clear();
                     return S_OK;
                 }
 
-                len16 = MultiByteToWideChar(CP_UTF8, 0UL, &state.partials[0], gsl::narrow_cast<int>(state.have), out.data(), capa16);
-                RETURN_HR_IF(E_UNEXPECTED, !len16);
-
-                capa16 -= len16;
-                len8 -= copyable;
-                cursor8 += copyable;
-                // state.want is already zero at this point
-                state.have = 0;
+                // The cached bytes are a valid prefix, so the decoded sequence is at least as long as
+                // the prefix. If the new bytes don't continue it, it's replaced with U+FFFD on its own.
+                const char* bufferIt = &buffer[0];
+                cursor16 = details::u8u16(bufferIt, &buffer[0] + d.len, cursor16, false);
+                cursor8 += d.len - state.have;
+                state.reset();
             }
 
-            if (len8)
-            {
-                auto backIter{ cursor8 + len8 - 1 };
-                int sequenceLen{ 1 };
-
-                // skip UTF8 continuation bytes
-                while (backIter != cursor8 && (*backIter & 0b11'000000) == 0b10'000000)
-                {
-                    --backIter;
-                    ++sequenceLen;
-                }
-
-                // credits go to Christopher Wellons for this algorithm to determine the length of a UTF-8 code point
-                // it is released into the Public Domain. https://github.com/skeeto/branchless-utf8
-                static constexpr uint8_t lengths[]{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0 };
-                const auto codePointLen{ lengths[gsl::narrow_cast<uint8_t>(*backIter) >> 3] };
-
-                if (codePointLen > sequenceLen)
-                {
-                    std::move(backIter, backIter + sequenceLen, &state.partials[0]);
-                    len8 -= sequenceLen;
-                    state.have = gsl::narrow_cast<uint8_t>(sequenceLen);
-                    state.want = gsl::narrow_cast<uint8_t>(codePointLen - sequenceLen);
-                }
-            }
+            cursor16 = details::u8u16(cursor8, end8, cursor16, true);
 
-            if (len8)
+            if (cursor8 != end8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
-                RETURN_HR_IF(E_UNEXPECTED, !convLen);
-
-                len16 += convLen;
+                const auto have = end8 - cursor8;
+                std::copy(cursor8, end8, &state.partials[0]);
+                state.have = gsl::narrow_cast<uint8_t>(have);
+                state.want = gsl::narrow_cast<uint8_t>(details::u8length(*cursor8) - have);
             }
 
-            out.resize(gsl::narrow_cast<size_t>(len16));
+            out.resize(gsl::narrow_cast<size_t>(cursor16 - beg));
             return S_OK;
         }
         CATCH_RETURN();
@@ -173,6 +453,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
     // Routine Description:
     // - Takes a UTF-16 string and performs the conversion to UTF-8. NOTE: The function relies on getting complete UTF-16 characters at the string boundaries.
+    // - Unpaired surrogates are replaced with U+FFFD.
     // Arguments:
     // - in - UTF-16 string to be converted
     // - out - reference to the resulting UTF-8 string
@@ -180,7 +461,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u16u8(const std::wstring_view& in, outT& out) noexcept
@@ -196,11 +476,13 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Code Points >U+FFFF: 2 UTF-16 code units --> 4 UTF-8 code units.
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
-            out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            out.resize(gsl::narrow_cast<size_t>(lengthRequired));
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            auto it = in.data();
+            const auto beg = out.data();
+            const auto end = details::u16u8(it, in.data() + in.length(), beg, false);
+            out.resize(gsl::narrow_cast<size_t>(end - beg));
+            return S_OK;
         }
         CATCH_RETURN();
     }
@@ -209,6 +491,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 #pragma warning(disable : 26429 26446 26459 26481) // use not_null, subscript operator, use span, pointer arithmetic
     // Routine Description:
     // - Takes a UTF-16 string, complements and/or caches partials, and performs the conversion to UTF-8.
+    // - Unpaired surrogates are replaced with U+FFFD. A high surrogate at the end of the string is cached in `state`.
     // Arguments:
     // - in - UTF-16 string to be converted
     // - out - reference to the resulting UTF-8 string
@@ -217,7 +500,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded without any change of the represented code points
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u16u8(const std::wstring_view& in, outT& out, u16state& state) noexcept
@@ -233,39 +515,31 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&len16) || !base::CheckAdd(len16, gsl::narrow_cast<int>(state.partials[0]) != 0).AssignIfValid(&capa8) || !base::CheckMul(capa8, 3).AssignIfValid(&capa8));
 
             out.resize(gsl::narrow_cast<size_t>(capa8));
-            int len8{};
-            auto cursor16{ in.data() };
+            const auto beg = out.data();
+            auto cursor8 = beg;
+            auto cursor16 = in.data();
+            const auto end16 = in.data() + in.length();
+
             if (state.partials[0])
             {
+                // If the first code unit is a low surrogate, it completes the cached high surrogate.
+                // Otherwise the cached one is unpaired and only it gets replaced with U+FFFD.
                 state.partials[1] = *cursor16;
-                len8 = WideCharToMultiByte(CP_UTF8, 0UL, &state.partials[0], 2, out.data(), capa8, nullptr, nullptr);
-                RETURN_HR_IF(E_UNEXPECTED, !len8);
-
+                const wchar_t* partialsIt = &state.partials[0];
+                const auto partialsEnd = &state.partials[0] + (*cursor16 >= 0xDC00 && *cursor16 <= 0xDFFF ? 2 : 1);
+                cursor8 = details::u16u8(partialsIt, partialsEnd, cursor8, false);
+                cursor16 += partialsEnd - &state.partials[0] - 1;
                 state.reset();
-                capa8 -= len8;
-                --len16;
-                ++cursor16;
             }
 
-            if (len16)
-            {
-                const auto back = *(cursor16 + len16 - 1);
-                if (back >= 0xD800 && back <= 0xDBFF) // cache the last value in the string if it is in the range of high surrogates
-                {
-                    state.partials[0] = back;
-                    --len16;
-                }
-            }
+            cursor8 = details::u16u8(cursor16, end16, cursor8, true);
 
-            if (len16)
+            if (cursor16 != end16) // cache the last value in the string if it is in the range of high surrogates
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
-                RETURN_HR_IF(E_UNEXPECTED, !convLen);
-
-                len8 += convLen;
+                state.partials[0] = *cursor16;
             }
 
-            out.resize(gsl::narrow_cast<size_t>(len8));
+            out.resize(gsl::narrow_cast<size_t>(cursor8 - beg));
             return S_OK;
         }
         CATCH_RETURN();
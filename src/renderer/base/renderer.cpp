@@ -118,6 +118,17 @@ try
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
+    // Any invalidations that were coalesced since the last frame turn into a single full repaint.
+    // All engines are invalidated at once, because the flag is shared between them.
+    if (_invalidateAllPending)
+    {
+        _invalidateAllPending = false;
+        FOREACH_ENGINE(engine)
+        {
+            LOG_IF_FAILED(engine->InvalidateAll());
+        }
+    }
+
     // Try to start painting a frame
     const auto hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
@@ -217,6 +228,11 @@ void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 // - <none>
 void Renderer::TriggerRedraw(const Viewport& region)
 {
+    if (_CoalesceInvalidation())
+    {
+        return;
+    }
+
     auto view = _viewport;
     auto srUpdateRegion = region.ToExclusive();
 
@@ -266,6 +282,11 @@ void Renderer::TriggerRedraw(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 {
+    if (_CoalesceInvalidation())
+    {
+        return;
+    }
+
     // We first need to make sure the cursor position is within the buffer,
     // otherwise testing for a double width character can throw an exception.
     const auto& buffer = _pData->GetTextBuffer();
@@ -427,6 +448,12 @@ bool Renderer::_CheckViewportAndScroll()
 // - <none>
 void Renderer::TriggerScroll()
 {
+    // _PaintFrameForEngine() will call _CheckViewportAndScroll() on its own.
+    if (_CoalesceInvalidation())
+    {
+        return;
+    }
+
     if (_CheckViewportAndScroll())
     {
         NotifyPaintFrame();
@@ -444,6 +471,12 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
+    if (_CoalesceInvalidation())
+    {
+        _ScrollPreviousSelection(*pcoordDelta);
+        return;
+    }
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
@@ -499,12 +532,67 @@ void Renderer::TriggerTitleChange()
 
 void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 {
+    // While coalescing, the output is a flood that's too large to be announced by a screen reader
+    // (and UiaEngine would buffer all of it). Accessibility clients still learn about the changes
+    // through the text-changed event that follows the full repaint of each frame.
+    if (_coalesceInvalidations)
+    {
+        return;
+    }
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->NotifyNewText(newText));
     }
 }
 
+// Routine Description:
+// - Enables or disables the coalescing of invalidations. While enabled, TriggerRedraw(),
+//   TriggerRedrawCursor() and TriggerScroll() don't compute dirty regions anymore.
+//   Instead, the next frame is repainted in its entirety, no matter how often they're called.
+//   TriggerNewTextNotification() is skipped as well.
+// - This is useful while the buffer is flooded with output, where the bookkeeping
+//   for each individual change costs more than simply repainting everything once per frame.
+// - INVARIANT: Like the Trigger*() functions, this must be called with the console lock held.
+// Arguments:
+// - enabled - Whether invalidations should be coalesced.
+// Return Value:
+// - <none>
+void Renderer::SetInvalidationCoalescing(const bool enabled)
+{
+    _coalesceInvalidations = enabled;
+
+    // The changes we skipped over might not be in the next frame yet.
+    if (!enabled && _invalidateAllPending)
+    {
+        _invalidateAllPending = false;
+        TriggerRedrawAll();
+    }
+}
+
+// Routine Description:
+// - If invalidations are being coalesced (see SetInvalidationCoalescing()),
+//   this marks the next frame as entirely invalid and notifies the render thread once.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the caller should skip its regular invalidation.
+bool Renderer::_CoalesceInvalidation() noexcept
+{
+    if (!_coalesceInvalidations)
+    {
+        return false;
+    }
+
+    if (!_invalidateAllPending)
+    {
+        _invalidateAllPending = true;
+        NotifyPaintFrame();
+    }
+
+    return true;
+}
+
 // Routine Description:
 // - Update the title for a particular engine.
 // Arguments:
@@ -736,21 +824,21 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - til::point{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            // Retrieve the row we want to redraw.
+            const auto& bufferRow = buffer.GetRowByOffset(bufferLine.Origin().y);
 
             // Calculate if two things are true:
             // 1. this row wrapped
             // 2. We're painting the last col of the row.
             // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
-            const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().y).WasWrapForced()) &&
+            const auto lineWrapped = bufferRow.WasWrapForced() &&
                                      (bufferLine.RightExclusive() == buffer.GetSize().Width());
 
             // Prepare the appropriate line transform for the current row and viewport offset.
             LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.y, view.Left()));
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _PaintBufferOutputHelper(pEngine, bufferRow, bufferLine.Left(), bufferLine.RightExclusive(), screenPosition, lineWrapped);
         }
     }
 }
@@ -762,33 +850,40 @@ static bool _IsAllSpaces(const std::wstring_view v)
 }
 
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        const ROW& row,
+                                        const til::CoordType columnBegin,
+                                        const til::CoordType columnEnd,
                                         const til::point target,
                                         const bool lineWrapped)
 {
     auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
 
+    // The run iterator yields spans of columns that share the same attributes. The color only needs
+    // to be compared when we enter a new attribute run and glyphs are only inspected for their text.
+    TextBufferRunIterator it{ row, columnBegin, columnEnd };
+    const auto columnLimit = std::min<til::CoordType>(columnEnd, row.size());
+
     // If we have valid data, let's figure out how to draw it.
     if (it)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
+        // The current column in the buffer, as opposed to screenPoint which is the position on screen.
+        auto column = it->columnBegin;
         til::CoordType cols = 0;
 
         // Retrieve the first color.
-        auto color = it->TextAttr();
+        auto color = it->attr;
+        // Whether the attributes of the current attribute run are identical to `color`.
+        auto colorMatchesRun = true;
         // Retrieve the first pattern id
         auto patternIds = _pData->GetPatternId(target);
         // Determine whether we're using a soft font.
-        auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+        auto usingSoftFont = s_IsSoftFontChar(row.GlyphAt(column), _firstSoftFontChar, _lastSoftFontChar);
 
         // And hold the point where we should start drawing.
         auto screenPoint = target;
 
         // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        while (column < columnLimit)
         {
             // Hold onto the current run color right here for the length of the outer loop.
             // We'll be changing the persistent one as we run through the inner loops to detect
@@ -796,9 +891,6 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
             // Update the drawing brushes with our color and font usage.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
 
@@ -806,9 +898,9 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             screenPoint.x += cols;
             cols = 0;
 
-            // Hold onto the start of this run iterator and the target location where we started
+            // Hold onto the start of this run and the target location where we started
             // in case we need to do some special work to paint the line drawing characters.
-            const auto currentRunItStart = it;
+            const auto currentRunColumnStart = column;
             const auto currentRunTargetStart = screenPoint;
 
             // Ensure that our cluster vector is clear.
@@ -827,18 +919,31 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // We also accumulate clusters according to regex patterns
             do
             {
+                // Wide glyphs may skip over short attribute runs entirely.
+                if (column >= it->columnEnd)
+                {
+                    do
+                    {
+                        ++it;
+                    } while (column >= it->columnEnd);
+                    colorMatchesRun = color == it->attr;
+                }
+
+                const auto glyph = row.GlyphAt(column);
+                const auto dbcsAttr = row.DbcsAttrAt(column);
                 til::point thisPoint{ screenPoint.x + cols, screenPoint.y };
                 const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
-                const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+                const auto thisUsingSoftFont = s_IsSoftFontChar(glyph, _firstSoftFontChar, _lastSoftFontChar);
                 const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
-                if (color != it->TextAttr() || changedPatternOrFont)
+                if (!colorMatchesRun || changedPatternOrFont)
                 {
-                    auto newAttr{ it->TextAttr() };
+                    const auto& newAttr{ it->attr };
                     // foreground doesn't matter for runs of spaces (!)
                     // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
+                    if (!_IsAllSpaces(glyph) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                     {
                         color = newAttr;
+                        colorMatchesRun = true;
                         patternIds = thisPointPatterns;
                         usingSoftFont = thisUsingSoftFont;
                         break; // vend this run
@@ -847,11 +952,12 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // Walk through the text data and turn it into rendering clusters.
                 // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
-                auto columnCount = it->Columns();
+                const auto glyphColumns = dbcsAttr == DbcsAttribute::Leading ? 2 : 1;
+                auto columnCount = glyphColumns;
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr() == DbcsAttribute::Trailing)
+                if (_clusterBuffer.empty() && dbcsAttr == DbcsAttribute::Trailing)
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.x;
@@ -867,11 +973,11 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 }
 
                 // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
-                it += std::max(it->Columns(), 1); // prevent infinite loop for no visible columns
+                _clusterBuffer.emplace_back(glyph, columnCount);
+                column += glyphColumns;
                 cols += columnCount;
 
-            } while (it);
+            } while (column < columnLimit);
 
             // Do the painting.
             THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
@@ -885,22 +991,15 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 // attribute that could have contained different line information than the left half.
                 if (containsWideCharacter)
                 {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
-                    // Start from the original target in this run.
-                    auto lineTarget = currentRunTargetStart;
-
-                    // We need to go through the iterators again to ensure we get the lines associated with each
+                    // We need to go through the attribute runs again to ensure we get the lines associated with each
                     // exact column. The code above will condense two-column characters into one, but it is possible
                     // (like with the IME) that the line drawing characters will vary from the left to right half
                     // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (til::CoordType colsPainted = 0; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.x)
+                    for (TextBufferRunIterator lineIt{ row, currentRunColumnStart, std::min(column, columnLimit) }; lineIt; ++lineIt)
                     {
-                        auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
+                        auto lineTarget = currentRunTargetStart;
+                        lineTarget.x += lineIt->columnBegin - currentRunColumnStart;
+                        _PaintBufferOutputGridLineHelper(pEngine, lineIt->attr, lineIt->columnEnd - lineIt->columnBegin, lineTarget);
                     }
                 }
                 else
@@ -1150,9 +1249,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const til::point target{ viewDirty.left, iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
+                    const auto& row = overlay.buffer.GetRowByOffset(source.y);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _PaintBufferOutputHelper(&engine, row, source.x, overlay.buffer.GetSize().RightExclusive(), target, false);
                 }
             }
         }
@@ -22,6 +22,7 @@ Author(s):
 #include "thread.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
+#include "../../buffer/out/textBufferRunIterator.hpp"
 
 // fwdecl unittest classes
 #ifdef UNIT_TESTING
@@ -63,6 +64,8 @@ namespace Microsoft::Console::Render
 
         void TriggerNewTextNotification(const std::wstring_view newText);
 
+        void SetInvalidationCoalescing(const bool enabled);
+
         void TriggerFontChange(const int iDpi,
                                const FontInfoDesired& FontInfoDesired,
                                _Out_ FontInfo& FontInfo);
@@ -98,9 +101,10 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
         bool _CheckViewportAndScroll();
+        bool _CoalesceInvalidation() noexcept;
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const til::point target, const bool lineWrapped);
+        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, const ROW& row, const til::CoordType columnBegin, const til::CoordType columnEnd, const til::point target, const bool lineWrapped);
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
         bool _isHoveredHyperlink(const TextAttribute& textAttribute) const noexcept;
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
@@ -132,6 +136,8 @@ namespace Microsoft::Console::Render
         std::function<void()> _pfnRendererEnteredErrorState;
         bool _destructing = false;
         bool _forceUpdateViewport = false;
+        bool _coalesceInvalidations = false;
+        bool _invalidateAllPending = false;
 
 #ifdef UNIT_TESTING
         friend class ConptyOutputTests;
@@ -95,31 +95,47 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
     RowWriteState state{
         .text = string,
         .columnLimit = lineWidth,
+        .joinPrecedingGlyph = true,
     };
 
     while (!state.text.empty())
     {
+        state.columnBegin = cursorPosition.x;
+
         if (cursor.IsDelayedEOLWrap() && wrapAtEOL)
         {
             const auto delayedCursorPosition = cursor.GetDelayedAtPosition();
-            cursor.ResetDelayEOLWrap();
-            // Only act on a delayed EOL if we didn't move the cursor to a
-            // different position from where the EOL was marked.
-            if (delayedCursorPosition == cursorPosition)
+            // Combining marks, joiners, etc. that follow the glyph in the last column belong to that glyph,
+            // even if they arrive in a separate write. Wrapping them onto the next line would split it up.
+            // The cursor is on that glyph, so we write right after it, which makes the row join the two.
+            if (delayedCursorPosition == cursorPosition &&
+                textBuffer.GetRowByOffset(cursorPosition.y).JoinsPrecedingGlyph(cursorPosition.x + 1, state.text))
+            {
+                state.columnBegin = cursorPosition.x + 1;
+            }
+            else
             {
-                _DoLineFeed(textBuffer, true, true);
-                cursorPosition = cursor.GetPosition();
-                // We need to recalculate the width when moving to a new line.
-                lineWidth = textBuffer.GetLineWidth(cursorPosition.y);
-                if (cursorPosition.y >= topMargin && cursorPosition.y <= bottomMargin)
+                cursor.ResetDelayEOLWrap();
+                // Only act on a delayed EOL if we didn't move the cursor to a
+                // different position from where the EOL was marked.
+                if (delayedCursorPosition == cursorPosition)
                 {
-                    lineWidth = std::min(lineWidth, rightMargin + 1);
+                    _DoLineFeed(textBuffer, true, true);
+                    cursorPosition = cursor.GetPosition();
+                    // We need to recalculate the width when moving to a new line.
+                    lineWidth = textBuffer.GetLineWidth(cursorPosition.y);
+                    if (cursorPosition.y >= topMargin && cursorPosition.y <= bottomMargin)
+                    {
+                        lineWidth = std::min(lineWidth, rightMargin + 1);
+                    }
+                    state.columnLimit = lineWidth;
+                    state.columnBegin = cursorPosition.x;
                 }
-                state.columnLimit = lineWidth;
             }
         }
 
-        if (_modes.test(Mode::InsertReplace))
+        // (The glyph that's extended at the end of the line doesn't need any new space.)
+        if (_modes.test(Mode::InsertReplace) && state.columnBegin == cursorPosition.x)
         {
             // If insert-replace mode is enabled, we first measure how many cells
             // the string will occupy, and scroll the target area right by that
@@ -135,8 +151,6 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
             _ScrollRectHorizontally(textBuffer, { cursorPosition.x, row, state.columnLimit, row + 1 }, cellCount);
         }
 
-        state.columnBegin = cursorPosition.x;
-
         const auto textPositionBefore = state.text.data();
         textBuffer.Write(cursorPosition.y, attributes, state);
         const auto textPositionAfter = state.text.data();
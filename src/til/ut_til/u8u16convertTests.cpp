@@ -17,6 +17,11 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16Invalid);
+    TEST_METHOD(TestU8ToU16PartialsInvalid);
+    TEST_METHOD(TestU16ToU8Invalid);
+    TEST_METHOD(TestRoundtripAcrossVectorBoundaries);
+    TEST_METHOD(TestThroughput);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +196,196 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16Invalid()
+{
+    // Ill-formed sequences are replaced with one U+FFFD per maximal subpart,
+    // as recommended by Unicode section 3.9 and as done by MultiByteToWideChar.
+    static constexpr std::pair<std::string_view, std::wstring_view> testData[]{
+        // Unicode Table 3-8: Use of U+FFFD in UTF-8 Conversion
+        { "\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64", L"a\uFFFD\uFFFD\uFFFDb\uFFFDc\uFFFD\uFFFDd" },
+        // Overlong encodings
+        { "\xC0\xAF", L"\uFFFD\uFFFD" },
+        { "\xE0\x80\xAF", L"\uFFFD\uFFFD\uFFFD" },
+        { "\xF0\x80\x80\xAF", L"\uFFFD\uFFFD\uFFFD\uFFFD" },
+        // Encoded surrogates
+        { "\xED\xA0\x80", L"\uFFFD\uFFFD\uFFFD" },
+        // Above U+10FFFF
+        { "\xF4\x90\x80\x80", L"\uFFFD\uFFFD\uFFFD\uFFFD" },
+        { "\xF5\x80", L"\uFFFD\uFFFD" },
+        // Truncated sequences
+        { "\xE2\x82", L"\uFFFD" },
+        { "a\xF0\x9F\x93", L"a\uFFFD" },
+        // Invalid bytes in the middle of long ASCII runs, which are processed in vectors of 16 bytes.
+        { "0123456789abcdef0123456789\xFF" "abcdef0123456789abcdef", L"0123456789abcdef0123456789\uFFFDabcdef0123456789abcdef" },
+        { "0123456789abcde\xE2\x82\xAC" "0123456789abcdef0123456789abcdef", L"0123456789abcde\u20AC0123456789abcdef0123456789abcdef" },
+    };
+
+    for (const auto& [input, expected] : testData)
+    {
+        std::wstring u16Out{};
+        VERIFY_SUCCEEDED(til::u8u16(input, u16Out));
+        VERIFY_ARE_EQUAL(expected, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU8ToU16PartialsInvalid()
+{
+    til::u8state state{};
+    std::wstring u16Out{};
+
+    // A cached lead byte that isn't continued is replaced on its own, without eating the next character.
+    VERIFY_SUCCEEDED(til::u8u16("abc\xE2", u16Out, state));
+    VERIFY_ARE_EQUAL(L"abc", u16Out);
+    VERIFY_SUCCEEDED(til::u8u16("def", u16Out, state));
+    VERIFY_ARE_EQUAL(L"\uFFFDdef", u16Out);
+
+    // The same applies if the sequence breaks after the first continuation byte.
+    VERIFY_SUCCEEDED(til::u8u16("\xF0\x9F", u16Out, state));
+    VERIFY_ARE_EQUAL(L"", u16Out);
+    VERIFY_SUCCEEDED(til::u8u16("\x93\xC3\xA9", u16Out, state));
+    VERIFY_ARE_EQUAL(L"\uFFFD\u00E9", u16Out);
+
+    // Trailing bytes that can never become valid aren't cached.
+    VERIFY_SUCCEEDED(til::u8u16("x\xC0", u16Out, state));
+    VERIFY_ARE_EQUAL(L"x\uFFFD", u16Out);
+    VERIFY_ARE_EQUAL(uint8_t{ 0 }, state.have);
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8Invalid()
+{
+    const std::wstring u16String{
+        L'a',
+        gsl::narrow_cast<wchar_t>(0xDC00), // unpaired low surrogate
+        L'b',
+        gsl::narrow_cast<wchar_t>(0xD800), // unpaired high surrogate
+        L'c',
+    };
+
+    std::string u8Out{};
+    VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+    VERIFY_ARE_EQUAL(std::string{ "a\xEF\xBF\xBD" "b\xEF\xBF\xBD" "c" }, u8Out);
+
+    // A cached high surrogate that isn't followed by a low surrogate is replaced on its own.
+    til::u16state state{};
+    VERIFY_SUCCEEDED(til::u16u8(std::wstring_view{ &u16String[3], 1 }, u8Out, state));
+    VERIFY_ARE_EQUAL(std::string{}, u8Out);
+    VERIFY_SUCCEEDED(til::u16u8(L"xy", u8Out, state));
+    VERIFY_ARE_EQUAL(std::string{ "\xEF\xBF\xBDxy" }, u8Out);
+}
+
+void Utf8Utf16ConvertTests::TestRoundtripAcrossVectorBoundaries()
+{
+    // The ASCII fast paths process 8, 16 and 32 code units at a time.
+    // Place a non-ASCII character at every offset of strings up to 80 characters long.
+    static constexpr std::pair<std::wstring_view, size_t> needles[]{
+        { L"\u00F6", 2 }, // LATIN SMALL LETTER O WITH DIAERESIS
+        { L"\u2500", 3 }, // BOX DRAWINGS LIGHT HORIZONTAL
+        { L"\U0001F4F7", 4 }, // CAMERA
+    };
+
+    for (const auto& [needle, needleLength8] : needles)
+    {
+        for (size_t length = 0; length <= 80; ++length)
+        {
+            for (size_t offset = 0; offset <= length; ++offset)
+            {
+                std::wstring u16String(length, L'x');
+                u16String.insert(offset, needle);
+
+                const auto u8String = til::u16u8(u16String);
+                VERIFY_ARE_EQUAL(length + needleLength8, u8String.size());
+                VERIFY_ARE_EQUAL(u16String, til::u8u16(u8String));
+            }
+        }
+    }
+}
+
+void Utf8Utf16ConvertTests::TestThroughput()
+{
+    // A simple throughput benchmark for til::u8u16/u16u8 and the platform functions they replaced.
+    // Use /p:U8U16BenchmarkSize=<MiB> to change the size of each corpus (default: 1 MiB).
+    size_t sizeInMiB = 1;
+    {
+        String value;
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"U8U16BenchmarkSize", value)) && !value.IsEmpty())
+        {
+            sizeInMiB = std::max<size_t>(1, wcstoul(value, nullptr, 10));
+        }
+    }
+
+    static constexpr std::pair<std::wstring_view, std::wstring_view> corpora[]{
+        { L"VT (ASCII)", L"\x1b[38;5;114mdrwxr-xr-x\x1b[m  2 user group  4096 Jan  1 00:00 \x1b[1;34mdirectory\x1b[m\r\n" },
+        { L"TUI (box drawing)", L"\x1b[2;1H│ \x1b[7m file.txt \x1b[27m │ 12 KiB │────────┤\r\n" },
+        { L"Cyrillic", L"Съешь же ещё этих мягких булок. " },
+        { L"CJK", L"我能吞下玻璃而不伤身体。" },
+    };
+
+    const auto mibPerSecond = [](size_t bytes, std::chrono::steady_clock::duration duration) {
+        const auto seconds = std::chrono::duration<double>(duration).count();
+        return seconds > 0 ? static_cast<double>(bytes) / seconds / (1024.0 * 1024.0) : 0.0;
+    };
+
+    for (const auto& [name, sample] : corpora)
+    {
+        std::wstring u16String;
+        while (u16String.size() * sizeof(wchar_t) < sizeInMiB * 1024 * 1024)
+        {
+            u16String.append(sample);
+        }
+        const auto u8String = til::u16u8(u16String);
+
+        // ConptyConnection and VtInputThread convert the output in chunks of a few KiB at a time.
+        static constexpr size_t chunkSize = 4096;
+        std::wstring u16Out;
+        std::string u8Out;
+        auto u16Buffer = std::make_unique<wchar_t[]>(chunkSize);
+        auto u8Buffer = std::make_unique<char[]>(chunkSize * 3);
+
+        const auto measure = [](auto&& func) {
+            const auto beg = std::chrono::steady_clock::now();
+            func();
+            return std::chrono::steady_clock::now() - beg;
+        };
+
+        const auto tilU8U16 = measure([&]() {
+            til::u8state state{};
+            for (size_t i = 0; i < u8String.size(); i += chunkSize)
+            {
+                (void)til::u8u16(std::string_view{ u8String }.substr(i, chunkSize), u16Out, state);
+            }
+        });
+        const auto platformU8U16 = measure([&]() {
+            for (size_t i = 0; i < u8String.size(); i += chunkSize)
+            {
+                const auto len = gsl::narrow_cast<int>(std::min(chunkSize, u8String.size() - i));
+                MultiByteToWideChar(CP_UTF8, 0, u8String.data() + i, len, u16Buffer.get(), gsl::narrow_cast<int>(chunkSize));
+            }
+        });
+        const auto tilU16U8 = measure([&]() {
+            til::u16state state{};
+            for (size_t i = 0; i < u16String.size(); i += chunkSize)
+            {
+                (void)til::u16u8(std::wstring_view{ u16String }.substr(i, chunkSize), u8Out, state);
+            }
+        });
+        const auto platformU16U8 = measure([&]() {
+            for (size_t i = 0; i < u16String.size(); i += chunkSize)
+            {
+                const auto len = gsl::narrow_cast<int>(std::min(chunkSize, u16String.size() - i));
+                WideCharToMultiByte(CP_UTF8, 0, u16String.data() + i, len, u8Buffer.get(), gsl::narrow_cast<int>(chunkSize * 3), nullptr, nullptr);
+            }
+        });
+
+        Log::Comment(NoThrowString().Format(
+            L"%-18s u8u16: %8.1f MiB/s (MultiByteToWideChar: %8.1f MiB/s)  u16u8: %8.1f MiB/s (WideCharToMultiByte: %8.1f MiB/s)",
+            std::wstring{ name }.c_str(),
+            mibPerSecond(u8String.size(), tilU8U16),
+            mibPerSecond(u8String.size(), platformU8U16),
+            mibPerSecond(u16String.size() * sizeof(wchar_t), tilU16U8),
+            mibPerSecond(u16String.size() * sizeof(wchar_t), platformU16U8)));
+
+        // Make sure we benchmarked something that actually works.
+        VERIFY_ARE_EQUAL(u16String, til::u8u16(u8String));
+    }
+}
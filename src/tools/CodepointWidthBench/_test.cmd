@@ -0,0 +1,6 @@
+:: TEST TOOL CodepointWidthBench
+@echo off &setlocal
+cd /d "%~dp0"
+..\..\..\x64\Release\CodepointWidthBench.exe
+echo(
+pause
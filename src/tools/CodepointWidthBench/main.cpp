@@ -0,0 +1,212 @@
+// TEST TOOL CodepointWidthBench
+// Performance tests for CodepointWidthDetector, which is queried for every non-ASCII glyph written into the text buffer,
+// and for the grapheme cluster segmentation in GraphemeBreak.cpp, which splits the text into those glyphs.
+// The corpora are a mix of ASCII and Latin-1 text, CJK text (see ..\U8U16Test\zh.txt), emoji and ambiguous width characters.
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <til/at.h>
+
+#include "../../types/inc/CodepointWidthDetector.hpp"
+#include "../../types/inc/GraphemeBreak.hpp"
+
+// Splits the text into glyphs the way the text buffer queries them: one codepoint at a time.
+static std::vector<std::wstring_view> SplitCodepoints(const std::wstring_view text)
+{
+    std::vector<std::wstring_view> glyphs;
+    glyphs.reserve(text.size());
+    for (size_t i = 0; i < text.size();)
+    {
+        const auto len = IS_HIGH_SURROGATE(text[i]) && i + 1 < text.size() && IS_LOW_SURROGATE(text[i + 1]) ? 2 : 1;
+        glyphs.emplace_back(text.substr(i, len));
+        i += len;
+    }
+    return glyphs;
+}
+
+static std::wstring LoadCorpus(const char* path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    std::stringstream u8;
+    u8 << file.rdbuf();
+    const auto str = u8.str();
+    std::wstring u16(str.size(), L'\0');
+    const auto len = MultiByteToWideChar(CP_UTF8, 0, str.data(), static_cast<int>(str.size()), u16.data(), static_cast<int>(u16.size()));
+    u16.resize(static_cast<size_t>(std::max(len, 0)));
+    return u16;
+}
+
+static std::wstring GenerateEmoji()
+{
+    std::wstring text;
+    // Emoticons, pictographs and transport symbols, as well as some supplemental ones.
+    for (char32_t cp = 0x1F300; cp < 0x1FA00; ++cp)
+    {
+        const auto v = cp - 0x10000;
+        text.push_back(static_cast<wchar_t>(0xD800 + (v >> 10)));
+        text.push_back(static_cast<wchar_t>(0xDC00 + (v & 0x3FF)));
+    }
+    return text;
+}
+
+static std::wstring GenerateAmbiguous()
+{
+    std::wstring text;
+    // Box drawing, geometric shapes, enclosed alphanumerics and greek/cyrillic letters.
+    for (wchar_t ch = 0x2460; ch < 0x2600; ++ch)
+    {
+        text.push_back(ch);
+    }
+    for (wchar_t ch = 0x391; ch < 0x450; ++ch)
+    {
+        text.push_back(ch);
+    }
+    return text;
+}
+
+static std::wstring GenerateASCII()
+{
+    std::wstring text;
+    // Something that looks like compiler output: printable ASCII with a line break every 80 characters.
+    for (size_t i = 0; i < 64 * 1024; ++i)
+    {
+        text.push_back(i % 81 == 80 ? L'\n' : static_cast<wchar_t>(L' ' + i * 7 % 95));
+    }
+    return text;
+}
+
+static std::wstring GenerateLatin1()
+{
+    std::wstring text;
+    for (size_t i = 0; i < 64 * 1024; ++i)
+    {
+        text.push_back(static_cast<wchar_t>(0xA0 + i * 7 % 96));
+    }
+    return text;
+}
+
+static std::wstring GenerateCombining()
+{
+    std::wstring text;
+    // Latin letters with 1-2 combining diacritics, as well as ZWJ emoji sequences and flags.
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        text.push_back(static_cast<wchar_t>(L'a' + i % 26));
+        text.push_back(static_cast<wchar_t>(0x300 + i % 0x70));
+        if (i & 1)
+        {
+            text.push_back(static_cast<wchar_t>(0x300 + (i * 7) % 0x70));
+        }
+        if (i % 16 == 0)
+        {
+            text.append(L"\U0001F468\u200D\U0001F469\u200D\U0001F467\U0001F1FA\U0001F1F8");
+        }
+    }
+    return text;
+}
+
+// This is how TextBuffer::GraphemeNext used to work: one codepoint at a time.
+static size_t CodepointNext(const std::wstring_view& text, size_t offset)
+{
+    return offset + (IS_HIGH_SURROGATE(text[offset]) && offset + 1 < text.size() && IS_LOW_SURROGATE(text[offset + 1]) ? 2 : 1);
+}
+
+template<typename T>
+static void RunSegmentation(const char* name, const std::wstring_view text, const int iterations, T&& next)
+{
+    size_t clusters = 0;
+
+    const auto beg = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (size_t offset = 0; offset < text.size(); offset = next(text, offset))
+        {
+            ++clusters;
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto total = std::chrono::duration<double, std::nano>(end - beg).count();
+    std::cout << "---- " << name << " ----"
+              << "\n chars " << text.size()
+              << "\n clusters " << clusters / iterations
+              << "\n ns/char " << total / (static_cast<double>(text.size()) * iterations) << "\n"
+              << std::endl;
+}
+
+static void Run(const char* name, CodepointWidthDetector& detector, const std::wstring_view text, const int iterations)
+{
+    const auto glyphs = SplitCodepoints(text);
+    size_t wide = 0;
+
+    const auto beg = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (const auto& glyph : glyphs)
+        {
+            wide += detector.IsWide(glyph);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto total = std::chrono::duration<double, std::nano>(end - beg).count();
+    const auto lookups = static_cast<double>(glyphs.size()) * iterations;
+    std::cout << "---- " << name << " ----"
+              << "\n glyphs " << glyphs.size()
+              << "\n wide " << wide / iterations
+              << "\n ns/lookup " << total / lookups << "\n"
+              << std::endl;
+}
+
+int main()
+{
+    static constexpr int iterations = 1000;
+
+    const auto cjk = LoadCorpus("..\\U8U16Test\\zh.txt");
+    const auto emoji = GenerateEmoji();
+    const auto ambiguous = GenerateAmbiguous();
+    std::wstring mixed;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        mixed.append(cjk.substr(i * cjk.size() / 16, cjk.size() / 16));
+        mixed.append(emoji.substr(i * emoji.size() / 16 & ~size_t{ 1 }, 64));
+        mixed.append(ambiguous.substr(i * ambiguous.size() / 16, 32));
+    }
+
+    CodepointWidthDetector detector;
+    Run("CJK", detector, cjk, iterations);
+    Run("Emoji", detector, emoji, iterations);
+    Run("Ambiguous (no fallback)", detector, ambiguous, iterations);
+    Run("Mixed (no fallback)", detector, mixed, iterations);
+
+    // The fallback is normally implemented by the renderer and asks the font. Here it just needs to be cheap
+    // and deterministic, so that the numbers reflect the cost of the fallback cache and not the font lookup.
+    detector.SetFallbackMethod([](const std::wstring_view& glyph) { return (glyph.front() & 1) != 0; });
+    Run("Ambiguous (cached fallback)", detector, ambiguous, iterations);
+    Run("Mixed (cached fallback)", detector, mixed, iterations);
+
+    // GraphemeClusterNext should be just as fast as codepoint iteration for plain text.
+    const auto ascii = GenerateASCII();
+    const auto latin1 = GenerateLatin1();
+    const auto combining = GenerateCombining();
+    RunSegmentation("ASCII (codepoints)", ascii, iterations, CodepointNext);
+    RunSegmentation("ASCII (grapheme clusters)", ascii, iterations, GraphemeClusterNext);
+    RunSegmentation("Latin-1 (codepoints)", latin1, iterations, CodepointNext);
+    RunSegmentation("Latin-1 (grapheme clusters)", latin1, iterations, GraphemeClusterNext);
+    RunSegmentation("CJK (codepoints)", cjk, iterations, CodepointNext);
+    RunSegmentation("CJK (grapheme clusters)", cjk, iterations, GraphemeClusterNext);
+    RunSegmentation("Combining (codepoints)", combining, iterations, CodepointNext);
+    RunSegmentation("Combining (grapheme clusters)", combining, iterations, GraphemeClusterNext);
+
+    return 0;
+}
@@ -4,6 +4,8 @@
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
 
+#include <bit>
+
 namespace
 {
     // used to store range data in CodepointWidthDetector's internal map
@@ -14,11 +16,6 @@ namespace
         char32_t isAmbiguous : 1;
     };
 
-    static bool operator<(const UnicodeRange& range, const unsigned int searchTerm) noexcept
-    {
-        return range.upperBound < searchTerm;
-    }
-
     // Generated by Generate-CodepointWidthsFromUCD.ps1 -Pack:True -Full: -NoOverrides:False
     // on 2022-11-15 19:54:23Z from Unicode 15.0.0.
     // 321149 (0x4E67D) codepoints covered.
@@ -323,6 +320,144 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, 1 },
         UnicodeRange{ 0x100000, 0x10fffd, 1 },
     };
+
+    // s_wideAndAmbiguousTable is turned into a two-stage lookup table at compile time, so that
+    // the width of any codepoint can be looked up with two loads instead of a binary search.
+    // Stage 1 maps each block of 256 codepoints to a block in stage 2, which stores 2 bits per codepoint.
+    // Most blocks are uniformly narrow, wide or ambiguous and share the first 3 blocks in stage 2.
+    // Only the few dozen blocks with mixed widths need to be stored individually.
+    enum WidthClass : uint8_t
+    {
+        WidthClassNarrow = 0,
+        WidthClassWide = 1,
+        WidthClassAmbiguous = 2,
+        WidthClassMixed = 3, // only used for stage 1 generation
+    };
+
+    static constexpr char32_t s_codepointCount = 0x110000;
+    static constexpr int s_blockShift = 8;
+    static constexpr char32_t s_blockSize = 1 << s_blockShift;
+    static constexpr size_t s_stage1Size = s_codepointCount >> s_blockShift;
+    // 4 codepoints with 2 bits each fit into a byte.
+    static constexpr size_t s_stage2BlockBytes = s_blockSize / 4;
+
+    // Calls func(block, widthClass) for every block of s_blockSize codepoints.
+    // widthClass is WidthClassMixed if the block doesn't consist of a single WidthClass.
+    template<typename T>
+    constexpr void forEachBlock(T&& func)
+    {
+        size_t r = 0;
+        for (size_t block = 0; block < s_stage1Size; ++block)
+        {
+            const auto beg = gsl::narrow_cast<char32_t>(block << s_blockShift);
+            const auto end = beg + s_blockSize - 1;
+
+            // The ranges are sorted, so we can skip those which end before this block once and for all.
+            while (r < s_wideAndAmbiguousTable.size() && s_wideAndAmbiguousTable[r].upperBound < beg)
+            {
+                ++r;
+            }
+
+            auto widthClass = WidthClassMixed;
+            if (r == s_wideAndAmbiguousTable.size() || s_wideAndAmbiguousTable[r].lowerBound > end)
+            {
+                widthClass = WidthClassNarrow;
+            }
+            else if (s_wideAndAmbiguousTable[r].lowerBound <= beg && s_wideAndAmbiguousTable[r].upperBound >= end)
+            {
+                widthClass = s_wideAndAmbiguousTable[r].isAmbiguous ? WidthClassAmbiguous : WidthClassWide;
+            }
+
+            func(block, widthClass);
+        }
+    }
+
+    static constexpr size_t s_mixedBlockCount = [] {
+        size_t count = 0;
+        forEachBlock([&](size_t, WidthClass widthClass) {
+            count += widthClass == WidthClassMixed;
+        });
+        return count;
+    }();
+
+    static constexpr size_t s_stage2BlockCount = 3 + s_mixedBlockCount;
+    static_assert(s_stage2BlockCount <= 256, "stage 1 stores block indices as uint8_t");
+
+    struct WidthTable
+    {
+        std::array<uint8_t, s_stage1Size> stage1{};
+        std::array<uint8_t, s_stage2BlockCount * s_stage2BlockBytes> stage2{};
+
+        constexpr WidthClass Lookup(const char32_t codepoint) const noexcept
+        {
+            const size_t block = stage1[codepoint >> s_blockShift];
+            const auto offset = codepoint & (s_blockSize - 1);
+            const auto bits = stage2[block * s_stage2BlockBytes + offset / 4] >> (offset % 4 * 2);
+            return static_cast<WidthClass>(bits & 3);
+        }
+    };
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+#pragma warning(disable : 26482) // Only index into arrays using constant expressions (bounds.2).
+    static constexpr auto s_widthTable = [] {
+        WidthTable table;
+
+        // Blocks 0-2 are the shared, uniform ones. Their index coincides with their WidthClass.
+        for (size_t i = 0; i < s_stage2BlockBytes; ++i)
+        {
+            table.stage2[WidthClassWide * s_stage2BlockBytes + i] = 0b01'01'01'01;
+            table.stage2[WidthClassAmbiguous * s_stage2BlockBytes + i] = 0b10'10'10'10;
+        }
+
+        size_t nextBlock = 3;
+        forEachBlock([&](size_t block, WidthClass widthClass) {
+            if (widthClass != WidthClassMixed)
+            {
+                table.stage1[block] = widthClass;
+                return;
+            }
+
+            const auto beg = gsl::narrow_cast<char32_t>(block << s_blockShift);
+            const auto end = beg + s_blockSize - 1;
+            const auto data = nextBlock * s_stage2BlockBytes;
+
+            for (const auto& range : s_wideAndAmbiguousTable)
+            {
+                if (range.upperBound < beg || range.lowerBound > end)
+                {
+                    continue;
+                }
+
+                const uint8_t value = range.isAmbiguous ? WidthClassAmbiguous : WidthClassWide;
+                for (auto c = std::max<char32_t>(range.lowerBound, beg), last = std::min<char32_t>(range.upperBound, end); c <= last; ++c)
+                {
+                    const auto offset = c - beg;
+                    table.stage2[data + offset / 4] |= value << (offset % 4 * 2);
+                }
+            }
+
+            table.stage1[block] = gsl::narrow_cast<uint8_t>(nextBlock);
+            ++nextBlock;
+        });
+
+        return table;
+    }();
+#pragma warning(pop)
+
+    // Verify the generated table at the boundaries of each range, which is where a mistake would show up first.
+    static constexpr bool s_widthTableMatchesRanges = [] {
+        for (const auto& range : s_wideAndAmbiguousTable)
+        {
+            const auto expected = range.isAmbiguous ? WidthClassAmbiguous : WidthClassWide;
+            if (s_widthTable.Lookup(range.lowerBound) != expected || s_widthTable.Lookup(range.upperBound) != expected)
+            {
+                return false;
+            }
+        }
+        return true;
+    }();
+    static_assert(s_widthTableMatchesRanges);
 }
 
 // Routine Description:
@@ -377,20 +512,20 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view& glyph) noexcept
 // GetWidth's slow-path for non-ASCII characters. Returns the number of columns the codepoint takes up in the terminal.
 uint8_t CodepointWidthDetector::_lookupGlyphWidth(const char32_t codepoint, const std::wstring_view& glyph) noexcept
 {
-#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'lower_bound<...>()' which may throw exceptions (f.6).
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
-    uint8_t width = 1;
-
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
+    if (codepoint >= s_codepointCount)
     {
-        width = 2;
-        if (it->isAmbiguous)
-        {
-            width = _checkFallbackViaCache(codepoint, glyph);
-        }
+        return 1;
     }
 
-    return width;
+    switch (s_widthTable.Lookup(codepoint))
+    {
+    case WidthClassWide:
+        return 2;
+    case WidthClassAmbiguous:
+        return _checkFallbackViaCache(codepoint, glyph);
+    default:
+        return 1;
+    }
 }
 
 // Call the function specified via SetFallbackMethod() to turn CodepointWidth::Ambiguous into Narrow/Wide.
@@ -404,13 +539,13 @@ try
         return 1;
     }
 
-    if (const auto it = _fallbackCache.find(codepoint); it != _fallbackCache.end())
+    if (const auto width = _fallbackCacheFind(codepoint))
     {
-        return it->second;
+        return width;
     }
 
     const uint8_t width = _pfnFallbackMethod(glyph) ? 2 : 1;
-    _fallbackCache.insert_or_assign(codepoint, width);
+    _fallbackCacheInsert(codepoint, width);
     return width;
 }
 catch (...)
@@ -419,6 +554,72 @@ catch (...)
     return 1;
 }
 
+// _fallbackCache is a flat hash table with linear probing and a power-of-2 size.
+// Each slot stores `codepoint << 2 | width` and 0 marks an empty slot. Codepoint 0 is never ambiguous.
+// Slots are picked with a multiplicative (Fibonacci) hash: Multiplying by 2^32/phi puts neighboring codepoints
+// a large odd stride apart, so that the clustered ambiguous ranges don't pile up into long probe sequences.
+// The top bits of the product are the well-mixed ones, which is why the slot index is taken from them.
+size_t CodepointWidthDetector::_fallbackCacheSlot(const char32_t codepoint) const noexcept
+{
+    const auto shift = 32 - std::countr_zero(_fallbackCache.size());
+    return static_cast<uint32_t>(codepoint * 0x9E3779B1u) >> shift;
+}
+
+// Returns the cached width of the given codepoint or 0 if it isn't cached yet.
+uint8_t CodepointWidthDetector::_fallbackCacheFind(const char32_t codepoint) const noexcept
+{
+    if (_fallbackCache.empty())
+    {
+        return 0;
+    }
+
+    const auto mask = _fallbackCache.size() - 1;
+    // The load factor is kept below 50%, which guarantees that this loop hits an empty slot eventually.
+    for (auto i = _fallbackCacheSlot(codepoint);; i = (i + 1) & mask)
+    {
+        const auto slot = til::at(_fallbackCache, i);
+        if (slot == 0)
+        {
+            return 0;
+        }
+        if (slot >> 2 == codepoint)
+        {
+            return gsl::narrow_cast<uint8_t>(slot & 3);
+        }
+    }
+}
+
+void CodepointWidthDetector::_fallbackCacheInsert(const char32_t codepoint, const uint8_t width)
+{
+    if ((_fallbackCacheCount + 1) * 2 > _fallbackCache.size())
+    {
+        const auto old = std::move(_fallbackCache);
+        _fallbackCache = std::vector<uint32_t>(std::max<size_t>(old.size() * 2, 64));
+        for (const auto slot : old)
+        {
+            if (slot != 0)
+            {
+                _fallbackCacheEmplace(slot);
+            }
+        }
+    }
+
+    _fallbackCacheEmplace(codepoint << 2 | width);
+    _fallbackCacheCount++;
+}
+
+// Puts the slot value into the first free slot for its codepoint. The caller ensures that there's room for it.
+void CodepointWidthDetector::_fallbackCacheEmplace(const uint32_t value) noexcept
+{
+    const auto mask = _fallbackCache.size() - 1;
+    auto i = _fallbackCacheSlot(value >> 2);
+    while (til::at(_fallbackCache, i) != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    til::at(_fallbackCache, i) = value;
+}
+
 // Method Description:
 // - Sets a function that should be used as the fallback mechanism for
 //      determining a particular glyph's width, should the glyph be an ambiguous
@@ -444,6 +645,6 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() noexcept
 {
-#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'clear()' which may throw exceptions (f.6).
-    _fallbackCache.clear();
+    std::fill(_fallbackCache.begin(), _fallbackCache.end(), 0u);
+    _fallbackCacheCount = 0;
 }
@@ -0,0 +1,1129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/GraphemeBreak.hpp"
+
+#include <til/unicode.h>
+
+namespace
+{
+    struct GraphemeRange final
+    {
+        char32_t lowerBound;
+        char32_t upperBound;
+        GraphemeClusterBreak value;
+    };
+
+    // Derived from the Unicode 15.0.0 UCD, the same version as the CodepointWidthDetector table. Regenerate with tools\Generate-GraphemeBreakTableFromUCD.ps1.
+    // Codepoints not listed here are GraphemeClusterBreak::Other.
+    // The Hangul syllables U+AC00-U+D7A3 are stored as LVT. LV syllables are
+    // every 28th of them and get recovered arithmetically in GetGraphemeClusterBreak.
+    static constexpr std::array<GraphemeRange, 652> s_graphemeBreakTable{
+        GraphemeRange{ 0x0, 0x9, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xa, 0xa, GraphemeClusterBreak::LF },
+        GraphemeRange{ 0xb, 0xc, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xd, 0xd, GraphemeClusterBreak::CR },
+        GraphemeRange{ 0xe, 0x1f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x7f, 0x9f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xa9, 0xa9, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0xad, 0xad, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xae, 0xae, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x300, 0x36f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x483, 0x489, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x591, 0x5bd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x5bf, 0x5bf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x5c1, 0x5c2, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x5c4, 0x5c5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x5c7, 0x5c7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x600, 0x605, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x610, 0x61a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x61c, 0x61c, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x64b, 0x65f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x670, 0x670, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x6d6, 0x6dc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x6dd, 0x6dd, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x6df, 0x6e4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x6e7, 0x6e8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x6ea, 0x6ed, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x70f, 0x70f, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x711, 0x711, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x730, 0x74a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x7a6, 0x7b0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x7eb, 0x7f3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x7fd, 0x7fd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x816, 0x819, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x81b, 0x823, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x825, 0x827, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x829, 0x82d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x859, 0x85b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x890, 0x891, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x898, 0x89f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x8ca, 0x8e1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x8e2, 0x8e2, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x8e3, 0x902, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x903, 0x903, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x93a, 0x93a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x93b, 0x93b, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x93c, 0x93c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x93e, 0x940, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x941, 0x948, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x949, 0x94c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x94d, 0x94d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x94e, 0x94f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x951, 0x957, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x962, 0x963, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x981, 0x981, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x982, 0x983, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x9bc, 0x9bc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9be, 0x9be, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9bf, 0x9c0, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x9c1, 0x9c4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9c7, 0x9c8, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x9cb, 0x9cc, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x9cd, 0x9cd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9d7, 0x9d7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9e2, 0x9e3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x9fe, 0x9fe, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa01, 0xa02, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa03, 0xa03, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa3c, 0xa3c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa3e, 0xa40, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa41, 0xa42, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa47, 0xa48, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa4b, 0xa4d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa51, 0xa51, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa70, 0xa71, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa75, 0xa75, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa81, 0xa82, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa83, 0xa83, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xabc, 0xabc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xabe, 0xac0, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xac1, 0xac5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xac7, 0xac8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xac9, 0xac9, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xacb, 0xacc, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xacd, 0xacd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xae2, 0xae3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xafa, 0xaff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb01, 0xb01, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb02, 0xb03, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xb3c, 0xb3c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb3e, 0xb3f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb40, 0xb40, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xb41, 0xb44, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb47, 0xb48, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xb4b, 0xb4c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xb4d, 0xb4d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb55, 0xb57, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb62, 0xb63, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xb82, 0xb82, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xbbe, 0xbbe, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xbbf, 0xbbf, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xbc0, 0xbc0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xbc1, 0xbc2, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xbc6, 0xbc8, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xbca, 0xbcc, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xbcd, 0xbcd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xbd7, 0xbd7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc00, 0xc00, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc01, 0xc03, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xc04, 0xc04, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc3c, 0xc3c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc3e, 0xc40, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc41, 0xc44, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xc46, 0xc48, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc4a, 0xc4d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc55, 0xc56, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc62, 0xc63, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc81, 0xc81, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xc82, 0xc83, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xcbc, 0xcbc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcbe, 0xcbe, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xcbf, 0xcbf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcc0, 0xcc1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xcc2, 0xcc2, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcc3, 0xcc4, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xcc6, 0xcc6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcc7, 0xcc8, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xcca, 0xccb, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xccc, 0xccd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcd5, 0xcd6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xce2, 0xce3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xcf3, 0xcf3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xd00, 0xd01, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd02, 0xd03, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xd3b, 0xd3c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd3e, 0xd3e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd3f, 0xd40, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xd41, 0xd44, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd46, 0xd48, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xd4a, 0xd4c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xd4d, 0xd4d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd4e, 0xd4e, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0xd57, 0xd57, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd62, 0xd63, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd81, 0xd81, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xd82, 0xd83, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xdca, 0xdca, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xdcf, 0xdcf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xdd0, 0xdd1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xdd2, 0xdd4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xdd6, 0xdd6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xdd8, 0xdde, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xddf, 0xddf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xdf2, 0xdf3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xe31, 0xe31, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xe33, 0xe33, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xe34, 0xe3a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xe47, 0xe4e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xeb1, 0xeb1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xeb3, 0xeb3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xeb4, 0xebc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xec8, 0xece, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf18, 0xf19, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf35, 0xf35, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf37, 0xf37, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf39, 0xf39, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf3e, 0xf3f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xf71, 0xf7e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf7f, 0xf7f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xf80, 0xf84, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf86, 0xf87, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf8d, 0xf97, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xf99, 0xfbc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xfc6, 0xfc6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x102d, 0x1030, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1031, 0x1031, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1032, 0x1037, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1039, 0x103a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x103b, 0x103c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x103d, 0x103e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1056, 0x1057, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1058, 0x1059, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x105e, 0x1060, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1071, 0x1074, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1082, 0x1082, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1084, 0x1084, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1085, 0x1086, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x108d, 0x108d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x109d, 0x109d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1100, 0x115f, GraphemeClusterBreak::L },
+        GraphemeRange{ 0x1160, 0x11a7, GraphemeClusterBreak::V },
+        GraphemeRange{ 0x11a8, 0x11ff, GraphemeClusterBreak::T },
+        GraphemeRange{ 0x135d, 0x135f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1712, 0x1714, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1715, 0x1715, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1732, 0x1733, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1734, 0x1734, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1752, 0x1753, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1772, 0x1773, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x17b4, 0x17b5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x17b6, 0x17b6, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x17b7, 0x17bd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x17be, 0x17c5, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x17c6, 0x17c6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x17c7, 0x17c8, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x17c9, 0x17d3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x17dd, 0x17dd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x180b, 0x180d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x180e, 0x180e, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x180f, 0x180f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1885, 0x1886, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x18a9, 0x18a9, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1920, 0x1922, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1923, 0x1926, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1927, 0x1928, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1929, 0x192b, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1930, 0x1931, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1932, 0x1932, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1933, 0x1938, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1939, 0x193b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a17, 0x1a18, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a19, 0x1a1a, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1a1b, 0x1a1b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a55, 0x1a55, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1a56, 0x1a56, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a57, 0x1a57, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1a58, 0x1a5e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a60, 0x1a60, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a62, 0x1a62, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a65, 0x1a6c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a6d, 0x1a72, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1a73, 0x1a7c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1a7f, 0x1a7f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1ab0, 0x1ace, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b00, 0x1b03, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b04, 0x1b04, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1b34, 0x1b3a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b3b, 0x1b3b, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1b3c, 0x1b3c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b3d, 0x1b41, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1b42, 0x1b42, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b43, 0x1b44, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1b6b, 0x1b73, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b80, 0x1b81, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1b82, 0x1b82, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1ba1, 0x1ba1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1ba2, 0x1ba5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1ba6, 0x1ba7, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1ba8, 0x1ba9, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1baa, 0x1baa, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1bab, 0x1bad, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1be6, 0x1be6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1be7, 0x1be7, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1be8, 0x1be9, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1bea, 0x1bec, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1bed, 0x1bed, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1bee, 0x1bee, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1bef, 0x1bf1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1bf2, 0x1bf3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1c24, 0x1c2b, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1c2c, 0x1c33, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1c34, 0x1c35, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1c36, 0x1c37, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1cd0, 0x1cd2, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1cd4, 0x1ce0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1ce1, 0x1ce1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1ce2, 0x1ce8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1ced, 0x1ced, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1cf4, 0x1cf4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1cf7, 0x1cf7, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1cf8, 0x1cf9, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1dc0, 0x1dff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x200b, 0x200b, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x200c, 0x200c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x200d, 0x200d, GraphemeClusterBreak::ZWJ },
+        GraphemeRange{ 0x200e, 0x200f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x2028, 0x202e, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x203c, 0x203c, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2049, 0x2049, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2060, 0x206f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x20d0, 0x20f0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x2122, 0x2122, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2139, 0x2139, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2194, 0x2199, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x21a9, 0x21aa, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x231a, 0x231b, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2328, 0x2328, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2388, 0x2388, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x23cf, 0x23cf, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x23e9, 0x23f3, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x23f8, 0x23fa, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x24c2, 0x24c2, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x25aa, 0x25ab, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x25b6, 0x25b6, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x25c0, 0x25c0, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x25fb, 0x25fe, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2600, 0x2605, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2607, 0x2612, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2614, 0x2685, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2690, 0x2705, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2708, 0x2712, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2714, 0x2714, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2716, 0x2716, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x271d, 0x271d, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2721, 0x2721, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2728, 0x2728, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2733, 0x2734, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2744, 0x2744, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2747, 0x2747, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x274c, 0x274c, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x274e, 0x274e, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2753, 0x2755, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2757, 0x2757, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2763, 0x2767, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2795, 0x2797, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x27a1, 0x27a1, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x27b0, 0x27b0, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x27bf, 0x27bf, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2934, 0x2935, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2b05, 0x2b07, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2b1b, 0x2b1c, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2b50, 0x2b50, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2b55, 0x2b55, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x2cef, 0x2cf1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x2d7f, 0x2d7f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x2de0, 0x2dff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x302a, 0x302f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x3030, 0x3030, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x303d, 0x303d, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x3099, 0x309a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x3297, 0x3297, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x3299, 0x3299, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0xa66f, 0xa672, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa674, 0xa67d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa69e, 0xa69f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa6f0, 0xa6f1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa802, 0xa802, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa806, 0xa806, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa80b, 0xa80b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa823, 0xa824, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa825, 0xa826, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa827, 0xa827, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa82c, 0xa82c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa880, 0xa881, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa8b4, 0xa8c3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa8c4, 0xa8c5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa8e0, 0xa8f1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa8ff, 0xa8ff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa926, 0xa92d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa947, 0xa951, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa952, 0xa953, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa960, 0xa97c, GraphemeClusterBreak::L },
+        GraphemeRange{ 0xa980, 0xa982, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa983, 0xa983, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa9b3, 0xa9b3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa9b4, 0xa9b5, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa9b6, 0xa9b9, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa9ba, 0xa9bb, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa9bc, 0xa9bd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xa9be, 0xa9c0, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xa9e5, 0xa9e5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa29, 0xaa2e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa2f, 0xaa30, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaa31, 0xaa32, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa33, 0xaa34, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaa35, 0xaa36, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa43, 0xaa43, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa4c, 0xaa4c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaa4d, 0xaa4d, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaa7c, 0xaa7c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaab0, 0xaab0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaab2, 0xaab4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaab7, 0xaab8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaabe, 0xaabf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaac1, 0xaac1, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaaeb, 0xaaeb, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaaec, 0xaaed, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xaaee, 0xaaef, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaaf5, 0xaaf5, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xaaf6, 0xaaf6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xabe3, 0xabe4, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xabe5, 0xabe5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xabe6, 0xabe7, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xabe8, 0xabe8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xabe9, 0xabea, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xabec, 0xabec, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0xabed, 0xabed, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xac00, 0xd7a3, GraphemeClusterBreak::LVT },
+        GraphemeRange{ 0xd7b0, 0xd7c6, GraphemeClusterBreak::V },
+        GraphemeRange{ 0xd7cb, 0xd7fb, GraphemeClusterBreak::T },
+        GraphemeRange{ 0xfb1e, 0xfb1e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xfe00, 0xfe0f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xfe20, 0xfe2f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xfeff, 0xfeff, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xff9e, 0xff9f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xfff0, 0xfffb, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x101fd, 0x101fd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x102e0, 0x102e0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10376, 0x1037a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10a01, 0x10a03, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10a05, 0x10a06, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10a0c, 0x10a0f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10a38, 0x10a3a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10a3f, 0x10a3f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10ae5, 0x10ae6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10d24, 0x10d27, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10eab, 0x10eac, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10efd, 0x10eff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10f46, 0x10f50, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x10f82, 0x10f85, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11000, 0x11000, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11001, 0x11001, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11002, 0x11002, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11038, 0x11046, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11070, 0x11070, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11073, 0x11074, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1107f, 0x11081, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11082, 0x11082, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x110b0, 0x110b2, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x110b3, 0x110b6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x110b7, 0x110b8, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x110b9, 0x110ba, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x110bd, 0x110bd, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x110c2, 0x110c2, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x110cd, 0x110cd, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11100, 0x11102, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11127, 0x1112b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1112c, 0x1112c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1112d, 0x11134, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11145, 0x11146, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11173, 0x11173, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11180, 0x11181, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11182, 0x11182, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x111b3, 0x111b5, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x111b6, 0x111be, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x111bf, 0x111c0, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x111c2, 0x111c3, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x111c9, 0x111cc, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x111ce, 0x111ce, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x111cf, 0x111cf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1122c, 0x1122e, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1122f, 0x11231, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11232, 0x11233, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11234, 0x11234, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11235, 0x11235, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11236, 0x11237, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1123e, 0x1123e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11241, 0x11241, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x112df, 0x112df, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x112e0, 0x112e2, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x112e3, 0x112ea, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11300, 0x11301, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11302, 0x11303, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1133b, 0x1133c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1133e, 0x1133e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1133f, 0x1133f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11340, 0x11340, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11341, 0x11344, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11347, 0x11348, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1134b, 0x1134d, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11357, 0x11357, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11362, 0x11363, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11366, 0x1136c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11370, 0x11374, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11435, 0x11437, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11438, 0x1143f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11440, 0x11441, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11442, 0x11444, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11445, 0x11445, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11446, 0x11446, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1145e, 0x1145e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114b0, 0x114b0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114b1, 0x114b2, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x114b3, 0x114b8, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114b9, 0x114b9, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x114ba, 0x114ba, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114bb, 0x114bc, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x114bd, 0x114bd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114be, 0x114be, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x114bf, 0x114c0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x114c1, 0x114c1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x114c2, 0x114c3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x115af, 0x115af, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x115b0, 0x115b1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x115b2, 0x115b5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x115b8, 0x115bb, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x115bc, 0x115bd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x115be, 0x115be, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x115bf, 0x115c0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x115dc, 0x115dd, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11630, 0x11632, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11633, 0x1163a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1163b, 0x1163c, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1163d, 0x1163d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1163e, 0x1163e, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1163f, 0x11640, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x116ab, 0x116ab, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x116ac, 0x116ac, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x116ad, 0x116ad, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x116ae, 0x116af, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x116b0, 0x116b5, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x116b6, 0x116b6, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x116b7, 0x116b7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1171d, 0x1171f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11722, 0x11725, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11726, 0x11726, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11727, 0x1172b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1182c, 0x1182e, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1182f, 0x11837, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11838, 0x11838, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11839, 0x1183a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11930, 0x11930, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11931, 0x11935, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11937, 0x11938, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1193b, 0x1193c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1193d, 0x1193d, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1193e, 0x1193e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1193f, 0x1193f, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11940, 0x11940, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11941, 0x11941, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11942, 0x11942, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11943, 0x11943, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x119d1, 0x119d3, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x119d4, 0x119d7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x119da, 0x119db, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x119dc, 0x119df, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x119e0, 0x119e0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x119e4, 0x119e4, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11a01, 0x11a0a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a33, 0x11a38, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a39, 0x11a39, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11a3a, 0x11a3a, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11a3b, 0x11a3e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a47, 0x11a47, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a51, 0x11a56, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a57, 0x11a58, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11a59, 0x11a5b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a84, 0x11a89, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11a8a, 0x11a96, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11a97, 0x11a97, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11a98, 0x11a99, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11c2f, 0x11c2f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11c30, 0x11c36, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11c38, 0x11c3d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11c3e, 0x11c3e, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11c3f, 0x11c3f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11c92, 0x11ca7, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11ca9, 0x11ca9, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11caa, 0x11cb0, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11cb1, 0x11cb1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11cb2, 0x11cb3, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11cb4, 0x11cb4, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11cb5, 0x11cb6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d31, 0x11d36, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d3a, 0x11d3a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d3c, 0x11d3d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d3f, 0x11d45, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d46, 0x11d46, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11d47, 0x11d47, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d8a, 0x11d8e, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11d90, 0x11d91, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d93, 0x11d94, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11d95, 0x11d95, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11d96, 0x11d96, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11d97, 0x11d97, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11ef3, 0x11ef4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11ef5, 0x11ef6, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11f00, 0x11f01, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11f02, 0x11f02, GraphemeClusterBreak::Prepend },
+        GraphemeRange{ 0x11f03, 0x11f03, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11f34, 0x11f35, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11f36, 0x11f3a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11f3e, 0x11f3f, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11f40, 0x11f40, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x11f41, 0x11f41, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x11f42, 0x11f42, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x13430, 0x1343f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x13440, 0x13440, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x13447, 0x13455, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16af0, 0x16af4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16b30, 0x16b36, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16f4f, 0x16f4f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16f51, 0x16f87, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x16f8f, 0x16f92, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16fe4, 0x16fe4, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x16ff0, 0x16ff1, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1bc9d, 0x1bc9e, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1bca0, 0x1bca3, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x1cf00, 0x1cf2d, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1cf30, 0x1cf46, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d165, 0x1d165, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d166, 0x1d166, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1d167, 0x1d169, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d16d, 0x1d16d, GraphemeClusterBreak::SpacingMark },
+        GraphemeRange{ 0x1d16e, 0x1d172, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d173, 0x1d17a, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0x1d17b, 0x1d182, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d185, 0x1d18b, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d1aa, 0x1d1ad, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1d242, 0x1d244, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1da00, 0x1da36, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1da3b, 0x1da6c, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1da75, 0x1da75, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1da84, 0x1da84, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1da9b, 0x1da9f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1daa1, 0x1daaf, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e000, 0x1e006, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e008, 0x1e018, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e01b, 0x1e021, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e023, 0x1e024, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e026, 0x1e02a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e08f, 0x1e08f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e130, 0x1e136, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e2ae, 0x1e2ae, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e2ec, 0x1e2ef, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e4ec, 0x1e4ef, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e8d0, 0x1e8d6, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1e944, 0x1e94a, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1f000, 0x1f0ff, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f10d, 0x1f10f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f12f, 0x1f12f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f16c, 0x1f171, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f17e, 0x1f17f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f18e, 0x1f18e, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f191, 0x1f19a, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f1ad, 0x1f1e5, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f1e6, 0x1f1ff, GraphemeClusterBreak::RegionalIndicator },
+        GraphemeRange{ 0x1f201, 0x1f20f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f21a, 0x1f21a, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f22f, 0x1f22f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f232, 0x1f23a, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f23c, 0x1f23f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f249, 0x1f3fa, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f3fb, 0x1f3ff, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0x1f400, 0x1f53d, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f546, 0x1f64f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f680, 0x1f6ff, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f774, 0x1f77f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f7d5, 0x1f7ff, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f80c, 0x1f80f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f848, 0x1f84f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f85a, 0x1f85f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f888, 0x1f88f, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f8ae, 0x1f8ff, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f90c, 0x1f93a, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f93c, 0x1f945, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1f947, 0x1faff, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0x1fc00, 0x1fffd, GraphemeClusterBreak::ExtendedPictographic },
+        GraphemeRange{ 0xe0000, 0xe001f, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xe0020, 0xe007f, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xe0080, 0xe00ff, GraphemeClusterBreak::Control },
+        GraphemeRange{ 0xe0100, 0xe01ef, GraphemeClusterBreak::Extend },
+        GraphemeRange{ 0xe01f0, 0xe0fff, GraphemeClusterBreak::Control },
+    };
+
+    // Just like the width table in CodepointWidthDetector.cpp, s_graphemeBreakTable is turned into a
+    // two-stage lookup table at compile time. Stage 1 maps each block of 256 codepoints to a block in stage 2,
+    // which stores 4 bits per codepoint. Blocks consisting of a single value share one of the first
+    // s_graphemeClusterBreakCount blocks in stage 2, whose index coincides with that value.
+    static constexpr size_t s_graphemeClusterBreakCount = 15;
+    static constexpr uint8_t s_mixedBlock = 0xff; // only used for stage 1 generation
+
+    static constexpr char32_t s_codepointCount = 0x110000;
+    static constexpr int s_blockShift = 8;
+    static constexpr char32_t s_blockSize = 1 << s_blockShift;
+    static constexpr size_t s_stage1Size = s_codepointCount >> s_blockShift;
+    // 2 codepoints with 4 bits each fit into a byte.
+    static constexpr size_t s_stage2BlockBytes = s_blockSize / 2;
+
+    // Calls func(block, value) for every block of s_blockSize codepoints.
+    // value is s_mixedBlock if the block doesn't consist of a single GraphemeClusterBreak value.
+    template<typename T>
+    constexpr void forEachBlock(T&& func)
+    {
+        size_t r = 0;
+        for (size_t block = 0; block < s_stage1Size; ++block)
+        {
+            const auto beg = gsl::narrow_cast<char32_t>(block << s_blockShift);
+            const auto end = beg + s_blockSize - 1;
+
+            // The ranges are sorted, so we can skip those which end before this block once and for all.
+            while (r < s_graphemeBreakTable.size() && s_graphemeBreakTable[r].upperBound < beg)
+            {
+                ++r;
+            }
+
+            auto value = s_mixedBlock;
+            if (r == s_graphemeBreakTable.size() || s_graphemeBreakTable[r].lowerBound > end)
+            {
+                value = WI_EnumValue(GraphemeClusterBreak::Other);
+            }
+            else if (s_graphemeBreakTable[r].lowerBound <= beg && s_graphemeBreakTable[r].upperBound >= end)
+            {
+                value = WI_EnumValue(s_graphemeBreakTable[r].value);
+            }
+
+            func(block, value);
+        }
+    }
+
+    static constexpr size_t s_mixedBlockCount = [] {
+        size_t count = 0;
+        forEachBlock([&](size_t, uint8_t value) {
+            count += value == s_mixedBlock;
+        });
+        return count;
+    }();
+
+    static constexpr size_t s_stage2BlockCount = s_graphemeClusterBreakCount + s_mixedBlockCount;
+    static_assert(s_stage2BlockCount <= 256, "stage 1 stores block indices as uint8_t");
+
+    struct GraphemeBreakTable
+    {
+        std::array<uint8_t, s_stage1Size> stage1{};
+        std::array<uint8_t, s_stage2BlockCount * s_stage2BlockBytes> stage2{};
+
+        constexpr GraphemeClusterBreak Lookup(const char32_t codepoint) const noexcept
+        {
+            const size_t block = stage1[codepoint >> s_blockShift];
+            const auto offset = codepoint & (s_blockSize - 1);
+            const auto bits = stage2[block * s_stage2BlockBytes + offset / 2] >> (offset % 2 * 4);
+            return static_cast<GraphemeClusterBreak>(bits & 15);
+        }
+    };
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+#pragma warning(disable : 26482) // Only index into arrays using constant expressions (bounds.2).
+    static constexpr auto s_graphemeBreakLookup = [] {
+        GraphemeBreakTable table;
+
+        for (size_t value = 0; value < s_graphemeClusterBreakCount; ++value)
+        {
+            for (size_t i = 0; i < s_stage2BlockBytes; ++i)
+            {
+                table.stage2[value * s_stage2BlockBytes + i] = gsl::narrow_cast<uint8_t>(value << 4 | value);
+            }
+        }
+
+        size_t nextBlock = s_graphemeClusterBreakCount;
+        forEachBlock([&](size_t block, uint8_t value) {
+            if (value != s_mixedBlock)
+            {
+                table.stage1[block] = value;
+                return;
+            }
+
+            const auto beg = gsl::narrow_cast<char32_t>(block << s_blockShift);
+            const auto end = beg + s_blockSize - 1;
+            const auto data = nextBlock * s_stage2BlockBytes;
+
+            for (const auto& range : s_graphemeBreakTable)
+            {
+                if (range.upperBound < beg || range.lowerBound > end)
+                {
+                    continue;
+                }
+
+                for (auto c = std::max<char32_t>(range.lowerBound, beg), last = std::min<char32_t>(range.upperBound, end); c <= last; ++c)
+                {
+                    const auto offset = c - beg;
+                    table.stage2[data + offset / 2] |= WI_EnumValue(range.value) << (offset % 2 * 4);
+                }
+            }
+
+            table.stage1[block] = gsl::narrow_cast<uint8_t>(nextBlock);
+            ++nextBlock;
+        });
+
+        return table;
+    }();
+
+    // Verify the generated table at the boundaries of each range, which is where a mistake would show up first.
+    static constexpr bool s_graphemeBreakLookupMatchesRanges = [] {
+        for (const auto& range : s_graphemeBreakTable)
+        {
+            if (s_graphemeBreakLookup.Lookup(range.lowerBound) != range.value || s_graphemeBreakLookup.Lookup(range.upperBound) != range.value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }();
+    static_assert(s_graphemeBreakLookupMatchesRanges);
+
+    // The pair rules GB3 to GB999 of UAX #29, as a matrix indexed by the values left and right of a potential break.
+    // Two of the rules depend on more than the adjacent pair and need to be resolved by the caller.
+    enum GraphemeRule : uint8_t
+    {
+        GraphemeRuleBreak = 0,
+        GraphemeRuleJoin,
+        GraphemeRuleJoinIfExtendedPictographic, // GB11: \p{ExtPict} Extend* ZWJ x \p{ExtPict}
+        GraphemeRuleJoinIfOddRegionalIndicators, // GB12/GB13: an odd number of RIs precedes the break
+    };
+
+    static constexpr auto s_graphemeRules = [] {
+        using B = GraphemeClusterBreak;
+        std::array<std::array<GraphemeRule, s_graphemeClusterBreakCount>, s_graphemeClusterBreakCount> rules{};
+
+        const auto isControl = [](B v) {
+            return v == B::CR || v == B::LF || v == B::Control;
+        };
+
+        for (size_t l = 0; l < s_graphemeClusterBreakCount; ++l)
+        {
+            for (size_t r = 0; r < s_graphemeClusterBreakCount; ++r)
+            {
+                const auto left = static_cast<B>(l);
+                const auto right = static_cast<B>(r);
+                // The rules are checked from last to first, so that earlier
+                // ones take precedence, just like the specification demands.
+                auto rule = GraphemeRuleBreak; // GB999
+
+                if (left == B::RegionalIndicator && right == B::RegionalIndicator)
+                {
+                    rule = GraphemeRuleJoinIfOddRegionalIndicators; // GB12, GB13
+                }
+                if (left == B::ZWJ && right == B::ExtendedPictographic)
+                {
+                    rule = GraphemeRuleJoinIfExtendedPictographic; // GB11
+                }
+                if (left == B::Prepend)
+                {
+                    rule = GraphemeRuleJoin; // GB9b
+                }
+                if (right == B::Extend || right == B::ZWJ || right == B::SpacingMark)
+                {
+                    rule = GraphemeRuleJoin; // GB9, GB9a
+                }
+                if ((left == B::LVT || left == B::T) && right == B::T)
+                {
+                    rule = GraphemeRuleJoin; // GB8
+                }
+                if ((left == B::LV || left == B::V) && (right == B::V || right == B::T))
+                {
+                    rule = GraphemeRuleJoin; // GB7
+                }
+                if (left == B::L && (right == B::L || right == B::V || right == B::LV || right == B::LVT))
+                {
+                    rule = GraphemeRuleJoin; // GB6
+                }
+                if (isControl(left) || isControl(right))
+                {
+                    rule = GraphemeRuleBreak; // GB4, GB5
+                }
+                if (left == B::CR && right == B::LF)
+                {
+                    rule = GraphemeRuleJoin; // GB3
+                }
+
+                rules[l][r] = rule;
+            }
+        }
+
+        return rules;
+    }();
+
+#pragma warning(pop)
+
+    constexpr char32_t combineSurrogates(const wchar_t lead, const wchar_t trail) noexcept
+    {
+        return (((lead & 0x3FF) << 10) | (trail & 0x3FF)) + 0x10000;
+    }
+
+    // Decodes the codepoint at str[offset] and returns its length in UTF-16 code units.
+    // Unpaired surrogates are treated like U+FFFD, which is GraphemeClusterBreak::Other.
+    size_t decodeNext(const std::wstring_view& str, size_t offset, GraphemeClusterBreak& value) noexcept
+    {
+        const auto lead = til::at(str, offset);
+        if (til::is_leading_surrogate(lead) && offset + 1 < str.size())
+        {
+            const auto trail = til::at(str, offset + 1);
+            if (til::is_trailing_surrogate(trail))
+            {
+                value = GetGraphemeClusterBreak(combineSurrogates(lead, trail));
+                return 2;
+            }
+        }
+        value = til::is_surrogate(lead) ? GraphemeClusterBreak::Other : GetGraphemeClusterBreak(lead);
+        return 1;
+    }
+
+    // Decodes the codepoint in front of str[offset] and returns its length in UTF-16 code units.
+    size_t decodePrev(const std::wstring_view& str, size_t offset, GraphemeClusterBreak& value) noexcept
+    {
+        const auto trail = til::at(str, offset - 1);
+        if (til::is_trailing_surrogate(trail) && offset >= 2)
+        {
+            const auto lead = til::at(str, offset - 2);
+            if (til::is_leading_surrogate(lead))
+            {
+                value = GetGraphemeClusterBreak(combineSurrogates(lead, trail));
+                return 2;
+            }
+        }
+        value = til::is_surrogate(trail) ? GraphemeClusterBreak::Other : GetGraphemeClusterBreak(trail);
+        return 1;
+    }
+
+    // GB11: Whether the ZWJ in front of str[offset] is preceded by \p{ExtPict} Extend*.
+    bool precededByExtendedPictographic(const std::wstring_view& str, size_t offset) noexcept
+    {
+        auto value = GraphemeClusterBreak::Other;
+        while (offset > 0)
+        {
+            offset -= decodePrev(str, offset, value);
+            if (value != GraphemeClusterBreak::Extend)
+            {
+                break;
+            }
+        }
+        return value == GraphemeClusterBreak::ExtendedPictographic;
+    }
+
+    // GB12/GB13: Whether an odd number of regional indicators precedes str[offset].
+    bool precededByOddRegionalIndicators(const std::wstring_view& str, size_t offset) noexcept
+    {
+        size_t regionalIndicators = 0;
+        auto value = GraphemeClusterBreak::Other;
+        while (offset > 0)
+        {
+            offset -= decodePrev(str, offset, value);
+            if (value != GraphemeClusterBreak::RegionalIndicator)
+            {
+                break;
+            }
+            ++regionalIndicators;
+        }
+        return regionalIndicators & 1;
+    }
+}
+
+GraphemeClusterBreak GetGraphemeClusterBreak(const char32_t codepoint) noexcept
+{
+    if (codepoint >= s_codepointCount)
+    {
+        return GraphemeClusterBreak::Other;
+    }
+
+    const auto value = s_graphemeBreakLookup.Lookup(codepoint);
+    if (value == GraphemeClusterBreak::LVT && codepoint >= 0xAC00 && codepoint <= 0xD7A3 && (codepoint - 0xAC00) % 28 == 0)
+    {
+        return GraphemeClusterBreak::LV;
+    }
+    return value;
+}
+
+// Routine Description:
+// - Returns the end of the extended grapheme cluster that starts at str[offset].
+//   This is the out-of-line part of GraphemeClusterNext for anything but plain text.
+// Arguments:
+// - str - the UTF-16 text to segment
+// - offset - the beginning of a grapheme cluster in str
+// Return Value:
+// - the offset of the next grapheme cluster, or str.size() if there's none
+size_t GraphemeClusterNextSlow(const std::wstring_view& str, size_t offset) noexcept
+{
+    const auto len = str.size();
+    if (offset + 1 >= len)
+    {
+        return len;
+    }
+
+    auto left = GraphemeClusterBreak::Other;
+    offset += decodeNext(str, offset, left);
+
+    // State for GB11: whether the text so far ends in \p{ExtPict} Extend* or \p{ExtPict} Extend* ZWJ.
+    auto pictographic = left == GraphemeClusterBreak::ExtendedPictographic;
+    // State for GB12/GB13: the number of consecutive regional indicators so far.
+    size_t regionalIndicators = left == GraphemeClusterBreak::RegionalIndicator;
+
+    while (offset < len)
+    {
+        auto right = GraphemeClusterBreak::Other;
+        const auto advance = decodeNext(str, offset, right);
+
+        switch (til::at(til::at(s_graphemeRules, WI_EnumValue(left)), WI_EnumValue(right)))
+        {
+        case GraphemeRuleJoin:
+            break;
+        case GraphemeRuleJoinIfExtendedPictographic:
+            if (pictographic)
+            {
+                break;
+            }
+            return offset;
+        case GraphemeRuleJoinIfOddRegionalIndicators:
+            if (regionalIndicators & 1)
+            {
+                break;
+            }
+            return offset;
+        default:
+            return offset;
+        }
+
+        switch (right)
+        {
+        case GraphemeClusterBreak::ExtendedPictographic:
+            pictographic = true;
+            break;
+        case GraphemeClusterBreak::Extend:
+        case GraphemeClusterBreak::ZWJ:
+            // Only Extend may follow the \p{ExtPict} and only ExtPict may follow the ZWJ.
+            pictographic = pictographic && left != GraphemeClusterBreak::ZWJ;
+            break;
+        default:
+            pictographic = false;
+            break;
+        }
+        regionalIndicators = right == GraphemeClusterBreak::RegionalIndicator ? regionalIndicators + 1 : 0;
+
+        left = right;
+        offset += advance;
+    }
+
+    return offset;
+}
+
+// Routine Description:
+// - Returns the beginning of the extended grapheme cluster that ends at str[offset].
+//   It's the counterpart to GraphemeClusterNextSlow. Since the segmentation rules are written
+//   for forward iteration, GB11 and GB12/GB13 are resolved by looking further back.
+// Arguments:
+// - str - the UTF-16 text to segment
+// - offset - the end of a grapheme cluster in str
+// Return Value:
+// - the offset of the preceding grapheme cluster, or 0 if there's none
+size_t GraphemeClusterPrevSlow(const std::wstring_view& str, size_t offset) noexcept
+{
+    offset = std::min(offset, str.size());
+    if (offset <= 1)
+    {
+        return 0;
+    }
+
+    auto right = GraphemeClusterBreak::Other;
+    offset -= decodePrev(str, offset, right);
+
+    while (offset > 0)
+    {
+        auto left = GraphemeClusterBreak::Other;
+        const auto advance = decodePrev(str, offset, left);
+        const auto leftBeg = offset - advance;
+
+        switch (til::at(til::at(s_graphemeRules, WI_EnumValue(left)), WI_EnumValue(right)))
+        {
+        case GraphemeRuleJoin:
+            break;
+        case GraphemeRuleJoinIfExtendedPictographic:
+            if (precededByExtendedPictographic(str, leftBeg))
+            {
+                break;
+            }
+            return offset;
+        case GraphemeRuleJoinIfOddRegionalIndicators:
+            if (precededByOddRegionalIndicators(str, offset))
+            {
+                break;
+            }
+            return offset;
+        default:
+            return offset;
+        }
+
+        right = left;
+        offset = leftBeg;
+    }
+
+    return offset;
+}
+
+// Routine Description:
+// - Returns whether there's a grapheme cluster boundary between two strings, were they concatenated.
+//   This allows text that's written piece by piece to be segmented as if it was written at once.
+// Arguments:
+// - before - the text in front of the potential boundary
+// - after - the text following it
+// Return Value:
+// - true if after[0] starts a new grapheme cluster
+bool IsGraphemeClusterBoundary(const std::wstring_view& before, const std::wstring_view& after) noexcept
+{
+    if (before.empty() || after.empty())
+    {
+        return true;
+    }
+    if (IsTrivialGraphemeBoundary(before.back(), after.front()))
+    {
+        return true;
+    }
+
+    auto left = GraphemeClusterBreak::Other;
+    auto right = GraphemeClusterBreak::Other;
+    const auto leftBeg = before.size() - decodePrev(before, before.size(), left);
+    decodeNext(after, 0, right);
+
+    switch (til::at(til::at(s_graphemeRules, WI_EnumValue(left)), WI_EnumValue(right)))
+    {
+    case GraphemeRuleJoin:
+        return false;
+    case GraphemeRuleJoinIfExtendedPictographic:
+        return !precededByExtendedPictographic(before, leftBeg);
+    case GraphemeRuleJoinIfOddRegionalIndicators:
+        return !precededByOddRegionalIndicators(before, before.size());
+    default:
+        return true;
+    }
+}
@@ -5,6 +5,7 @@
 #include "UiaTextRangeBase.hpp"
 
 #include "UiaTracing.h"
+#include "../buffer/out/textBufferRunIterator.hpp"
 
 using namespace Microsoft::Console::Types;
 
@@ -316,6 +317,21 @@ void UiaTextRangeBase::_expandToEnclosingUnit(TextUnit unit)
     }
 }
 
+// Method Description:
+// - Returns UiaGetReservedMixedAttributeValue, for when the value of the specified attribute varies over the text range.
+//   Source: https://docs.microsoft.com/en-us/windows/win32/api/uiautomationcore/nf-uiautomationcore-itextrangeprovider-getattributevalue
+// Arguments:
+// - attributeId - the UIA text attribute identifier that was queried
+// - pRetVal - the attribute's value
+// Return Value:
+// - the HRESULT of UiaGetReservedMixedAttributeValue
+HRESULT UiaTextRangeBase::_getMixedAttributeValue(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal) const
+{
+    pRetVal->vt = VT_UNKNOWN;
+    UiaTracing::TextRange::GetAttributeValue(*this, attributeId, *pRetVal, UiaTracing::AttributeType::Mixed);
+    return UiaGetReservedMixedAttributeValue(&pRetVal->punkVal);
+}
+
 // Method Description:
 // - Verify that the given attribute has the desired formatting saved in the attributeId and val
 // Arguments:
@@ -791,27 +807,36 @@ try
     const auto inclusiveEnd{ _getInclusiveEnd() };
 
     // Check if the entire text range has that text attribute
-#pragma warning(suppress : 26496) // TRANSITIONAL: false positive in VS 16.11
-    auto viewportRange{ bufferSize };
     if (_blockRange)
     {
         const auto originX{ std::min(_start.x, inclusiveEnd.x) };
         const auto originY{ std::min(_start.y, inclusiveEnd.y) };
         const auto width{ std::abs(inclusiveEnd.x - _start.x + 1) };
         const auto height{ std::abs(inclusiveEnd.y - _start.y + 1) };
-        viewportRange = Viewport::FromDimensions({ originX, originY }, width, height);
+        const auto viewportRange = Viewport::FromDimensions({ originX, originY }, width, height);
+        auto iter{ buffer.GetCellDataAt(_start, viewportRange) };
+        for (; iter && iter.Pos() != inclusiveEnd; ++iter)
+        {
+            if (!_verifyAttr(attributeId, *pRetVal, iter->TextAttr()).value())
+            {
+                return _getMixedAttributeValue(attributeId, pRetVal);
+            }
+        }
     }
-    auto iter{ buffer.GetCellDataAt(_start, viewportRange) };
-    for (; iter && iter.Pos() != inclusiveEnd; ++iter)
+    else
     {
-        if (!_verifyAttr(attributeId, *pRetVal, iter->TextAttr()).value())
+        // Compare one attribute run at a time, up to (but excluding) inclusiveEnd.
+        for (auto y = _start.y; y <= inclusiveEnd.y && y < bufferSize.BottomExclusive(); ++y)
         {
-            // The value of the specified attribute varies over the text range
-            // return UiaGetReservedMixedAttributeValue.
-            // Source: https://docs.microsoft.com/en-us/windows/win32/api/uiautomationcore/nf-uiautomationcore-itextrangeprovider-getattributevalue
-            pRetVal->vt = VT_UNKNOWN;
-            UiaTracing::TextRange::GetAttributeValue(*this, attributeId, *pRetVal, UiaTracing::AttributeType::Mixed);
-            return UiaGetReservedMixedAttributeValue(&pRetVal->punkVal);
+            const auto columnBegin = y == _start.y ? _start.x : bufferSize.Left();
+            const auto columnEnd = y == inclusiveEnd.y ? inclusiveEnd.x : bufferSize.RightExclusive();
+            for (TextBufferRunIterator it{ buffer.GetRowByOffset(y), columnBegin, columnEnd }; it; ++it)
+            {
+                if (!_verifyAttr(attributeId, *pRetVal, it->attr).value())
+                {
+                    return _getMixedAttributeValue(attributeId, pRetVal);
+                }
+            }
         }
     }
 
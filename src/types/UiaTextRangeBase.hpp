@@ -176,6 +176,7 @@ namespace Microsoft::Console::Types
                                     const gsl::not_null<int*> pAmountMoved,
                                     _In_ const bool preventBoundary = false) noexcept;
 
+        HRESULT _getMixedAttributeValue(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal) const;
         std::optional<bool> _verifyAttr(TEXTATTRIBUTEID attributeId, VARIANT val, const TextAttribute& attr) const;
         bool _initializeAttrQuery(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal, const TextAttribute& attr) const;
         bool _tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, til::point& resultingPos) const;
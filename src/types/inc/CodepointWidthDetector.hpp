@@ -31,7 +31,12 @@ public:
 private:
     uint8_t _lookupGlyphWidth(char32_t codepoint, const std::wstring_view& glyph) noexcept;
     uint8_t _checkFallbackViaCache(char32_t codepoint, const std::wstring_view& glyph) noexcept;
+    size_t _fallbackCacheSlot(char32_t codepoint) const noexcept;
+    uint8_t _fallbackCacheFind(char32_t codepoint) const noexcept;
+    void _fallbackCacheInsert(char32_t codepoint, uint8_t width);
+    void _fallbackCacheEmplace(uint32_t value) noexcept;
 
-    std::unordered_map<char32_t, uint8_t> _fallbackCache;
+    std::vector<uint32_t> _fallbackCache;
+    size_t _fallbackCacheCount = 0;
     std::function<bool(const std::wstring_view&)> _pfnFallbackMethod;
 };
@@ -0,0 +1,71 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GraphemeBreak.hpp
+
+Abstract:
+- Extended grapheme cluster segmentation as specified by UAX #29 "Unicode Text Segmentation".
+- The Grapheme_Cluster_Break property is looked up in a two-stage table that's built at compile time.
+
+--*/
+
+#pragma once
+
+#include <string_view>
+
+// The Grapheme_Cluster_Break property values, plus Extended_Pictographic which is needed for rule GB11.
+enum class GraphemeClusterBreak : uint8_t
+{
+    Other = 0,
+    CR,
+    LF,
+    Control,
+    Extend,
+    ZWJ,
+    RegionalIndicator,
+    Prepend,
+    SpacingMark,
+    L,
+    V,
+    T,
+    LV,
+    LVT,
+    ExtendedPictographic,
+};
+
+GraphemeClusterBreak GetGraphemeClusterBreak(char32_t codepoint) noexcept;
+
+size_t GraphemeClusterNextSlow(const std::wstring_view& str, size_t offset) noexcept;
+size_t GraphemeClusterPrevSlow(const std::wstring_view& str, size_t offset) noexcept;
+bool IsGraphemeClusterBoundary(const std::wstring_view& before, const std::wstring_view& after) noexcept;
+
+// Every codepoint below U+0300 (the first combining mark) is either Control, CR, LF, Other or
+// Extended_Pictographic and none of them can join with their neighbors except for CR LF.
+// This allows us to skip the table lookup for ASCII and Latin-1 entirely.
+constexpr bool IsTrivialGraphemeBoundary(const wchar_t left, const wchar_t right) noexcept
+{
+    return left < 0x300 && right < 0x300 && (left != L'\r' || right != L'\n');
+}
+
+// Returns the offset of the grapheme cluster following the one that starts at `offset`.
+// The check for plain text is inlined, so that callers iterating over ASCII don't pay for a function call.
+inline size_t GraphemeClusterNext(const std::wstring_view& str, size_t offset) noexcept
+{
+    if (offset + 1 < str.size() && IsTrivialGraphemeBoundary(til::at(str, offset), til::at(str, offset + 1)))
+    {
+        return offset + 1;
+    }
+    return GraphemeClusterNextSlow(str, offset);
+}
+
+// Returns the offset of the grapheme cluster preceding the one that starts at `offset`.
+inline size_t GraphemeClusterPrev(const std::wstring_view& str, size_t offset) noexcept
+{
+    if (offset >= 2 && offset <= str.size() && IsTrivialGraphemeBoundary(til::at(str, offset - 2), til::at(str, offset - 1)))
+    {
+        return offset - 1;
+    }
+    return GraphemeClusterPrevSlow(str, offset);
+}
@@ -0,0 +1,121 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+#Requires -Version 7
+
+################################################################################
+# This script generates an array suitable for replacing s_graphemeBreakTable in
+# src/types/GraphemeBreak.cpp from a Unicode UCD XML document[1] compliant
+# with UAX#42[2]. It uses the Grapheme_Cluster_Break (GCB) and
+# Extended_Pictographic (ExtPict) properties as described in UAX#29[3].
+#
+# This script was developed against the flat "no han unification" UCD
+# "ucd.nounihan.flat.xml".
+# It does not support the grouped database format.
+#
+# Invoke this script from the root of this repository as:
+#   .\tools\Generate-GraphemeBreakTableFromUCD.ps1 -Path .\path\to\ucd.nounihan.flat.xml
+#
+# [1]: https://www.unicode.org/Public/UCD/latest/ucdxml/
+# [2]: https://www.unicode.org/reports/tr42/
+# [3]: https://www.unicode.org/reports/tr29/
+
+[Diagnostics.CodeAnalysis.SuppressMessageAttribute('PSAvoidUsingPositionalParameters', '')]
+[CmdletBinding()]
+Param(
+    [Parameter(Position=0, ValueFromPipeline=$true, ParameterSetName="Parsed")]
+    [System.Xml.XmlDocument]$InputObject,
+
+    [Parameter(Position=0, ValueFromPipelineByPropertyName=$true, ParameterSetName="Unparsed")]
+    [string]$Path = "ucd.nounihan.flat.xml"
+)
+
+# Maps the UCD's GCB property values to the names of the GraphemeClusterBreak enum.
+$GraphemeClusterBreakNames = @{
+    "XX"  = "Other";
+    "CR"  = "CR";
+    "LF"  = "LF";
+    "CN"  = "Control";
+    "EX"  = "Extend";
+    "ZWJ" = "ZWJ";
+    "RI"  = "RegionalIndicator";
+    "PP"  = "Prepend";
+    "SM"  = "SpacingMark";
+    "L"   = "L";
+    "V"   = "V";
+    "T"   = "T";
+    "LV"  = "LV";
+    "LVT" = "LVT";
+}
+
+Function Get-UCDEntryRange($entry) {
+    $s = $e = 0
+    if ($null -ne $entry.cp) {
+        # Individual Codepoint
+        $s = $e = [int]("0x"+$entry.cp)
+    } ElseIf ($null -ne $entry."first-cp") {
+        # Range of Codepoints
+        $s = [int]("0x"+$entry."first-cp")
+        $e = [int]("0x"+$entry."last-cp")
+    }
+    $s
+    $e
+}
+
+Function Get-UCDEntryValue($entry, [int]$codepoint) {
+    # Extended_Pictographic codepoints are all GCB=XX. GB11 needs them as a separate value.
+    If ($entry.GCB -eq "XX" -and $entry.ExtPict -eq "Y") {
+        "ExtendedPictographic"
+        Return
+    }
+    # The Hangul syllables are stored as a single LVT range. GraphemeBreak.cpp recovers LV arithmetically.
+    If ($codepoint -ge 0xAC00 -and $codepoint -le 0xD7A3) {
+        "LVT"
+        Return
+    }
+    $GraphemeClusterBreakNames[$entry.GCB] ?? $(throw "Unexpected Grapheme_Cluster_Break property")
+}
+
+# Ingest UCD
+If ($null -eq $InputObject) {
+    $InputObject = [xml](Get-Content $Path)
+}
+
+$UCDRepertoire = $InputObject.ucd.repertoire.ChildNodes | Sort-Object {
+    # Sort by either cp or first-cp (for ranges)
+    if ($null -ne $_.cp) {
+        [int]("0x"+$_.cp)
+    } ElseIf ($null -ne $_."first-cp") {
+        [int]("0x"+$_."first-cp")
+    }
+}
+
+$ranges = [System.Collections.Generic.List[Object]]::New(1024)
+
+ForEach($v in $UCDRepertoire) {
+    $start, $end = Get-UCDEntryRange $v
+    $value = Get-UCDEntryValue $v $start
+    If ($value -eq "Other") {
+        Continue
+    }
+
+    $last = $ranges.Count -gt 0 ? $ranges[$ranges.Count - 1] : $null
+    If ($null -ne $last -and $last.End -eq ($start - 1) -and $last.Value -eq $value) {
+        # Merged into last entry
+        $last.End = $end
+        Continue
+    }
+    $ranges.Add([PSCustomObject]@{ Start = $start; End = $end; Value = $value })
+}
+
+# Emit Code
+"    // Generated by {0}" -f $MyInvocation.MyCommand.Name
+"    // on {0} from {1}." -f (Get-Date -AsUTC -Format "u"), $InputObject.ucd.description
+"    // Codepoints not listed here are GraphemeClusterBreak::Other."
+"    // The Hangul syllables U+AC00-U+D7A3 are stored as LVT. LV syllables are"
+"    // every 28th of them and get recovered arithmetically in GetGraphemeClusterBreak."
+"    static constexpr std::array<GraphemeRange, {0}> s_graphemeBreakTable{{" -f $ranges.Count
+ForEach($_ in $ranges) {
+"        GraphemeRange{{ 0x{0:x}, 0x{1:x}, GraphemeClusterBreak::{2} }}," -f $_.Start, $_.End, $_.Value
+}
+"    };"